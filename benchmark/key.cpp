@@ -3,6 +3,10 @@
 #include <fc/crypto/signature.hpp>
 #include <fc/crypto/k1_recover.hpp>
 
+#include <eosio/chain/signature_recovery_cache.hpp>
+#include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/transaction_metadata.hpp>
+
 #include <benchmark.hpp>
 
 using namespace fc::crypto;
@@ -33,9 +37,64 @@ void k1_recover_benchmarking() {
    benchmarking("k1_recover", recover_f);
 }
 
+// recovery of the keys of a block worth of transactions in the chain thread pool, one task per transaction
+// compared to one chunk of transactions per thread
+void k1_recover_trxs_benchmarking() {
+   using namespace eosio::chain;
+   constexpr size_t num_trxs = 1000;
+   const chain_id_type chain_id = chain_id_type::empty_chain_id();
+   auto key = private_key::generate();
+
+   std::vector<packed_transaction_ptr> trxs;
+   trxs.reserve(num_trxs);
+   for (size_t i = 0; i < num_trxs; ++i) {
+      signed_transaction trx;
+      trx.max_net_usage_words = i; // unique id and signature
+      trx.sign(key, chain_id);
+      trxs.push_back(std::make_shared<packed_transaction>(std::move(trx)));
+   }
+
+   // every run recovers all signatures
+   auto& cache = signature_recovery_cache::instance();
+   const size_t cache_size = cache.max_size();
+   cache.set_max_size(0);
+
+   const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+   for (size_t num_threads : {size_t{1}, max_threads}) {
+      named_thread_pool<struct bench> thread_pool;
+      thread_pool.start(num_threads, {});
+
+      auto per_trx_f = [&]() {
+         std::vector<recover_keys_future> futs;
+         futs.reserve(trxs.size());
+         for (const auto& trx : trxs)
+            futs.push_back(transaction_metadata::start_recover_keys(trx, thread_pool.get_executor(), chain_id,
+                                                                    fc::microseconds::maximum(), transaction_metadata::trx_type::input));
+         for (auto& f : futs)
+            f.get();
+      };
+      benchmarking("k1_recover_1000_trxs_task_per_trx_t" + std::to_string(num_threads), per_trx_f);
+
+      auto chunked_f = [&]() {
+         auto futs = transaction_metadata::start_recover_keys(trxs, thread_pool.get_executor(), num_threads, chain_id,
+                                                              fc::microseconds::maximum(), transaction_metadata::trx_type::input);
+         for (auto& f : futs)
+            f.get();
+      };
+      benchmarking("k1_recover_1000_trxs_chunked_t" + std::to_string(num_threads), chunked_f);
+
+      thread_pool.stop();
+      if (max_threads == 1)
+         break;
+   }
+
+   cache.set_max_size(cache_size);
+}
+
 void k1_benchmarking() {
    k1_sign_benchmarking();
    k1_recover_benchmarking();
+   k1_recover_trxs_benchmarking();
 }
 
 void r1_benchmarking() {
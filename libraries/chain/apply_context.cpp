@@ -84,6 +84,8 @@ void apply_context::exec_one()
          if( !(context_free && control.skip_trx_checks()) ) {
             privileged = receiver_account->is_privileged();
             auto native = control.find_apply_handler( receiver, act->account, act->name );
+            // native and privileged actions change state outside of contract tables
+            if( (native || privileged) && trx_context.trace->access_set ) trx_context.trace->access_set->mark_serial();
             if( native ) {
                if( trx_context.enforce_whiteblacklist && control.is_speculative_block() ) {
                   control.check_contract_list( receiver );
@@ -422,6 +424,8 @@ void apply_context::schedule_deferred_transaction( const uint128_t& sender_id, a
       return;
    }
 
+   if( trx_context.trace->access_set ) trx_context.trace->access_set->mark_serial(); // generated transactions are not contract tables
+
    EOS_ASSERT( !trx_context.is_read_only(), transaction_exception, "cannot schedule a deferred transaction from within a readonly transaction" );
    EOS_ASSERT( trx.context_free_actions.size() == 0, cfa_inside_generated_tx, "context free actions are not currently allowed in generated transactions" );
 
@@ -628,6 +632,8 @@ bool apply_context::cancel_deferred_transaction( const uint128_t& sender_id, acc
       return false;
    }
 
+   if( trx_context.trace->access_set ) trx_context.trace->access_set->mark_serial(); // generated transactions are not contract tables
+
    EOS_ASSERT( !trx_context.is_read_only(), transaction_exception, "cannot cancel a deferred transaction from within a readonly transaction" );
    auto& generated_transaction_idx = db.get_mutable_index<generated_transaction_multi_index>();
    const auto* gto = db.find<generated_transaction_object,by_sender_id>(boost::make_tuple(sender, sender_id));
@@ -664,6 +670,8 @@ uint32_t apply_context::schedule_action( action&& act_to_schedule, account_name
 }
 
 const table_id_object* apply_context::find_table( name code, name scope, name table ) {
+   // recorded even if the table does not exist, a transaction creating it conflicts
+   if( trx_context.trace->access_set ) trx_context.trace->access_set->record_read( code, scope, table );
    return db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table));
 }
 
@@ -696,6 +704,10 @@ const table_id_object& apply_context::find_or_create_table( name code, name scop
    });
 }
 
+void apply_context::record_table_write( const table_id_object& tid ) {
+   if( trx_context.trace->access_set ) trx_context.trace->access_set->record_write( tid.code, tid.scope, tid.table );
+}
+
 void apply_context::remove_table( const table_id_object& tid ) {
    if (auto dm_logger = control.get_deep_mind_logger(trx_context.is_transient())) {
       std::string event_id = RAM_EVENT_ID("${code}:${scope}:${table}",
@@ -789,6 +801,7 @@ int apply_context::db_store_i64( name code, name scope, name table, const accoun
 //   require_write_lock( scope );
    EOS_ASSERT( !trx_context.is_read_only(), table_operation_not_permitted, "cannot store a db record when executing a readonly transaction" );
    const auto& tab = find_or_create_table( code, scope, table, payer );
+   record_table_write( tab );
    auto tableid = tab.id;
 
    EOS_ASSERT( payer != account_name(), invalid_table_payer, "must specify a valid account to pay for new record" );
@@ -832,6 +845,7 @@ void apply_context::db_update_i64( int iterator, account_name payer, const char*
 
    const auto& table_obj = keyval_cache.get_table( obj.t_id );
    EOS_ASSERT( table_obj.code == receiver, table_access_violation, "db access violation" );
+   record_table_write( table_obj );
 
 //   require_write_lock( table_obj.scope );
 
@@ -889,6 +903,7 @@ void apply_context::db_remove_i64( int iterator ) {
 
    const auto& table_obj = keyval_cache.get_table( obj.t_id );
    EOS_ASSERT( table_obj.code == receiver, table_access_violation, "db access violation" );
+   record_table_write( table_obj );
 
 //   require_write_lock( table_obj.scope );
 
@@ -104,8 +104,8 @@ namespace eosio { namespace chain {
       return ret;
    }
 
-   void authorization_manager::add_to_snapshot( const snapshot_writer_ptr& snapshot, snapshot_written_row_counter& row_counter ) const {
-      authorization_index_set::walk_indices([this, &snapshot, &row_counter]( auto utils ){
+   void authorization_manager::add_to_snapshot( const snapshot_writer_ptr& snapshot, snapshot_written_row_counter& row_counter, boost::asio::io_context& ctx ) const {
+      authorization_index_set::walk_indices([this, &snapshot, &row_counter, &ctx]( auto utils ){
          using section_t = typename decltype(utils)::index_t::value_type;
 
          // skip the permission_usage_index as its inlined with permission_index
@@ -113,7 +113,7 @@ namespace eosio { namespace chain {
             return;
          }
 
-         snapshot->write_section<section_t>([this, &row_counter]( auto& section ){
+         snapshot->post_section<section_t>(ctx, [this, &row_counter]( auto& section ){
             decltype(utils)::walk(_db, [this, &section, &row_counter]( const auto &row ) {
                section.add_row(row, _db);
                row_counter.progress();
@@ -26,6 +26,8 @@ void block_handle::write(const std::filesystem::path& state_file) {
    fc::raw::pack(f, chain_head_magic);
    fc::raw::pack(f, chain_head_version);
    fc::raw::pack(f, *this);
+   f.flush();
+   f.sync();
 }
 
 bool block_handle::read(const std::filesystem::path& state_file) {
@@ -6,6 +6,10 @@
 #include <eosio/chain/log_index.hpp>
 #include <fc/bitutil.hpp>
 #include <fc/io/raw.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <mutex>
 #include <string>
 
@@ -15,6 +19,9 @@ static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
 
 namespace eosio { namespace chain {
 
+   namespace bip = boost::interprocess;
+   namespace bio = boost::iostreams;
+
    enum versions {
       initial_version = 1,                  ///< complete block log from genesis
       block_x_start_version = 2,            ///< adds optional partial block log, cannot be used for replay without snapshot
@@ -26,7 +33,9 @@ namespace eosio { namespace chain {
    constexpr uint32_t block_log::max_supported_version = genesis_state_or_chain_id_version;
 
    namespace detail {
-      constexpr uint32_t pruned_version_flag = 1 << 31;
+      constexpr uint32_t pruned_version_flag     = 1 << 31;
+      constexpr uint32_t compressed_version_flag = 1 << 30; ///< block entries are stored compressed, see compress_block_entry
+      constexpr uint32_t version_flags           = pruned_version_flag | compressed_version_flag;
    }
 
    // copy up to n bytes from src to dest
@@ -55,8 +64,9 @@ namespace eosio { namespace chain {
       uint32_t                                   first_block_num = 0;
       std::variant<genesis_state, chain_id_type> chain_context;
 
-      uint32_t version() const { return ver & ~detail::pruned_version_flag; }
+      uint32_t version() const { return ver & ~detail::version_flags; }
       bool     is_currently_pruned() const { return ver & detail::pruned_version_flag; }
+      bool     is_compressed() const { return ver & detail::compressed_version_flag; }
 
       chain_id_type chain_id() const {
          return std::visit(overloaded{ [](const chain_id_type& id) { return id; },
@@ -173,10 +183,55 @@ namespace eosio { namespace chain {
          std::exception_ptr inner;
       };
 
+      /**
+       * A compressed block log entry keeps the packed signed_block_header as is, so block numbers and headers are
+       * read without decompressing it, followed by the rest of the packed signed_block as a zlib compressed bytes
+       * field. Every entry decompresses on its own, so blocks.index random access is unchanged.
+       */
+      std::vector<char> compress_block_entry(const std::vector<char>& packed_block) {
+         fc::datastream<const char*> ds(packed_block.data(), packed_block.size());
+         signed_block_header header;
+         fc::raw::unpack(ds, header);
+         const size_t header_size = ds.tellp();
+
+         std::vector<char> frame;
+         bio::filtering_ostream comp;
+         comp.push(bio::zlib_compressor(bio::zlib::default_compression));
+         comp.push(bio::back_inserter(frame));
+         bio::write(comp, packed_block.data() + header_size, packed_block.size() - header_size);
+         bio::close(comp);
+
+         std::vector<char> entry(header_size + fc::raw::pack_size(frame));
+         fc::datastream<char*> out(entry.data(), entry.size());
+         out.write(packed_block.data(), header_size);
+         fc::raw::pack(out, frame);
+         return entry;
+      }
+
+      /// @return the packed signed_block of the compressed entry read from ds
+      template <typename Stream>
+      std::vector<char> read_compressed_block_entry(Stream&& ds) {
+         signed_block_header header;
+         fc::raw::unpack(ds, header);
+         std::vector<char> frame;
+         fc::raw::unpack(ds, frame);
+
+         std::vector<char> packed_block = fc::raw::pack(header);
+         bio::filtering_ostream decomp;
+         decomp.push(bio::zlib_decompressor());
+         decomp.push(bio::back_inserter(packed_block));
+         bio::write(decomp, frame.data(), frame.size());
+         bio::close(decomp);
+         return packed_block;
+      }
+
       template <typename Stream>
-      signed_block_ptr read_block(Stream&& ds, uint32_t expect_block_num = 0) {
+      signed_block_ptr read_block(Stream&& ds, uint32_t expect_block_num = 0, bool compressed = false) {
          auto block = std::make_shared<signed_block>();
-         fc::raw::unpack(ds, *block);
+         if (compressed)
+            fc::raw::unpack(read_compressed_block_entry(ds), *block);
+         else
+            fc::raw::unpack(ds, *block);
          if (expect_block_num != 0) {
             EOS_ASSERT(!!block && block->block_num() == expect_block_num, block_log_exception,
                        "Wrong block was read from block log.");
@@ -186,7 +241,10 @@ namespace eosio { namespace chain {
       }
 
       template <typename Stream>
-      std::vector<char> read_serialized_block(Stream&& ds, uint64_t block_size) {
+      std::vector<char> read_serialized_block(Stream&& ds, uint64_t block_size, bool compressed = false) {
+         if (compressed)
+            return read_compressed_block_entry(ds);
+
          std::vector<char> buff;
          buff.resize(block_size);
 
@@ -195,6 +253,25 @@ namespace eosio { namespace chain {
          return buff;
       }
 
+      // Read only mapping of the first `size` bytes of an open block log file, shared by all block_views into it
+      std::shared_ptr<const bip::mapped_region> map_block_file(const fc::cfile& file, uint64_t size) {
+         return std::make_shared<const bip::mapped_region>(file, bip::read_only, 0, size);
+      }
+
+      block_view make_block_view(const std::shared_ptr<const bip::mapped_region>& region, uint64_t pos, uint64_t size) {
+         EOS_ASSERT(pos + size <= region->get_size(), block_log_exception,
+                    "Block at position ${p} with size ${s} is outside of mapped block log of size ${m}",
+                    ("p", pos)("s", size)("m", region->get_size()));
+         return block_view{region, {static_cast<const char*>(region->get_address()) + pos, size}};
+      }
+
+      // a compressed entry is decompressed into a buffer owned by the returned view
+      block_view decompress_block_view(const block_view& entry) {
+         fc::datastream<const char*> ds(entry.packed.data(), entry.packed.size());
+         auto packed_block = std::make_shared<const std::vector<char>>(read_compressed_block_entry(ds));
+         return block_view{packed_block, {packed_block->data(), packed_block->size()}};
+      }
+
       template <typename Stream>
       signed_block_header read_block_header(Stream&& ds, uint32_t expect_block_num) {
          signed_block_header bh;
@@ -213,6 +290,7 @@ namespace eosio { namespace chain {
          block_log_preamble preamble;
          uint64_t           first_block_pos = 0;
          std::size_t        size_ = 0;
+         std::shared_ptr<const bip::mapped_region> region; // mapped on first view_at(), the file is not appended to
 
        public:
          block_log_data() = default;
@@ -220,10 +298,12 @@ namespace eosio { namespace chain {
          uint64_t first_block_position() const { return first_block_pos; }
 
          const block_log_preamble& get_preamble() const { return preamble; }
+         bool                      is_compressed() const { return preamble.is_compressed(); }
 
          void open(const std::filesystem::path& path) {
             if (file.is_open())
                file.close();
+            region.reset();
             file.set_file_path(path);
             file.open("rb");
             preamble.read_from(file, file.get_file_path());
@@ -271,6 +351,13 @@ namespace eosio { namespace chain {
             return file;
          }
 
+         block_view view_at(uint64_t pos, uint64_t size) {
+            if (!region)
+               region = map_block_file(file, size_);
+            block_view entry = make_block_view(region, pos, size);
+            return is_compressed() ? decompress_block_view(entry) : entry;
+         }
+
          uint64_t remaining() const { return size() - file.tellp(); }
          /**
           *  Validate a block log entry WITHOUT deserializing the entire block data.
@@ -294,7 +381,10 @@ namespace eosio { namespace chain {
             uint64_t pos = file.tellp();
 
             try {
-               fc::raw::unpack(file, entry);
+               if (preamble.is_compressed())
+                  fc::raw::unpack(read_compressed_block_entry(file), entry);
+               else
+                  fc::raw::unpack(file, entry);
             } catch (...) { throw bad_block_exception{ std::current_exception() }; }
 
             const block_header& header = entry;
@@ -473,7 +563,7 @@ namespace eosio { namespace chain {
 
       static bool is_pruned_log_and_mask_version(uint32_t& version) {
          bool ret = version & pruned_version_flag;
-         version &= ~pruned_version_flag;
+         version &= ~version_flags;
          return ret;
       }
 
@@ -499,6 +589,7 @@ namespace eosio { namespace chain {
 
          virtual signed_block_ptr                   read_block_by_num(uint32_t block_num)        = 0;
          virtual std::vector<char>                  read_serialized_block_by_num(uint32_t block_num) = 0;
+         virtual block_view                         read_block_view_by_num(uint32_t block_num)   = 0;
          virtual std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num) = 0;
 
          virtual uint32_t version() const = 0;
@@ -536,6 +627,7 @@ namespace eosio { namespace chain {
 
          signed_block_ptr read_block_by_num(uint32_t block_num) final { return {}; };
          std::vector<char> read_serialized_block_by_num(uint32_t block_num) final { return {}; };
+         block_view read_block_view_by_num(uint32_t block_num) final { return {}; };
          std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num) final { return {}; };
 
          uint32_t         version() const final { return 0; }
@@ -547,10 +639,15 @@ namespace eosio { namespace chain {
          fc::datastream<fc::cfile> index_file;
          block_log_preamble        preamble;
          bool                      genesis_written_to_block_log = false;
+         bool                      compress_new_log             = false; // a log created by reset() stores compressed entries
+         // read only mapping of block_file for read_block_view_by_num, remapped when a block past its end is requested
+         std::shared_ptr<const bip::mapped_region> block_file_region;
 
          basic_block_log() = default;
 
-         explicit basic_block_log(std::filesystem::path log_dir) { open(log_dir); }
+         explicit basic_block_log(std::filesystem::path log_dir, bool compress = false) : compress_new_log(compress) {
+            open(log_dir);
+         }
 
          static void ensure_file_exists(fc::cfile& f) {
             if (std::filesystem::exists(f.get_file_path()))
@@ -581,6 +678,7 @@ namespace eosio { namespace chain {
          virtual void             post_append(uint64_t pos) {}
          virtual signed_block_ptr retry_read_block_by_num(uint32_t block_num) { return {}; }
          virtual std::vector<char> retry_read_serialized_block_by_num(uint32_t block_num) { return {}; }
+         virtual block_view retry_read_block_view_by_num(uint32_t block_num) { return {}; }
          virtual std::optional<signed_block_header> retry_read_block_header_by_num(uint32_t block_num) { return {}; }
 
          void append(const signed_block_ptr& b, const block_id_type& id,
@@ -600,7 +698,12 @@ namespace eosio { namespace chain {
                           block_log_append_fail, "Append to index file occurring at wrong position.",
                           ("position", (uint64_t)index_file.tellp())(
                                 "expected", (b->block_num() - preamble.first_block_num) * sizeof(uint64_t)));
-               block_file.write(packed_block.data(), packed_block.size());
+               if (preamble.is_compressed()) {
+                  const std::vector<char> entry = compress_block_entry(packed_block);
+                  block_file.write(entry.data(), entry.size());
+               } else {
+                  block_file.write(packed_block.data(), packed_block.size());
+               }
                block_file.write((char*)&pos, sizeof(pos));
                index_file.write((char*)&pos, sizeof(pos));
                index_file.flush();
@@ -668,7 +771,7 @@ namespace eosio { namespace chain {
                if (pos != block_log::npos) {
                   block_file.seek(pos);
                   fc::datastream_mirror ds(block_file, size);
-                  return read_block(ds, block_num);
+                  return read_block(ds, block_num, preamble.is_compressed());
                }
                return retry_read_block_by_num(block_num);
             }
@@ -680,13 +783,29 @@ namespace eosio { namespace chain {
                auto [ position, size ] = get_block_position_and_size(block_num);
                if (position != block_log::npos) {
                   block_file.seek(position);
-                  return read_serialized_block(block_file, size);
+                  return read_serialized_block(block_file, size, preamble.is_compressed());
                }
                return retry_read_serialized_block_by_num(block_num);
             }
             FC_LOG_AND_RETHROW()
          }
 
+         block_view read_block_view_by_num(uint32_t block_num) final {
+            try {
+               auto [ position, size ] = get_block_position_and_size(block_num);
+               if (position != block_log::npos) {
+                  if (!block_file_region || position + size > block_file_region->get_size()) {
+                     block_file.seek_end(0);
+                     block_file_region = map_block_file(block_file, block_file.tellp());
+                  }
+                  block_view entry = make_block_view(block_file_region, position, size);
+                  return preamble.is_compressed() ? decompress_block_view(entry) : entry;
+               }
+               return retry_read_block_view_by_num(block_num);
+            }
+            FC_LOG_AND_RETHROW()
+         }
+
          std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num) final {
             try {
                uint64_t pos = get_block_pos(block_num);
@@ -738,6 +857,10 @@ namespace eosio { namespace chain {
 
                genesis_written_to_block_log = true; // Assume it was constructed properly.
 
+               EOS_ASSERT(!compress_new_log || preamble.is_compressed(), block_log_exception,
+                          "${block_file} is not compressed, convert it with `spring-util block-log compress` first",
+                          ("block_file", block_file.get_file_path().string()));
+
                uint32_t number_of_blocks = log_data.number_of_blocks();
                ilog("Log has ${n} blocks", ("n", number_of_blocks));
 
@@ -787,8 +910,14 @@ namespace eosio { namespace chain {
 
          void reset(uint32_t first_bnum, std::variant<genesis_state, chain_id_type>&& chain_context, uint32_t version) {
 
+            // block_views handed out may still map the old file, truncating it under them would fault on their next
+            // read; unlinking it instead keeps their pages until the last view is released
+            block_file_region.reset();
+            if (block_file.is_open())
+               block_file.close();
+            std::filesystem::remove(block_file.get_file_path());
             block_file.open(fc::cfile::truncate_rw_mode);
-            preamble.ver             = version | (preamble.ver & pruned_version_flag);
+            preamble.ver             = version | (preamble.ver & pruned_version_flag) | (compress_new_log ? compressed_version_flag : 0);
             preamble.first_block_num = first_bnum;
             preamble.chain_context   = std::move(chain_context);
             preamble.write_to(block_file);
@@ -826,7 +955,7 @@ namespace eosio { namespace chain {
             auto pos = read_head_position();
             if (pos != block_log::npos) {
                block_file.seek(pos);
-               return read_block(block_file, 0);
+               return read_block(block_file, 0, preamble.is_compressed());
             } else {
                return {};
             }
@@ -996,7 +1125,10 @@ namespace eosio { namespace chain {
 
             try {
                signed_block entry;
-               fc::raw::unpack(ds, entry);
+               if (log_data.is_compressed())
+                  fc::raw::unpack(read_compressed_block_entry(ds), entry);
+               else
+                  fc::raw::unpack(ds, entry);
                if (entry.block_num() != expected_block_num) {
                   return false;
                }
@@ -1072,6 +1204,7 @@ namespace eosio { namespace chain {
             using std::swap;
             swap(new_block_file, block_file);
             swap(new_index_file, index_file);
+            block_file_region.reset(); // views handed out keep the retained file mapped
 
             std::filesystem::rename(tmp_block_file_path, block_file_path);
             std::filesystem::rename(tmp_index_file_path, index_file_path);
@@ -1079,7 +1212,7 @@ namespace eosio { namespace chain {
             block_file.set_file_path(block_file_path);
             index_file.set_file_path(index_file_path);
 
-            preamble.ver             = block_log::max_supported_version;
+            preamble.ver             = block_log::max_supported_version | (preamble.ver & compressed_version_flag);
             preamble.chain_context   = preamble.chain_id();
             preamble.first_block_num = this->head->ptr->block_num() + 1;
             preamble.write_to(block_file);
@@ -1103,7 +1236,7 @@ namespace eosio { namespace chain {
             auto ds = catalog.ro_stream_and_size_for_block(block_num, block_size);
             if (ds) {
                fc::datastream_mirror dsm(*ds, block_size);
-               return read_block(dsm, block_num);
+               return read_block(dsm, block_num, catalog.log_data.is_compressed());
             }
             return {};
          }
@@ -1113,11 +1246,18 @@ namespace eosio { namespace chain {
 
             auto ds = catalog.ro_stream_and_size_for_block(block_num, block_size);
             if (ds) {
-               return read_serialized_block(*ds, block_size);
+               return read_serialized_block(*ds, block_size, catalog.log_data.is_compressed());
             }
             return {};
          }
 
+         block_view retry_read_block_view_by_num(uint32_t block_num) final {
+            auto pos_size = catalog.get_block_position_and_size(block_num);
+            if (pos_size)
+               return catalog.log_data.view_at(pos_size->position, pos_size->size);
+            return {};
+         }
+
          std::optional<signed_block_header> retry_read_block_header_by_num(uint32_t block_num) final {
             auto ds = catalog.ro_stream_for_block(block_num);
             if (ds)
@@ -1162,6 +1302,8 @@ namespace eosio { namespace chain {
          uint32_t working_block_file_first_block_num() final { return first_block_number; }
 
          void transform_block_log() final {
+            EOS_ASSERT(!preamble.is_compressed(), block_log_exception,
+                       "compressed block log cannot be pruned, convert it with `spring-util block-log decompress` first");
             // convert from  non-pruned block log to pruned if necessary
             if (!preamble.is_currently_pruned()) {
                block_file.open(fc::cfile::update_rw_mode);
@@ -1272,6 +1414,9 @@ namespace eosio { namespace chain {
                                    },
                                    [&data_dir](const prune_blocklog_config& conf) -> detail::block_log_impl* {
                                       return new detail::punch_hole_block_log(data_dir, conf);
+                                   },
+                                   [&data_dir](const compressed_blocklog_config&) -> detail::block_log_impl* {
+                                      return new detail::basic_block_log(data_dir, true);
                                    } },
                        config)) {}
 
@@ -1321,6 +1466,18 @@ namespace eosio { namespace chain {
       return my->read_serialized_block_by_num(block_num);
    }
 
+   block_view block_log::read_block_view_by_num(uint32_t block_num) const {
+      std::lock_guard g(my->mtx);
+      return my->read_block_view_by_num(block_num);
+   }
+
+   signed_block_ptr block_view::unpack() const {
+      if (packed.empty())
+         return {};
+      fc::datastream<const char*> ds(packed.data(), packed.size());
+      return read_block(ds);
+   }
+
    std::optional<signed_block_header> block_log::read_block_header_by_num(uint32_t block_num) const {
       std::lock_guard g(my->mtx);
       return my->read_block_header_by_num(block_num);
@@ -1607,7 +1764,7 @@ namespace eosio { namespace chain {
       }
 
       block_log_preamble preamble;
-      preamble.ver             = block_log::max_supported_version;
+      preamble.ver             = block_log::max_supported_version | (log_bundle.log_data.get_preamble().ver & detail::compressed_version_flag);
       preamble.first_block_num = first_block_num;
       preamble.chain_context   = log_bundle.log_data.chain_id();
       preamble.write_to(new_block_file);
@@ -1762,6 +1919,61 @@ namespace eosio { namespace chain {
       }
    }
 
+   // static
+   void block_log::convert_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir, bool compress) {
+      EOS_ASSERT(block_dir != dest_dir, block_log_exception, "block_dir and dest_dir need to be different directories");
+
+      block_log_bundle log_bundle(block_dir);
+      block_log_data&  log_data  = log_bundle.log_data;
+      block_log_index& log_index = log_bundle.log_index;
+      EOS_ASSERT(log_data.is_compressed() != compress, block_log_exception, "${file} is already ${state}",
+                 ("file", log_bundle.block_file_name)("state", compress ? "compressed" : "decompressed"));
+
+      if (!std::filesystem::exists(dest_dir))
+         std::filesystem::create_directories(dest_dir);
+
+      fc::datastream<fc::cfile> new_block_file;
+      new_block_file.set_file_path(dest_dir / "blocks.log");
+      new_block_file.open(fc::cfile::truncate_rw_mode);
+      fc::datastream<fc::cfile> new_index_file;
+      new_index_file.set_file_path(dest_dir / "blocks.index");
+      new_index_file.open(fc::cfile::truncate_rw_mode);
+
+      block_log_preamble preamble = log_data.get_preamble();
+      preamble.ver = preamble.version() | (compress ? detail::compressed_version_flag : 0);
+      preamble.write_to(new_block_file);
+      new_block_file.seek_end(0);
+
+      const uint32_t num_blocks = log_index.num_blocks();
+      auto tick = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+      for (uint32_t n = 0; n < num_blocks; ++n) {
+         const uint64_t pos      = log_index.nth_block_position(n);
+         const uint64_t next_pos = n + 1 < num_blocks ? log_index.nth_block_position(n + 1) : log_data.size();
+         const std::vector<char> packed_block =
+               read_serialized_block(log_data.ro_stream_at(pos), next_pos - pos - sizeof(uint64_t), log_data.is_compressed());
+
+         const uint64_t new_pos = new_block_file.tellp();
+         if (compress) {
+            const std::vector<char> entry = compress_block_entry(packed_block);
+            new_block_file.write(entry.data(), entry.size());
+         } else {
+            new_block_file.write(packed_block.data(), packed_block.size());
+         }
+         new_block_file.write((const char*)&new_pos, sizeof(new_pos));
+         new_index_file.write((const char*)&new_pos, sizeof(new_pos));
+
+         const auto tock = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+         if (tick < tock - std::chrono::seconds(5)) {
+            ilog("${op} block log, ${n} of ${t} blocks written", ("op", compress ? "Compressing" : "Decompressing")("n", n)("t", num_blocks));
+            tick = tock;
+         }
+      }
+      new_block_file.flush();
+      new_index_file.flush();
+      ilog("${file} is ${size} bytes, was ${orig}",
+           ("file", new_block_file.get_file_path())("size", (uint64_t)new_block_file.tellp())("orig", log_data.size()));
+   }
+
    inline std::filesystem::path operator+(const std::filesystem::path& left, const std::filesystem::path& right) { return std::filesystem::path(left) += right; }
 
    void move_blocklog_files(const std::filesystem::path& src_dir, const std::filesystem::path& dest_dir, uint32_t start_block,
@@ -1804,7 +2016,8 @@ namespace eosio { namespace chain {
 
       for (auto const& [first_block_num, val] : catalog.collection) {
          if (std::filesystem::exists(temp_block_log)) {
-            if (first_block_num == end_block + 1) {
+            if (first_block_num == end_block + 1 &&
+                block_log_data(val.filename_base + ".log").is_compressed() == block_log_data(temp_block_log).is_compressed()) {
                block_log_data log_data;
                log_data.open(val.filename_base + ".log");
                if (!file.is_open())
@@ -1820,8 +2033,8 @@ namespace eosio { namespace chain {
                continue;
 
             } else
-               wlog("${file}.log cannot be merged with previous block log file because of the discontinuity of blocks, "
-                    "skip merging.",
+               wlog("${file}.log cannot be merged with previous block log file because of the discontinuity of blocks "
+                    "or a different compression, skip merging.",
                     ("file", val.filename_base));
             // there is a version or block number gap between the stride files
             move_blocklog_files(temp_path, dest_dir, start_block, end_block);
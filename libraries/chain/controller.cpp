@@ -992,6 +992,8 @@ struct controller_impl {
    fc::scoped_exit<std::function<void()>> write_chain_head = [&]() { chain_head.write(conf.state_dir / config::chain_head_filename); };
    const chain_id_type             chain_id; // read by thread_pool threads, value will not be changed
    std::atomic<bool>               replaying = false;
+   size_t                          replay_trx_count = 0;        // transactions applied while replaying the block log
+   size_t                          replay_trx_batch_count = 0;  // conflict-free batches they could execute in, see record_trx_access_sets
    bool                            is_producer_node = false; // true if node is configured as a block producer
    block_num_type                  pause_at_block_num = std::numeric_limits<block_num_type>::max();
    const db_read_mode              read_mode;
@@ -1003,6 +1005,8 @@ struct controller_impl {
    named_thread_pool<chain>        thread_pool;
    deep_mind_handler*              deep_mind_logger = nullptr;
    bool                            okay_to_print_integrity_hash_on_stop = false;
+   fc::time_point                  last_state_checkpoint;
+   fc::time_point                  last_state_release_free_memory;
    bool                            testing_allow_voting = false; // used in unit tests to create long forks or simulate not getting votes
    async_t                         async_voting = async_t::yes;  // by default we post `create_and_send_vote_msg()` calls, used in tester
    async_t                         async_aggregation = async_t::yes; // by default we process incoming votes asynchronously
@@ -1679,9 +1683,56 @@ struct controller_impl {
 
       fork_db_.apply<void>(mark_branch_irreversible);
 
+      release_free_state_memory_if_needed();
+      checkpoint_state_if_needed();
+
       return result;
    }
 
+   // Return the pages backing free memory of the state database to the OS, released pages need not be checkpointed
+   void release_free_state_memory_if_needed() {
+      if (conf.state_release_free_memory_interval_sec == 0)
+         return;
+      const auto now = fc::time_point::now();
+      if (now - last_state_release_free_memory < fc::seconds(conf.state_release_free_memory_interval_sec))
+         return;
+      last_state_release_free_memory = now;
+
+      const size_t released = db.release_free_memory();
+      dlog("Released ${r} MiB of free state database memory in ${t}us",
+           ("r", released / (1024*1024))("t", (fc::time_point::now() - now).count()));
+   }
+
+   // Persist the state database so that after an unclean shutdown nodeos can restart from the fork database root
+   // (the checkpointed state still contains the undo sessions above it) instead of requiring a replay or snapshot.
+   void checkpoint_state_if_needed() {
+      if (conf.state_checkpoint_interval_sec == 0)
+         return;
+      const auto now = fc::time_point::now();
+      if (now - last_state_checkpoint < fc::seconds(conf.state_checkpoint_interval_sec))
+         return;
+      // during the savanna transition the fork database root can't be reconstructed from a single block state
+      if (fork_db_.version_in_use() == fork_database::in_use_t::both)
+         return;
+      last_state_checkpoint = now;
+
+      // chain_head.dat must never describe a different state than the one on disk, so it only exists while they match
+      const auto chain_head_file = conf.state_dir / config::chain_head_filename;
+      std::filesystem::remove(chain_head_file);
+
+      const size_t pages = db.checkpoint();
+      if (pages == 0) {
+         wlog("State database checkpoints require database-map-mode = mapped_private or mapped_prefetch and Soft-Dirty page tracking, disabling");
+         conf.state_checkpoint_interval_sec = 0;
+         return;
+      }
+
+      block_handle root = fork_db_.apply<block_handle>([](const auto& fork_db) { return block_handle{fork_db.root()}; });
+      root.write(chain_head_file);
+      dlog("State database checkpoint of ${p} pages at irreversible block ${bn} in ${t}us",
+           ("p", pages)("bn", root.block_num())("t", (fc::time_point::now() - now).count()));
+   }
+
    void initialize_blockchain_state(const genesis_state& genesis) {
       ilog( "Initializing new blockchain with genesis state" );
 
@@ -1736,10 +1787,44 @@ struct controller_impl {
 
       assert(start_block_num <= blog_head->block_num());
 
+      // blocks are read from the block log and their transaction metadata created, with keys recovered when auth
+      // is checked, in the thread pool ahead of the block being applied
+      struct read_ahead_block {
+         signed_block_ptr block;
+         block_trx_metas  trx_metas;
+      };
+      std::deque<std::future<read_ahead_block>> read_ahead;
+      block_num_type next_to_read = start_block_num;
+      auto start_read_ahead = [&]() {
+         while( read_ahead.size() < replay_read_ahead_blocks && next_to_read <= blog_head->block_num() ) {
+            read_ahead.emplace_back( post_async_task( thread_pool.get_executor(), [this, block_num = next_to_read]() {
+               read_ahead_block r{ .block = blog.read_block_by_num( block_num ) };
+               if( r.block ) {
+                  const bool skip_auth_checks = skip_auth_check_for( *r.block, controller::block_status::irreversible );
+                  r.trx_metas = start_recover_block_keys( r.block, skip_auth_checks, trx_meta_cache_lookup{} );
+               }
+               return r;
+            } ) );
+            ++next_to_read;
+         }
+      };
+      auto wait_read_ahead = fc::make_scoped_exit([&]() {
+         for( auto& f : read_ahead ) f.wait(); // tasks reference the block log
+      });
+      replay_trx_count = replay_trx_batch_count = 0;
+
       std::exception_ptr except_ptr;
       ilog( "existing block log, attempting to replay from ${s} to ${n} blocks", ("s", start_block_num)("n", blog_head->block_num()) );
       try {
-         while( auto next = blog.read_block_by_num( chain_head.block_num() + 1 ) ) {
+         start_read_ahead();
+         while( !read_ahead.empty() ) {
+            read_ahead_block ra = read_ahead.front().get();
+            read_ahead.pop_front();
+            start_read_ahead();
+            const signed_block_ptr& next = ra.block;
+            if( !next )
+               break;
+            assert( next->block_num() == chain_head.block_num() + 1 );
             block_handle_accessor::apply_l<void>(chain_head, [&](const auto& head) {
                if (next->is_proper_svnn_block()) {
                   // validated already or not in replay_irreversible_block according to conf.force_all_checks;
@@ -1779,7 +1864,7 @@ struct controller_impl {
                }
             });
             block_handle_accessor::apply<void>(chain_head, [&]<typename T>(const T&) {
-               replay_irreversible_block<T>( next );
+               replay_irreversible_block<T>( next, std::move(ra.trx_metas) );
             });
             if( check_shutdown() ) {  // needed on every loop for terminate-at-block
                ilog( "quitting from replay_block_log because of shutdown" );
@@ -1800,6 +1885,10 @@ struct controller_impl {
       ilog( "replayed ${n} blocks in ${duration} seconds, ${mspb} ms/block",
             ("n", chain_head.block_num() + 1 - start_block_num)("duration", (end-start).count()/1000000)
             ("mspb", ((end-start).count()/1000.0)/(chain_head.block_num()-start_block_num)) );
+      if( conf.record_trx_access_sets && replay_trx_batch_count > 0 ) {
+         ilog( "replayed ${t} transactions sequentially, they could execute in ${b} conflict-free batches, ${p} transactions per batch",
+               ("t", replay_trx_count)("b", replay_trx_batch_count)("p", double(replay_trx_count) / replay_trx_batch_count) );
+      }
 
       // if the irreverible log is played without undo sessions enabled, we need to sync the
       // revision ordinal to the appropriate expected value here.
@@ -2030,8 +2119,10 @@ struct controller_impl {
       bool valid = chain_head.read(conf.state_dir / config::chain_head_filename);
       EOS_ASSERT( valid, database_exception, "No existing chain_head.dat file");
 
-      EOS_ASSERT(db.revision() == chain_head.block_num(), database_exception,
-                 "chain_head block num ${bn} does not match chainbase revision ${r}",
+      // A state database checkpoint (see checkpoint_state_if_needed) is taken at head while chain_head.dat describes the
+      // fork database root, so after an unclean shutdown the revision can be ahead; init() undoes back to chain_head.
+      EOS_ASSERT(db.revision() >= chain_head.block_num(), database_exception,
+                 "chain_head block num ${bn} is ahead of chainbase revision ${r}",
                  ("bn", chain_head.block_num())("r", db.revision()));
 
       init(startup_t::existing_state);
@@ -2182,37 +2273,58 @@ struct controller_impl {
       db.undo_all();
    }
 
-   void add_contract_rows_to_snapshot( const snapshot_writer_ptr& snapshot, snapshot_written_row_counter& row_counter ) const {
-      contract_database_index_set::walk_indices([this, &snapshot, &row_counter]( auto utils ) {
+   void add_contract_rows_to_snapshot( const snapshot_writer_ptr& snapshot, snapshot_written_row_counter& row_counter, boost::asio::io_context& ctx ) const {
+      contract_database_index_set::walk_indices([this, &snapshot, &row_counter, &ctx]( auto utils ) {
          using utils_t = decltype(utils);
          using value_t = typename decltype(utils)::index_t::value_type;
          using by_table_id = object_to_table_id_tag_t<value_t>;
 
-         snapshot->write_section<value_t>([this, &row_counter]( auto& section ) {
-            table_id flattened_table_id = -1; //first table id will be assigned 0 by chainbase
-
-            index_utils<table_id_multi_index>::walk(db, [this, &section, &flattened_table_id, &row_counter](const table_id_object& table_row) {
-               auto tid_key = boost::make_tuple(table_row.id);
-               auto next_tid_key = boost::make_tuple(table_id_object::id_type(table_row.id._id + 1));
-
-               //Tables are stored in the snapshot by their sorted by-id walked order, but without record of their table id. On snapshot
-               // load, the table index will be reloaded in order, but all table ids flattened by chainbase to their insert order.
-               // e.g. if walking table ids 4,5,10,11,12 on creation, these will be reloaded as table ids 0,1,2,3,4. Track this
-               // flattened order here to know the "new" (upon snapshot load) table id a row belongs to
-               ++flattened_table_id;
-
-               unsigned_int size = utils_t::template size_range<by_table_id>(db, tid_key, next_tid_key);
-               if(size == 0u)
-                  return;
+         struct table_rows {
+            table_id_object::id_type id;
+            table_id                 flattened_id;
+            unsigned_int             size;
+         };
+         // non-empty tables, and the index of the first table of each part of the section
+         auto tables = std::make_shared<std::vector<table_rows>>();
+         auto parts = std::make_shared<std::vector<size_t>>();
+
+         //Tables are stored in the snapshot by their sorted by-id walked order, but without record of their table id. On snapshot
+         // load, the table index will be reloaded in order, but all table ids flattened by chainbase to their insert order.
+         // e.g. if walking table ids 4,5,10,11,12 on creation, these will be reloaded as table ids 0,1,2,3,4. Track this
+         // flattened order here to know the "new" (upon snapshot load) table id a row belongs to
+         table_id flattened_table_id = -1; //first table id will be assigned 0 by chainbase
+         size_t rows_in_part = 0;
+         index_utils<table_id_multi_index>::walk(db, [&](const table_id_object& table_row) {
+            ++flattened_table_id;
+
+            unsigned_int size = utils_t::template size_range<by_table_id>(db, boost::make_tuple(table_row.id),
+                                                                          boost::make_tuple(table_id_object::id_type(table_row.id._id + 1)));
+            if(size == 0u)
+               return;
+
+            // tables are never split, so a large table makes up a part of its own
+            if(parts->empty() || rows_in_part >= conf.snapshot_contract_rows_per_part) {
+               parts->push_back(tables->size());
+               rows_in_part = 0;
+            }
+            tables->push_back({table_row.id, flattened_table_id, size});
+            rows_in_part += size.value;
+         });
 
-               section.add_row(flattened_table_id, db); //indicate the new (flattened for load) table id for next...
-               section.add_row(size, db);               //...number of rows
+         snapshot->post_section_parts(ctx, detail::snapshot_section_traits<value_t>::section_name(), parts->size(),
+                                      [this, &row_counter, tables, parts]( auto& section, size_t part ) {
+            const size_t end = part + 1 < parts->size() ? (*parts)[part + 1] : tables->size();
+            for(size_t i = (*parts)[part]; i < end; ++i) {
+               const table_rows& table = (*tables)[i];
+               section.add_row(table.flattened_id, db); //indicate the new (flattened for load) table id for next...
+               section.add_row(table.size, db);         //...number of rows
 
-               utils_t::template walk_range<by_table_id>(db, tid_key, next_tid_key, [this, &section, &row_counter]( const auto &row ) {
+               utils_t::template walk_range<by_table_id>(db, boost::make_tuple(table.id), boost::make_tuple(table_id_object::id_type(table.id._id + 1)),
+                                                         [this, &section, &row_counter]( const auto &row ) {
                   section.add_row(row, db);
                   row_counter.progress();
                });
-            });
+            }
          });
       });
    }
@@ -2319,7 +2431,11 @@ struct controller_impl {
          section.add_row(snapshot_detail::snapshot_block_state_data_v8(get_block_state_to_snapshot()), db);
       });
 
-      controller_index_set::walk_indices([this, &snapshot, &row_counter]( auto utils ){
+      // the database is not modified until the work queue completes, so sections are serialized concurrently from it
+      sync_threaded_work<struct snapwrite> snapshot_write_workqueue;
+      boost::asio::io_context& snapshot_write_ctx = snapshot_write_workqueue.io_context();
+
+      controller_index_set::walk_indices([this, &snapshot, &row_counter, &snapshot_write_ctx]( auto utils ){
          using value_t = typename decltype(utils)::index_t::value_type;
 
          // skip the database_header as it is only relevant to in-memory database
@@ -2327,7 +2443,7 @@ struct controller_impl {
             return;
          }
 
-         snapshot->write_section<value_t>([this, &row_counter]( auto& section ){
+         snapshot->post_section<value_t>(snapshot_write_ctx, [this, &row_counter]( auto& section ){
             decltype(utils)::walk(db, [this, &section, &row_counter]( const auto &row ) {
                section.add_row(row, db);
                row_counter.progress();
@@ -2335,10 +2451,13 @@ struct controller_impl {
          });
       });
 
-      add_contract_rows_to_snapshot(snapshot, row_counter);
+      add_contract_rows_to_snapshot(snapshot, row_counter, snapshot_write_ctx);
+
+      authorization.add_to_snapshot(snapshot, row_counter, snapshot_write_ctx);
+      resource_limits.add_to_snapshot(snapshot, row_counter, snapshot_write_ctx);
 
-      authorization.add_to_snapshot(snapshot, row_counter);
-      resource_limits.add_to_snapshot(snapshot, row_counter);
+      constexpr unsigned max_snapshot_write_threads = 4;
+      snapshot_write_workqueue.run(snapshot->supports_threading() ? max_snapshot_write_threads : 1);
    }
 
    static std::optional<genesis_state> extract_legacy_genesis_state( snapshot_reader& snapshot, uint32_t version ) {
@@ -3791,9 +3910,73 @@ struct controller_impl {
       return {};
    }
 
+   // number of blocks ahead of the one being applied for which transaction public key recovery is started
+   static constexpr size_t key_recovery_lookahead_blocks = 4;
+   // number of blocks ahead of the one being applied that are read from the block log during replay
+   static constexpr size_t replay_read_ahead_blocks = 8;
+
+   // transaction metadata of a block, with public key recovery possibly still running in the thread pool
+   struct block_trx_metas {
+      bool                                                                    skip_auth_checks = false;
+      std::vector<std::tuple<transaction_metadata_ptr, recover_keys_future>>  trx_metas;
+   };
+
+   // same as skip_auth_check() will be once apply_block has started block b with status s
+   bool skip_auth_check_for( const signed_block& b, controller::block_status s ) const {
+      const bool consider_skipping_on_replay =
+            (s == controller::block_status::irreversible || s == controller::block_status::validated) && !conf.force_all_checks;
+      const bool consider_skipping_on_validate = s == controller::block_status::complete &&
+                                                 (conf.block_validation_mode == validation_mode::LIGHT || is_trusted_producer(b.producer));
+      return consider_skipping_on_replay || consider_skipping_on_validate;
+   }
+
+   // starts recovery of the public keys of the transactions of b in the thread pool, reusing already recovered ones of trx_lookup.
+   // Transactions are recovered in one chunk per thread pool thread rather than one task per transaction.
+   block_trx_metas start_recover_block_keys( const signed_block_ptr& b, bool skip_auth_checks, const trx_meta_cache_lookup& trx_lookup ) {
+      block_trx_metas result{ .skip_auth_checks = skip_auth_checks };
+      auto& trx_metas = result.trx_metas;
+      trx_metas.reserve( b->transactions.size() );
+      std::vector<packed_transaction_ptr> to_recover;
+      std::vector<size_t> to_recover_idx; // index into trx_metas of each of to_recover
+      for( const auto& receipt : b->transactions ) {
+         if( std::holds_alternative<packed_transaction>(receipt.trx)) {
+            const auto& pt = std::get<packed_transaction>(receipt.trx);
+            transaction_metadata_ptr trx_meta_ptr = trx_lookup ? trx_lookup( pt.id() ) : transaction_metadata_ptr{};
+            if( trx_meta_ptr && *trx_meta_ptr->packed_trx() != pt ) trx_meta_ptr = nullptr;
+            if( trx_meta_ptr && ( skip_auth_checks || !trx_meta_ptr->recovered_keys().empty() ) ) {
+               trx_metas.emplace_back( std::move( trx_meta_ptr ), recover_keys_future{} );
+            } else if( skip_auth_checks ) {
+               packed_transaction_ptr ptrx( b, &pt ); // alias signed_block_ptr
+               trx_metas.emplace_back(
+                  transaction_metadata::create_no_recover_keys( std::move(ptrx), transaction_metadata::trx_type::input ),
+                  recover_keys_future{} );
+            } else {
+               to_recover.emplace_back( b, &pt ); // alias signed_block_ptr
+               to_recover_idx.push_back( trx_metas.size() );
+               trx_metas.emplace_back( transaction_metadata_ptr{}, recover_keys_future{} );
+            }
+         }
+      }
+      if( !to_recover.empty() ) {
+         auto futs = transaction_metadata::start_recover_keys(
+            std::move( to_recover ), thread_pool.get_executor(), conf.chain_thread_pool_size, chain_id,
+            fc::microseconds::maximum(), transaction_metadata::trx_type::input );
+         for( size_t i = 0; i < futs.size(); ++i )
+            std::get<1>( trx_metas[to_recover_idx[i]] ) = std::move( futs[i] );
+      }
+      return result;
+   }
+
+   // true if apply_block will use the transaction metadata already attached to bsp
+   template<class BSP>
+   bool uses_cached_trx_metas( const BSP& bsp, bool skip_auth_checks ) const {
+      return bsp->is_pub_keys_recovered() || (skip_auth_checks && !bsp->trxs_metas().empty());
+   }
+
    template<class BSP>
    controller::apply_blocks_result_t::status_t apply_block( const BSP& bsp, controller::block_status s,
-                                                            const trx_meta_cache_lookup& trx_lookup ) {
+                                                            const trx_meta_cache_lookup& trx_lookup,
+                                                            std::optional<block_trx_metas> started_trx_metas = {} ) {
       try {
          try {
             if (should_terminate()) {
@@ -3834,39 +4017,24 @@ struct controller_impl {
             // validated in accept_block()
             std::get<building_block>(pending->_block_stage).trx_mroot_or_receipt_digests() = b->transaction_mroot;
 
-            const bool existing_trxs_metas = !bsp->trxs_metas().empty();
-            const bool pub_keys_recovered = bsp->is_pub_keys_recovered();
             const bool skip_auth_checks = skip_auth_check();
             std::vector<std::tuple<transaction_metadata_ptr, recover_keys_future>> trx_metas;
-            bool use_bsp_cached = false;
-            if( pub_keys_recovered || (skip_auth_checks && existing_trxs_metas) ) {
-               use_bsp_cached = true;
-            } else {
-               trx_metas.reserve( b->transactions.size() );
-               for( const auto& receipt : b->transactions ) {
-                  if( std::holds_alternative<packed_transaction>(receipt.trx)) {
-                     const auto& pt = std::get<packed_transaction>(receipt.trx);
-                     transaction_metadata_ptr trx_meta_ptr = trx_lookup ? trx_lookup( pt.id() ) : transaction_metadata_ptr{};
-                     if( trx_meta_ptr && *trx_meta_ptr->packed_trx() != pt ) trx_meta_ptr = nullptr;
-                     if( trx_meta_ptr && ( skip_auth_checks || !trx_meta_ptr->recovered_keys().empty() ) ) {
-                        trx_metas.emplace_back( std::move( trx_meta_ptr ), recover_keys_future{} );
-                     } else if( skip_auth_checks ) {
-                        packed_transaction_ptr ptrx( b, &pt ); // alias signed_block_ptr
-                        trx_metas.emplace_back(
-                           transaction_metadata::create_no_recover_keys( std::move(ptrx), transaction_metadata::trx_type::input ),
-                           recover_keys_future{} );
-                     } else {
-                        packed_transaction_ptr ptrx( b, &pt ); // alias signed_block_ptr
-                        auto fut = transaction_metadata::start_recover_keys(
-                           std::move( ptrx ), thread_pool.get_executor(), chain_id, fc::microseconds::maximum(),
-                           transaction_metadata::trx_type::input  );
-                        trx_metas.emplace_back( transaction_metadata_ptr{}, std::move( fut ) );
-                     }
-                  }
-               }
+            const bool use_bsp_cached = uses_cached_trx_metas( bsp, skip_auth_checks );
+            if( !use_bsp_cached ) {
+               // recovery started ahead of time is only usable if it was started for the same auth checks
+               if( started_trx_metas && started_trx_metas->skip_auth_checks == skip_auth_checks )
+                  trx_metas = std::move( started_trx_metas->trx_metas );
+               else
+                  trx_metas = start_recover_block_keys( b, skip_auth_checks, trx_lookup ).trx_metas;
             }
 
             transaction_trace_ptr trace;
+            std::vector<const transaction_access_set*> access_sets; // of the block's transactions when recorded
+            std::vector<transaction_trace_ptr> traces;               // keeps access_sets alive
+            if( conf.record_trx_access_sets ) {
+               access_sets.reserve( b->transactions.size() );
+               traces.reserve( b->transactions.size() );
+            }
 
             size_t packed_idx = 0;
             const auto& trx_receipts = std::get<building_block>(pending->_block_stage).pending_trx_receipts();
@@ -3909,6 +4077,24 @@ struct controller_impl {
                EOS_ASSERT(r == static_cast<const transaction_receipt_header&>(receipt), block_validate_exception,
                           "receipt does not match, ${lhs} != ${rhs}",
                           ("lhs", r)("rhs", static_cast<const transaction_receipt_header&>(receipt)));
+
+               if( conf.record_trx_access_sets ) {
+                  access_sets.push_back( trace ? trace->access_set.get() : nullptr );
+                  traces.push_back( std::move(trace) );
+               }
+            }
+
+            // transactions are always applied one at a time in block order, the batches are only reported to measure
+            // how much a parallel apply could gain; chainbase has a single writer and undo stack so it is not done
+            if( conf.record_trx_access_sets && !access_sets.empty() ) {
+               const size_t batches = partition_conflict_free( access_sets ).size();
+               if( replaying ) {
+                  replay_trx_count += access_sets.size();
+                  replay_trx_batch_count += batches;
+               } else {
+                  dlog( "block ${n} ${t} transactions could execute in ${b} conflict-free batches",
+                        ("n", b->block_num())("t", access_sets.size())("b", batches) );
+               }
             }
 
             if constexpr (std::is_same_v<BSP, block_state_ptr>) {
@@ -4423,7 +4609,7 @@ struct controller_impl {
    }
 
    template <class BSP>
-   void replay_irreversible_block( const signed_block_ptr& b ) {
+   void replay_irreversible_block( const signed_block_ptr& b, std::optional<block_trx_metas> started_trx_metas = {} ) {
       validate_db_available_size();
 
       assert(!pending); // should not be pending block
@@ -4455,7 +4641,7 @@ struct controller_impl {
 
                BSP bsp = std::make_shared<typename BSP::element_type>(*head, b, protocol_features.get_protocol_feature_set(), validator, skip_validate_signee);
 
-               if (apply_block(bsp, controller::block_status::irreversible, trx_meta_cache_lookup{}) == controller::apply_blocks_result_t::status_t::complete) {
+               if (apply_block(bsp, controller::block_status::irreversible, trx_meta_cache_lookup{}, std::move(started_trx_metas)) == controller::apply_blocks_result_t::status_t::complete) {
                   // On replay, log_irreversible is not called and so no irreversible_block signal is emitted.
                   // So emit it explicitly here.
                   emit( irreversible_block, std::tie(bsp->block, bsp->id()), __FILE__, __LINE__ );
@@ -4540,14 +4726,40 @@ struct controller_impl {
             }
          }
 
+         // Pipeline key recovery: while a block is applied on this thread, the transaction public keys of the next
+         // blocks of the branch are recovered in the thread pool. Block decoding, producer signature and QC
+         // verification already happen off this thread when the block is accepted into the fork database.
+         std::deque<block_trx_metas> started_trx_metas; // for the blocks [ritr, next_to_start), in apply order
+         auto next_to_start = new_head_branch.rbegin();
+         auto block_status_of = [](const auto& bsp) {
+            return bsp->is_valid() ? controller::block_status::validated : controller::block_status::complete;
+         };
+         auto start_recover_keys_ahead = [&]() {
+            while( next_to_start != new_head_branch.rend() && started_trx_metas.size() < key_recovery_lookahead_blocks ) {
+               const auto& next_bsp = *next_to_start;
+               const bool skip_auth_checks = skip_auth_check_for( *next_bsp->block, block_status_of(next_bsp) );
+               started_trx_metas.push_back( uses_cached_trx_metas( next_bsp, skip_auth_checks )
+                                               ? block_trx_metas{ .skip_auth_checks = skip_auth_checks }
+                                               : start_recover_block_keys( next_bsp->block, skip_auth_checks, trx_lookup ) );
+               ++next_to_start;
+            }
+         };
+
          const auto start_apply_blocks_loop = fc::time_point::now();
          for( auto ritr = new_head_branch.rbegin(); ritr != new_head_branch.rend(); ++ritr ) {
             auto except = std::exception_ptr{};
             const auto& bsp = *ritr;
             try {
+               std::optional<block_trx_metas> trx_metas;
+               if( next_to_start == ritr ) {
+                  ++next_to_start; // not started ahead, apply_block recovers the keys itself
+               } else {
+                  trx_metas = std::move( started_trx_metas.front() );
+                  started_trx_metas.pop_front();
+               }
+               start_recover_keys_ahead();
                controller::apply_blocks_result_t::status_t r =
-                  apply_block( bsp, bsp->is_valid() ? controller::block_status::validated
-                                                    : controller::block_status::complete, trx_lookup );
+                  apply_block( bsp, block_status_of(bsp), trx_lookup, std::move(trx_metas) );
                if (r == controller::apply_blocks_result_t::status_t::complete)
                   ++result.num_blocks_applied;
 
@@ -5674,6 +5886,15 @@ std::vector<char> controller::fetch_serialized_block_by_number( uint32_t block_n
    return my->blog.read_serialized_block_by_num(block_num);
 } FC_CAPTURE_AND_RETHROW( (block_num) ) }
 
+block_view controller::fetch_block_view_by_number( uint32_t block_num)const  { try {
+   if (signed_block_ptr b = my->fork_db_fetch_block_on_best_branch_by_num(block_num)) {
+      const auto& packed = b->packed_signed_block();
+      return block_view{b, {packed.data(), packed.size()}};
+   }
+
+   return my->blog.read_block_view_by_num(block_num);
+} FC_CAPTURE_AND_RETHROW( (block_num) ) }
+
 std::optional<signed_block_header> controller::fetch_block_header_by_number( uint32_t block_num )const  { try {
    auto b = my->fork_db_fetch_block_on_best_branch_by_num(block_num);
    if (b)
@@ -5982,6 +6203,10 @@ bool controller::is_ram_billing_in_notify_allowed()const {
    return my->conf.disable_all_subjective_mitigations || !is_speculative_block() || my->conf.allow_ram_billing_in_notify;
 }
 
+bool controller::is_recording_trx_access_sets()const {
+   return my->conf.record_trx_access_sets;
+}
+
 uint32_t controller::configured_subjective_signature_length_limit()const {
    return my->conf.maximum_variable_signature_length;
 }
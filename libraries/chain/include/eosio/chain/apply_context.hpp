@@ -185,6 +185,7 @@ class apply_context {
 //               context.require_write_lock( scope );
 
                const auto& tab = context.find_or_create_table( context.receiver, name(scope), name(table), payer );
+               context.record_table_write( tab );
 
                const auto& obj = context.db.create<ObjectType>( [&]( auto& o ){
                   o.t_id          = tab.id;
@@ -219,6 +220,7 @@ class apply_context {
 
                const auto& table_obj = itr_cache.get_table( obj.t_id );
                EOS_ASSERT( table_obj.code == context.receiver, table_access_violation, "db access violation" );
+               context.record_table_write( table_obj );
 
                if (auto dm_logger = context.control.get_deep_mind_logger(context.trx_context.is_transient())) {
                   std::string event_id = RAM_EVENT_ID("${code}:${scope}:${table}:${index_name}",
@@ -252,6 +254,7 @@ class apply_context {
 
                const auto& table_obj = itr_cache.get_table( obj.t_id );
                EOS_ASSERT( table_obj.code == context.receiver, table_access_violation, "db access violation" );
+               context.record_table_write( table_obj );
 
 //               context.require_write_lock( table_obj.scope );
 
@@ -574,6 +577,7 @@ class apply_context {
       const table_id_object* find_table( name code, name scope, name table );
       const table_id_object& find_or_create_table( name code, name scope, name table, const account_name &payer );
       void                   remove_table( const table_id_object& tid );
+      void                   record_table_write( const table_id_object& tid );
 
       int  db_store_i64( name code, name scope, name table, const account_name& payer, uint64_t id, const char* buffer, size_t buffer_size );
 
@@ -3,11 +3,27 @@
 #include <eosio/chain/block.hpp>
 #include <eosio/chain/genesis_state.hpp>
 #include <eosio/chain/block_log_config.hpp>
+#include <memory>
+#include <span>
 
 namespace eosio { namespace chain {
 
    namespace detail { struct block_log_impl; }
 
+   /**
+    * A packed signed_block referenced in place, either in a read only mapping of a block log file or in
+    * the packed form cached by a signed_block. `owner` keeps the referenced memory alive, so the view stays
+    * valid after the block log is split, pruned or closed.
+    */
+   struct block_view {
+      std::shared_ptr<const void> owner;
+      std::span<const char>       packed;
+
+      bool             empty() const { return packed.empty(); }
+      size_t           size() const { return packed.size(); }
+      signed_block_ptr unpack() const;
+   };
+
    /* The block log is an external append only log of the blocks with a header. Blocks should only
     * be written to the log after they irreverisble as the log is append only. The log is a doubly
     * linked list of blocks. There is a secondary index file of only block positions that enables
@@ -36,6 +52,9 @@ namespace eosio { namespace chain {
     * how many blocks at the end of the log are valid. Any earlier blocks in the log are assumed destroyed
     * and unreadable due to reclamation for purposes of saving space.
     *
+    * An optional "compressed" mode, flagged in the version field, stores each block entry as the packed block
+    * header followed by the rest of the block compressed on its own, so random access through the index file is kept.
+    *
     * Object thread-safe. Not safe to have multiple block_log objects to same data_dir.
     */
 
@@ -55,6 +74,8 @@ namespace eosio { namespace chain {
 
          signed_block_ptr  read_block_by_num(uint32_t block_num)const;
          std::vector<char> read_serialized_block_by_num(uint32_t block_num)const;
+         /// zero-copy variant of read_serialized_block_by_num, the returned view references the mapped block log file
+         block_view        read_block_view_by_num(uint32_t block_num)const;
          std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num)const;
          std::optional<block_id_type>       read_block_id_by_num(uint32_t block_num)const;
 
@@ -120,6 +141,10 @@ namespace eosio { namespace chain {
          static void smoke_test(const std::filesystem::path& block_dir, uint32_t n);
 
          static void split_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir, uint32_t stride);
+         /**
+          * Write a copy of blocks.log and blocks.index in block_dir to dest_dir with compressed (or decompressed) block entries
+          */
+         static void convert_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir, bool compress);
          static void merge_blocklogs(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir);
    private:
          std::unique_ptr<detail::block_log_impl> my;
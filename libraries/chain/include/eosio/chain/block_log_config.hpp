@@ -8,6 +8,9 @@ namespace eosio { namespace chain {
 
    struct empty_blocklog_config {};
 
+   // stores each block compressed on its own so blocks.index random access is kept
+   struct compressed_blocklog_config {};
+
    struct partitioned_blocklog_config {
       std::filesystem::path retained_dir;
       std::filesystem::path archive_dir;
@@ -24,6 +27,7 @@ namespace eosio { namespace chain {
    };
 
    using block_log_config =
-         std::variant<basic_blocklog_config, empty_blocklog_config, partitioned_blocklog_config, prune_blocklog_config>;
+         std::variant<basic_blocklog_config, empty_blocklog_config, partitioned_blocklog_config, prune_blocklog_config,
+                      compressed_blocklog_config>;
 
 }} // namespace eosio::chain
@@ -86,6 +86,7 @@ const static uint16_t   default_vote_thread_pool_size                = 4;
 const static uint32_t   default_max_variable_signature_length        = 16384u;
 const static uint32_t   default_max_action_return_value_size         = 256;
 const static uint32_t   default_max_reversible_blocks                = 3600u;
+const static uint32_t   default_snapshot_contract_rows_per_part      = 100'000; // contract table rows serialized as one part of a snapshot section
 
 const static uint32_t   default_max_transaction_finality_status_success_duration_sec = 180;
 const static uint32_t   default_max_transaction_finality_status_failure_duration_sec = 180;
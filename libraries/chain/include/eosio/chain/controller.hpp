@@ -147,6 +147,7 @@ namespace eosio::chain {
             bool                     disable_replay_opts    =  false;
             bool                     contracts_console      =  false;
             bool                     allow_ram_billing_in_notify = false;
+            bool                     record_trx_access_sets = false; ///< record transaction_trace::access_set of executed transactions
             uint32_t                 maximum_variable_signature_length = chain::config::default_max_variable_signature_length;
             bool                     disable_all_subjective_mitigations = false; //< for developer & testing purposes, can be configured using `disable-all-subjective-mitigations` when `EOSIO_DEVELOPER` build option is provided
             uint32_t                 terminate_at_block     = 0;
@@ -154,6 +155,9 @@ namespace eosio::chain {
             uint32_t                 num_configured_p2p_peers = 0;
             bool                     integrity_hash_on_start= false;
             bool                     integrity_hash_on_stop = false;
+            uint32_t                 state_checkpoint_interval_sec = 0; ///< 0 disables periodic checkpoints of the state database
+            uint32_t                 state_release_free_memory_interval_sec = 0; ///< 0 disables periodic release of free state database memory
+            uint32_t                 snapshot_contract_rows_per_part = chain::config::default_snapshot_contract_rows_per_part; ///< tables are never split across parts
 
             wasm_interface::vm_type  wasm_runtime = chain::config::default_wasm_runtime;
             eosvmoc::config          eosvmoc_config;
@@ -361,6 +365,8 @@ namespace eosio::chain {
          signed_block_ptr fetch_block_by_id( const block_id_type& id )const;
          // thread-safe, retrieves serialized signed block
          std::vector<char> fetch_serialized_block_by_number( uint32_t block_num)const;
+         // thread-safe, retrieves serialized signed block without copying it out of the fork db or block log
+         block_view fetch_block_view_by_number( uint32_t block_num)const;
          // thread-safe
          bool block_exists(const block_id_type& id) const;
          bool validated_block_exists(const block_id_type& id) const;
@@ -389,6 +395,7 @@ namespace eosio::chain {
          bool is_speculative_block()const;
 
          bool is_ram_billing_in_notify_allowed()const;
+         bool is_recording_trx_access_sets()const;
 
          //This is only an accessor to the user configured subjective limit: i.e. it does not do a
          // check similar to is_ram_billing_in_notify_allowed() to check if controller is currently
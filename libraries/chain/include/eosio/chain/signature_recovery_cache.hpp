@@ -0,0 +1,51 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace eosio::chain {
+
+/**
+ * Process-wide bounded cache of the public keys recovered from (digest, signature) pairs. A transaction relayed by
+ * net_plugin, executed speculatively by the producer and validated again inside a block has each signature recovered
+ * once. Oldest entries are evicted first. Thread safe.
+ */
+class signature_recovery_cache {
+public:
+   static constexpr size_t default_max_size = 100'000;
+
+   static signature_recovery_cache& instance();
+
+   /// 0 disables the cache and drops all entries
+   void set_max_size( size_t max_size );
+   size_t max_size() const { return _max_size; }
+
+   /// @return the public key that signed digest with sig, recovered on a cache miss
+   public_key_type recover( const signature_type& sig, const digest_type& digest );
+
+   size_t size() const;
+   void clear();
+
+private:
+   static constexpr size_t num_shards = 16;
+
+   struct shard {
+      mutable std::mutex                                       mtx;
+      boost::unordered_flat_map<digest_type, public_key_type>  keys;
+      std::deque<digest_type>                                  insertion_order; // oldest first
+   };
+
+   static digest_type cache_key( const signature_type& sig, const digest_type& digest );
+   shard& shard_for( const digest_type& key ) { return _shards[key._hash[3] % num_shards]; }
+
+   std::atomic<size_t>            _max_size{default_max_size};
+   std::array<shard, num_shards>  _shards;
+};
+
+} // namespace eosio::chain
@@ -2,18 +2,30 @@
 
 #include <eosio/chain/database_utils.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/variant_object.hpp>
 #include <fc/io/random_access_file.hpp>
+#include <boost/asio/io_context.hpp>
 #include <boost/core/demangle.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <optional>
 #include <ostream>
 #include <memory>
+#include <mutex>
 
 namespace eosio { namespace chain {
    /**
     * History:
     * Version 1: initial version with string identified sections and rows
+    * Version 2: rows of each section stored in independently compressed chunks, with an index of sections and
+    *            chunks at the end of the file
     */
    static const uint32_t current_snapshot_version = 1;
+   static const uint32_t compressed_snapshot_version = 2;
 
    namespace detail {
       template<typename T>
@@ -73,6 +85,7 @@ namespace eosio { namespace chain {
       struct abstract_snapshot_row_writer {
          virtual void write(ostream_wrapper& out) const = 0;
          virtual void write(fc::sha256::encoder& out) const = 0;
+         virtual void write(std::vector<char>& out) const = 0;
          virtual fc::variant to_variant() const = 0;
          virtual std::string row_type_name() const = 0;
       };
@@ -95,6 +108,13 @@ namespace eosio { namespace chain {
             write_stream(out);
          }
 
+         void write(std::vector<char>& out) const override {
+            const size_t offset = out.size();
+            out.resize(offset + fc::raw::pack_size(data));
+            fc::datastream<char*> ds(out.data() + offset, out.size() - offset);
+            write_stream(ds);
+         }
+
          fc::variant to_variant() const override {
             fc::variant var;
             fc::to_variant(data, var);
@@ -112,6 +132,42 @@ namespace eosio { namespace chain {
       snapshot_row_writer<T> make_row_writer( const T& data) {
          return snapshot_row_writer<T>(data);
       }
+
+      struct snapshot_section_chunk {
+         uint64_t offset = 0;
+         uint64_t size = 0;
+         uint64_t uncompressed_size = 0;
+         uint64_t row_count = 0;
+      };
+
+      /// packed rows of one part of a section written on a worker thread
+      struct snapshot_section_part {
+         void add_row( const abstract_snapshot_row_writer& row_writer ) {
+            row_writer.write(data);
+            ++row_count;
+            if(chunk_size && data.size() - chunked_size() >= chunk_size)
+               end_chunk();
+         }
+
+         void end_chunk() {
+            const uint64_t offset = chunked_size();
+            if(offset == data.size())
+               return;
+            chunks.push_back({offset, data.size() - offset, data.size() - offset, row_count - chunked_rows});
+            chunked_rows = row_count;
+         }
+
+         uint64_t chunked_size() const {
+            return chunks.empty() ? 0 : chunks.back().offset + chunks.back().size;
+         }
+
+         std::vector<char>                   data;
+         uint64_t                            row_count = 0;
+         /// when non-zero, rows are grouped into chunks of at least chunk_size bytes which never split a row
+         size_t                              chunk_size = 0;
+         std::vector<snapshot_section_chunk> chunks;
+         uint64_t                            chunked_rows = 0;
+      };
    }
 
    class snapshot_writer {
@@ -120,21 +176,37 @@ namespace eosio { namespace chain {
             public:
                template<typename T>
                void add_row( const T& row, const chainbase::database& db ) {
-                  _writer.write_row(detail::make_row_writer(detail::snapshot_row_traits<T>::to_snapshot_row(row, db)));
+                  write_row(detail::make_row_writer(detail::snapshot_row_traits<T>::to_snapshot_row(row, db)));
                }
 
             private:
                friend class snapshot_writer;
-               section_writer(snapshot_writer& writer)
+               section_writer(snapshot_writer& writer, detail::snapshot_section_part* part = nullptr)
                :_writer(writer)
+               ,_part(part)
                {
 
                }
-               snapshot_writer& _writer;
+
+               void write_row( const detail::abstract_snapshot_row_writer& row_writer ) {
+                  if(_part) {
+                     _part->add_row(row_writer);
+                  } else {
+                     _writer.write_row(row_writer);
+                  }
+               }
+
+               snapshot_writer&               _writer;
+               detail::snapshot_section_part* _part;
          };
 
          template<typename F>
          void write_section(const std::string section_name, F f) {
+            {
+               std::lock_guard g(buffered_parts_mtx);
+               EOS_ASSERT(buffered_parts.empty(), snapshot_exception,
+                          "Attempting to write section ${s} before all posted sections are written", ("s", section_name));
+            }
             write_start_section(section_name);
             auto section = section_writer(*this);
             f(section);
@@ -146,14 +218,86 @@ namespace eosio { namespace chain {
             write_section(detail::snapshot_section_traits<T>::section_name(), f);
          }
 
+         /**
+          * Writes a section whose rows are produced by calling f(section, part) for each part in [0, num_parts). When
+          * the writer supports threading each part is posted to `ctx` and its rows are packed into a buffer of its own,
+          * otherwise the parts are written immediately. Either way the output is the same as write_section: sections
+          * appear in the order they were posted, and the rows of a part precede the rows of the next part.
+          *
+          * A buffered part is written out as soon as it and every part posted before it are filled. At most
+          * max_posted_parts parts are posted to `ctx` and not yet written, the rest are posted as earlier parts are
+          * written, so a slow part holds back a bounded number of buffers.
+          */
+         template<typename F>
+         void post_section_parts(boost::asio::io_context& ctx, const std::string& section_name, size_t num_parts, F f) {
+            if(!supports_threading()) {
+               write_section(section_name, [&f, num_parts](auto& section) {
+                  for(size_t part = 0; part < num_parts; ++part)
+                     f(section, part);
+               });
+               return;
+            }
+
+            std::lock_guard g(buffered_parts_mtx);
+            if(num_parts == 0) // the section is written even without rows
+               buffered_parts.push_back({section_name, true, true, {}});
+            for(size_t part = 0; part < num_parts; ++part) {
+               buffered_parts.push_back({section_name, part == 0, part + 1 == num_parts,
+                                         [f, part](section_writer& section) { f(section, part); }});
+            }
+            post_buffered_parts(ctx);
+         }
+
+         template<typename F>
+         void post_section(boost::asio::io_context& ctx, const std::string& section_name, F f) {
+            post_section_parts(ctx, section_name, 1, [f](auto& section, size_t) {
+               f(section);
+            });
+         }
+
+         template<typename T, typename F>
+         void post_section(boost::asio::io_context& ctx, F f) {
+            post_section(ctx, detail::snapshot_section_traits<T>::section_name(), f);
+         }
+
          virtual ~snapshot_writer(){};
 
          virtual const char* name() const = 0;
 
+         virtual bool supports_threading() const {return false;}
+
       protected:
          virtual void write_start_section( const std::string& section_name ) = 0;
          virtual void write_row( const detail::abstract_snapshot_row_writer& row_writer ) = 0;
          virtual void write_end_section() = 0;
+
+         // only called, in order and between write_start_section and write_end_section, for writers supporting threading
+         virtual void write_buffered_part( const detail::snapshot_section_part& part );
+         // called on the worker thread which filled the part, once all its rows are added
+         virtual void finish_section_part( detail::snapshot_section_part& part ) {}
+         virtual size_t buffered_chunk_size() const { return 0; }
+
+      private:
+         struct buffered_part {
+            std::string                          section_name;
+            bool                                 first_in_section = false;
+            bool                                 last_in_section = false;
+            std::function<void(section_writer&)> fill; // adds the rows of the part, empty for a section without rows
+            detail::snapshot_section_part        part;
+            bool                                 filled = false;
+         };
+
+         static constexpr size_t max_posted_parts = 16;
+
+         // both called with buffered_parts_mtx held
+         void post_buffered_parts(boost::asio::io_context& ctx);
+         void write_buffered_parts();
+
+         // parts in the order they are written, the first num_posted_parts are posted to ctx; elements keep their
+         // address while parts are added to the back and written parts removed from the front
+         std::deque<buffered_part> buffered_parts;
+         size_t                    num_posted_parts = 0;
+         std::mutex                buffered_parts_mtx;
    };
 
    using snapshot_writer_ptr = std::shared_ptr<snapshot_writer>;
@@ -341,9 +485,11 @@ namespace eosio { namespace chain {
          explicit ostream_snapshot_writer(std::ostream& snapshot);
 
          const char* name() const override { return "snapshot"; }
+         bool supports_threading() const override {return true;}
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
          void write_end_section( ) override;
+         void write_buffered_part( const detail::snapshot_section_part& part ) override;
          void finalize();
 
          static const uint32_t magic_number = 0x30510550;
@@ -355,6 +501,43 @@ namespace eosio { namespace chain {
          uint64_t                row_count;
    };
 
+   namespace detail {
+      struct compressed_snapshot_section {
+         std::string                         name;
+         uint64_t                            row_count = 0;
+         std::vector<snapshot_section_chunk> chunks;
+      };
+   }
+
+   /**
+    * Writes version 2 snapshots: the rows of each section are cut into chunks of about chunk_size bytes, each
+    * compressed on its own, and an index of sections and chunks is appended, followed by its offset.
+    */
+   class ostream_compressed_snapshot_writer : public snapshot_writer {
+      public:
+         explicit ostream_compressed_snapshot_writer(std::ostream& snapshot);
+
+         const char* name() const override { return "compressed snapshot"; }
+         bool supports_threading() const override {return true;}
+         void write_start_section( const std::string& section_name ) override;
+         void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
+         void write_end_section( ) override;
+         void write_buffered_part( const detail::snapshot_section_part& part ) override;
+         void finish_section_part( detail::snapshot_section_part& part ) override;
+         size_t buffered_chunk_size() const override { return chunk_size; }
+         void finalize();
+
+         static const size_t chunk_size = 4*1024*1024;
+
+      private:
+         void write_chunks( const detail::snapshot_section_part& part );
+
+         detail::ostream_wrapper                          snapshot;
+         std::streampos                                   header_pos;
+         std::vector<detail::compressed_snapshot_section> sections;
+         std::optional<detail::snapshot_section_part>     current_part;
+   };
+
    class ostream_json_snapshot_writer : public snapshot_writer {
       public:
          explicit ostream_json_snapshot_writer(std::ostream& snapshot);
@@ -426,13 +609,28 @@ namespace eosio { namespace chain {
          bool supports_threading() const override {return true;}
 
       private:
+         void next_chunk();
+         std::future<std::vector<char>> decompress_chunk(const detail::snapshot_section_chunk& chunk);
+
+         // one chunk is decompressed ahead for each thread reading a section
+         static constexpr size_t decompress_threads = 4;
+
          fc::random_access_file                   snapshot_file;
          const boost::interprocess::mapped_region mapped_snap;
          const char* const                        mapped_snap_addr;
+         uint32_t                                 version = 0;
+         std::map<std::string, detail::compressed_snapshot_section, std::less<>> compressed_sections; // version 2 only
+         named_thread_pool<struct snapdecomp>     decompress_thread_pool; // version 2 only
 
          thread_local inline static fc::datastream<const char*> ds = fc::datastream<const char*>(nullptr, 0);
          thread_local inline static uint64_t                    num_rows;
          thread_local inline static uint64_t                    cur_row;
+
+         // version 2: the chunk being read, and the next one being decompressed in the background
+         thread_local inline static const detail::compressed_snapshot_section* cur_section;
+         thread_local inline static size_t                                     cur_chunk;
+         thread_local inline static std::vector<char>                          chunk_buffer;
+         thread_local inline static std::future<std::vector<char>>             next_chunk_buffer;
    };
 
    class integrity_hash_snapshot_writer : public snapshot_writer {
@@ -440,9 +638,11 @@ namespace eosio { namespace chain {
          explicit integrity_hash_snapshot_writer(fc::sha256::encoder&  enc);
 
          const char* name() const override { return "integrity hash"; }
+         bool supports_threading() const override {return true;}
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
          void write_end_section( ) override;
+         void write_buffered_part( const detail::snapshot_section_part& part ) override;
          void finalize();
 
       private:
@@ -453,16 +653,20 @@ namespace eosio { namespace chain {
    struct snapshot_written_row_counter {
       snapshot_written_row_counter(const size_t total, const char* name) : total(total), name(name) {}
       void progress() {
-         if(++count % 50000 == 0 && time(NULL) - last_print >= 5) {
-            ilog("${n} creation ${pct}% complete", ("n", name)("pct",std::min((unsigned)(((double)count/total)*100),100u)));
+         const size_t c = count.fetch_add(1, std::memory_order_relaxed) + 1;
+         if(c % 50000 == 0 && time(NULL) - last_print >= 5) {
+            ilog("${n} creation ${pct}% complete", ("n", name)("pct",std::min((unsigned)(((double)c/total)*100),100u)));
             last_print = time(NULL);
          }
       }
-      size_t count = 0;
+      std::atomic_size_t count = 0;
       const size_t total = 0;
       const char* name = nullptr;
-      time_t last_print = time(NULL);
+      std::atomic<time_t> last_print = time(NULL);
    };
 
    fc::variant snapshot_info(snapshot_reader& snapshot);
 }}
+
+FC_REFLECT(eosio::chain::detail::snapshot_section_chunk, (offset)(size)(uncompressed_size)(row_count))
+FC_REFLECT(eosio::chain::detail::compressed_snapshot_section, (name)(row_count)(chunks))
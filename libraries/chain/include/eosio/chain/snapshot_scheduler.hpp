@@ -175,6 +175,9 @@ private:
    // path to write the snapshots to
    fs::path _snapshots_dir;
 
+   // write compressed (version 2) snapshots
+   bool _compress_snapshots = false;
+
    void x_serialize() {
       auto& vec = _snapshot_requests.get<as_vector>();
       std::vector<snapshot_schedule_information> sr(vec.begin(), vec.end());
@@ -201,6 +204,9 @@ public:
    // set snapshot path
    void set_snapshots_path(fs::path sn_path);
 
+   // write snapshots in the compressed format
+   void set_compression(bool compress);
+
    // add pending snapshot info to inflight snapshot request
    void add_pending_snapshot_info(const snapshot_information& si);
 
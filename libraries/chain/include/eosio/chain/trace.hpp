@@ -3,6 +3,7 @@
 #include <eosio/chain/action.hpp>
 #include <eosio/chain/action_receipt.hpp>
 #include <eosio/chain/block.hpp>
+#include <eosio/chain/transaction_access_set.hpp>
 
 namespace eosio::chain {
 
@@ -107,6 +108,8 @@ namespace eosio::chain {
       std::optional<fc::exception>               except;
       std::optional<uint64_t>                    error_code;
       std::exception_ptr                         except_ptr;
+      /// set when the controller is configured to record transaction access sets, not reflected
+      std::shared_ptr<transaction_access_set>    access_set;
    };
 
    /**
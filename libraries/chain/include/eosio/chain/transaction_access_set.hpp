@@ -0,0 +1,75 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <boost/unordered/unordered_flat_set.hpp>
+
+#include <span>
+
+namespace eosio::chain {
+
+   /**
+    * The contract tables a transaction reads and writes and the accounts whose RAM or CPU/NET usage it changes,
+    * recorded by apply_context at the db intrinsic layer.
+    *
+    * Two transactions that do not conflict produce the same state when executed in either order, apart from values
+    * that are assigned in block order: action receipt sequence numbers and the block resource accumulators.
+    * Native and privileged actions, and deferred transaction scheduling, change state outside of contract tables;
+    * a transaction executing any of them is marked serial and conflicts with every other transaction.
+    */
+   class transaction_access_set {
+   public:
+      struct table_key {
+         name code;
+         name scope;
+         name table;
+
+         friend bool operator==( const table_key&, const table_key& ) = default;
+      };
+
+      void record_read( name code, name scope, name table ) { reads.insert( table_key{code, scope, table} ); }
+      void record_write( name code, name scope, name table ) { writes.insert( table_key{code, scope, table} ); }
+      void record_account( account_name account ) { accounts.insert( account ); }
+      void mark_serial() { serial = true; }
+
+      bool is_serial() const { return serial; }
+      bool empty() const { return !serial && reads.empty() && writes.empty() && accounts.empty(); }
+
+      /// @return true if executing this and other in a different order could change the result of either
+      bool conflicts_with( const transaction_access_set& other ) const;
+
+      /// add the accesses of other, e.g. to track what a batch of transactions touches
+      void merge( const transaction_access_set& other );
+
+      void clear();
+
+   private:
+      struct table_key_hash {
+         size_t operator()( const table_key& k ) const {
+            size_t seed = 0;
+            boost::hash_combine( seed, k.code.to_uint64_t() );
+            boost::hash_combine( seed, k.scope.to_uint64_t() );
+            boost::hash_combine( seed, k.table.to_uint64_t() );
+            return seed;
+         }
+      };
+      using table_set = boost::unordered_flat_set<table_key, table_key_hash>;
+
+      static bool intersects( const table_set& a, const table_set& b );
+
+      table_set                                                  reads;
+      table_set                                                  writes;
+      boost::unordered_flat_set<account_name, std::hash<name>>   accounts;
+      bool                                                       serial = false;
+   };
+
+   /**
+    * Partition transactions, in block order, into batches of mutually non-conflicting transactions.
+    * A transaction is placed in the batch after the last batch holding a transaction it conflicts with, so executing
+    * the batches in order, the transactions of a batch in any order, gives the same result as block order.
+    * Serial transactions (and a nullptr, unknown access set) get a batch of their own.
+    * @return indexes into access_sets for each batch, in execution order
+    */
+   std::vector<std::vector<size_t>> partition_conflict_free( std::span<const transaction_access_set* const> access_sets );
+
+} // namespace eosio::chain
@@ -84,6 +84,14 @@ class transaction_metadata {
                           const chain_id_type& chain_id, fc::microseconds time_limit,
                           trx_type t, uint32_t max_variable_sig_size = UINT32_MAX );
       /// Thread safe.
+      /// Recovers the keys of trxs in at most num_tasks thread pool tasks, each working through a contiguous chunk of
+      /// trxs, instead of posting a task per transaction.
+      /// @returns a future per trx, in the order of trxs, with transaction_metadata_ptr or exception
+      static std::vector<recover_keys_future>
+      start_recover_keys( std::vector<packed_transaction_ptr> trxs, boost::asio::io_context& thread_pool, size_t num_tasks,
+                          const chain_id_type& chain_id, fc::microseconds time_limit,
+                          trx_type t, uint32_t max_variable_sig_size = UINT32_MAX );
+      /// Thread safe.
       /// @returns transaction_metadata_ptr or throws
       static transaction_metadata_ptr
       recover_keys( packed_transaction_ptr trx,
@@ -6,7 +6,12 @@
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/member.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include <array>
 
 namespace eosio { namespace chain {
 
@@ -27,13 +32,16 @@ struct unapplied_transaction {
    trx_enum_type                  trx_type = trx_enum_type::unknown;
    bool                           return_failure_trace = false;
    next_func_t                    next;
+   uint64_t                       fair_round = 0; // order of incoming trxs of the same trx_type, see add_incoming
 
    const transaction_id_type& id()const { return trx_meta->id(); }
    fc::time_point_sec expiration()const { return trx_meta->packed_trx()->expiration(); }
+   account_name first_authorizer()const { return trx_meta->packed_trx()->get_transaction().first_authorizer(); }
 };
 
 /**
  * Track unapplied transactions for incoming, forked blocks, and aborted blocks.
+ * Forked and aborted transactions are kept in the order added, incoming transactions are fair queued by first authorizer.
  */
 class unapplied_transaction_queue {
 private:
@@ -46,7 +54,12 @@ private:
          hashed_unique< tag<by_trx_id>,
                const_mem_fun<unapplied_transaction, const transaction_id_type&, &unapplied_transaction::id>
          >,
-         ordered_non_unique< tag<by_type>, member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type> >,
+         ordered_non_unique< tag<by_type>,
+               composite_key< unapplied_transaction,
+                  member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type>,
+                  member<unapplied_transaction, uint64_t, &unapplied_transaction::fair_round>
+               >
+         >,
          ordered_non_unique< tag<by_expiry>, const_mem_fun<unapplied_transaction, fc::time_point_sec, &unapplied_transaction::expiration> >
       >
    > unapplied_trx_queue_type;
@@ -56,9 +69,20 @@ private:
    uint64_t size_in_bytes = 0;
    size_t incoming_count = 0;
 
+   struct incoming_account {
+      // highest fair_round of the account's queued trxs of incoming_api and incoming_p2p, rounds of different
+      // trx_types are not comparable as each trx_type is ordered separately
+      std::array<uint64_t, 2> last_round{};
+      uint32_t count = 0;      // number of the account's queued incoming trxs
+   };
+   static size_t incoming_index( trx_enum_type t ) { return t == trx_enum_type::incoming_api ? 0 : 1; }
+   boost::unordered_flat_map<account_name, incoming_account, std::hash<account_name>> incoming_accounts;
+   uint32_t max_incoming_per_account = 0; // enforced for incoming, 0 for no limit
+
 public:
 
    void set_max_transaction_queue_size( uint64_t v ) { max_transaction_queue_size = v; }
+   void set_max_incoming_per_account( uint32_t v ) { max_incoming_per_account = v; }
 
    bool empty() const {
       return queue.empty();
@@ -70,6 +94,7 @@ public:
 
    void clear() {
       queue.clear();
+      incoming_accounts.clear();
    }
 
    size_t incoming_size()const {
@@ -138,11 +163,45 @@ public:
       }
    }
 
-   void add_incoming( const transaction_metadata_ptr& trx, bool api_trx, bool return_failure_trace, next_func_t next ) {
+   /**
+    * Call before executing an incoming trx, so a first authorizer at the limit cannot bypass it when the trx is
+    * executed immediately instead of queued. add_incoming also checks the limit.
+    * @throws tx_resource_exhaustion if the first authorizer already has max_incoming_per_account trxs queued
+    */
+   void check_incoming_account_limit( const transaction_metadata_ptr& trx ) const {
+      if( max_incoming_per_account == 0 ) return;
+      const account_name first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+      if( auto aitr = incoming_accounts.find( first_auth ); aitr != incoming_accounts.end() ) {
+         EOS_ASSERT( aitr->second.count < max_incoming_per_account, tx_resource_exhaustion,
+                     "Transaction ${id}, account ${a} would exceed configured incoming-transaction-queue-max-per-account ${m}",
+                     ("id", trx->id())("a", first_auth)("m", max_incoming_per_account) );
+      }
+   }
+
+   /**
+    * Incoming trxs are ordered by fair_round instead of arrival. A trx is placed fair_cost after the later of the
+    * first queued trx of its trx_type and the last queued trx of the same trx_type of its first authorizer, so an
+    * account with a backlog of trxs does not delay the trxs of other accounts. A fair_cost of 1 for every trx gives
+    * round robin by account, a higher fair_cost for an account gives it a smaller share.
+    * @throws tx_resource_exhaustion if the first authorizer already has max_incoming_per_account trxs queued
+    */
+   void add_incoming( const transaction_metadata_ptr& trx, bool api_trx, bool return_failure_trace, next_func_t next,
+                      uint64_t fair_cost = 1 ) {
       auto itr = queue.get<by_trx_id>().find( trx->id() );
       if( itr == queue.get<by_trx_id>().end() ) {
-         auto insert_itr = queue.insert(
-               { trx, api_trx ? trx_enum_type::incoming_api : trx_enum_type::incoming_p2p, return_failure_trace, std::move( next ) } );
+         check_incoming_account_limit( trx );
+         const trx_enum_type trx_type = api_trx ? trx_enum_type::incoming_api : trx_enum_type::incoming_p2p;
+         const account_name first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+         uint64_t last_round = 0;
+         if( auto aitr = incoming_accounts.find( first_auth ); aitr != incoming_accounts.end() )
+            last_round = aitr->second.last_round[incoming_index( trx_type )];
+         uint64_t front_round = 0;
+         auto& by_type_idx = queue.get<by_type>();
+         if( auto front = by_type_idx.lower_bound( boost::make_tuple( trx_type ) ); front != by_type_idx.end() && front->trx_type == trx_type )
+            front_round = front->fair_round;
+         const uint64_t fair_round = std::max( front_round, last_round ) + std::max<uint64_t>( fair_cost, 1 );
+
+         auto insert_itr = queue.insert( { trx, trx_type, return_failure_trace, std::move( next ), fair_round } );
          if( insert_itr.second ) added( insert_itr.first );
       } else {
          if( itr->trx_meta == trx ) return; // same trx meta pointer
@@ -160,9 +219,10 @@ public:
 
    // forked, aborted
    iterator unapplied_begin() { return queue.get<by_type>().begin(); }
-   iterator unapplied_end() { return queue.get<by_type>().upper_bound( trx_enum_type::aborted ); }
+   iterator unapplied_end() { return queue.get<by_type>().upper_bound( boost::make_tuple( trx_enum_type::aborted ) ); }
 
-   iterator incoming_begin() { return queue.get<by_type>().lower_bound( trx_enum_type::incoming_api ); }
+   // incoming_api then incoming_p2p, each in fair order, begin() is the next to process
+   iterator incoming_begin() { return queue.get<by_type>().lower_bound( boost::make_tuple( trx_enum_type::incoming_api ) ); }
    iterator incoming_end() { return queue.get<by_type>().end(); } // if changed to upper_bound, verify usage performance
 
    iterator lower_bound( const transaction_id_type& id ) {
@@ -183,6 +243,10 @@ private:
       auto size = calc_size( itr->trx_meta );
       if( itr->trx_type == trx_enum_type::incoming_p2p || itr->trx_type == trx_enum_type::incoming_api ) {
          ++incoming_count;
+         auto& acct = incoming_accounts[itr->first_authorizer()];
+         uint64_t& last_round = acct.last_round[incoming_index( itr->trx_type )];
+         last_round = std::max( last_round, itr->fair_round );
+         ++acct.count;
          EOS_ASSERT( size_in_bytes + size < max_transaction_queue_size, tx_resource_exhaustion,
                      "Transaction ${id}, size ${s} bytes would exceed configured "
                      "incoming-transaction-queue-size-mb ${qs}, current queue size ${cs} bytes",
@@ -196,6 +260,9 @@ private:
    void removed( Itr itr ) {
       if( itr->trx_type == trx_enum_type::incoming_p2p || itr->trx_type == trx_enum_type::incoming_api ) {
          --incoming_count;
+         auto aitr = incoming_accounts.find( itr->first_authorizer() );
+         if( aitr != incoming_accounts.end() && --aitr->second.count == 0 )
+            incoming_accounts.erase( aitr );
       }
       size_in_bytes -= calc_size( itr->trx_meta );
    }
@@ -0,0 +1,68 @@
+#include <eosio/chain/signature_recovery_cache.hpp>
+
+namespace eosio::chain {
+
+signature_recovery_cache& signature_recovery_cache::instance() {
+   static signature_recovery_cache cache;
+   return cache;
+}
+
+void signature_recovery_cache::set_max_size( size_t max_size ) {
+   _max_size = max_size;
+   if( max_size == 0 )
+      clear();
+}
+
+digest_type signature_recovery_cache::cache_key( const signature_type& sig, const digest_type& digest ) {
+   digest_type::encoder enc;
+   fc::raw::pack( enc, digest );
+   fc::raw::pack( enc, sig );
+   return enc.result();
+}
+
+public_key_type signature_recovery_cache::recover( const signature_type& sig, const digest_type& digest ) {
+   const size_t max_size = _max_size;
+   if( max_size == 0 )
+      return public_key_type( sig, digest );
+
+   const digest_type key = cache_key( sig, digest );
+   shard& s = shard_for( key );
+   {
+      std::lock_guard g( s.mtx );
+      if( auto itr = s.keys.find( key ); itr != s.keys.end() )
+         return itr->second;
+   }
+
+   // recover outside of the lock, a concurrent recovery of the same signature only does redundant work
+   public_key_type pub_key( sig, digest );
+
+   const size_t max_shard_size = std::max<size_t>( max_size / num_shards, 1 );
+   std::lock_guard g( s.mtx );
+   if( s.keys.emplace( key, pub_key ).second ) {
+      s.insertion_order.push_back( key );
+      while( s.insertion_order.size() > max_shard_size ) {
+         s.keys.erase( s.insertion_order.front() );
+         s.insertion_order.pop_front();
+      }
+   }
+   return pub_key;
+}
+
+size_t signature_recovery_cache::size() const {
+   size_t result = 0;
+   for( const auto& s : _shards ) {
+      std::lock_guard g( s.mtx );
+      result += s.keys.size();
+   }
+   return result;
+}
+
+void signature_recovery_cache::clear() {
+   for( auto& s : _shards ) {
+      std::lock_guard g( s.mtx );
+      s.keys.clear();
+      s.insertion_order.clear();
+   }
+}
+
+} // namespace eosio::chain
@@ -12,15 +12,78 @@
 #include <fc/variant_object.hpp>
 #include <fc/io/json.hpp>
 
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
 using namespace eosio_rapidjson;
+namespace bio = boost::iostreams;
 
 namespace eosio { namespace chain {
 
+static std::vector<char> compress_snapshot_chunk(const char* data, size_t size) {
+   std::vector<char> out;
+   bio::filtering_ostream comp;
+   comp.push(bio::zlib_compressor(bio::zlib::default_compression));
+   comp.push(bio::back_inserter(out));
+   bio::write(comp, data, size);
+   bio::close(comp);
+   return out;
+}
+
+static std::vector<char> decompress_snapshot_chunk(const char* snapshot_addr, const detail::snapshot_section_chunk& chunk) {
+   std::vector<char> out(chunk.uncompressed_size);
+   bio::filtering_istreambuf decomp(bio::zlib_decompressor() | bio::array_source(snapshot_addr + chunk.offset, chunk.size));
+   EOS_ASSERT(decomp.sgetn(out.data(), out.size()) == (std::streamsize)out.size(), snapshot_exception,
+              "Binary snapshot chunk at ${o} is shorter than expected", ("o", chunk.offset));
+   return out;
+}
+
+void snapshot_writer::write_buffered_part( const detail::snapshot_section_part& ) {
+   EOS_THROW(snapshot_exception, "${n} writer does not support writing sections from buffers", ("n", name()));
+}
+
+void snapshot_writer::post_buffered_parts(boost::asio::io_context& ctx) {
+   for(; num_posted_parts < std::min(buffered_parts.size(), max_posted_parts); ++num_posted_parts) {
+      buffered_part& p = buffered_parts[num_posted_parts];
+      p.part.chunk_size = buffered_chunk_size();
+      ctx.post([this, &ctx, &p]() {
+         if(p.fill) {
+            auto section = section_writer(*this, &p.part);
+            p.fill(section);
+         }
+         finish_section_part(p.part);
+
+         std::lock_guard g(buffered_parts_mtx);
+         p.filled = true;
+         write_buffered_parts();
+         post_buffered_parts(ctx);
+      });
+   }
+}
+
+void snapshot_writer::write_buffered_parts() {
+   // parts are filled in any order; whichever thread fills the oldest outstanding part writes out every part filled
+   // so far, so parts are written in the order they were posted and their buffers released early
+   while(!buffered_parts.empty() && buffered_parts.front().filled) {
+      const buffered_part& p = buffered_parts.front();
+      if(p.first_in_section)
+         write_start_section(p.section_name);
+      write_buffered_part(p.part);
+      if(p.last_in_section)
+         write_end_section();
+      buffered_parts.pop_front();
+      --num_posted_parts;
+   }
+}
+
 variant_snapshot_writer::variant_snapshot_writer(fc::mutable_variant_object& snapshot)
 : snapshot(snapshot)
 {
@@ -193,6 +256,11 @@ void ostream_snapshot_writer::write_end_section( ) {
    row_count = 0;
 }
 
+void ostream_snapshot_writer::write_buffered_part( const detail::snapshot_section_part& part ) {
+   snapshot.write(part.data.data(), part.data.size());
+   row_count += part.row_count;
+}
+
 void ostream_snapshot_writer::finalize() {
    uint64_t end_marker = std::numeric_limits<uint64_t>::max();
 
@@ -200,6 +268,80 @@ void ostream_snapshot_writer::finalize() {
    snapshot.write((char*)&end_marker, sizeof(end_marker));
 }
 
+ostream_compressed_snapshot_writer::ostream_compressed_snapshot_writer(std::ostream& snapshot)
+:snapshot(snapshot)
+,header_pos(snapshot.tellp())
+{
+   // write magic number
+   auto totem = ostream_snapshot_writer::magic_number;
+   snapshot.write((char*)&totem, sizeof(totem));
+
+   // write version
+   auto version = compressed_snapshot_version;
+   snapshot.write((char*)&version, sizeof(version));
+}
+
+void ostream_compressed_snapshot_writer::write_start_section( const std::string& section_name ) {
+   EOS_ASSERT(!current_part, snapshot_exception, "Attempting to write a new section without closing the previous section");
+   sections.push_back({section_name});
+   current_part.emplace().chunk_size = chunk_size;
+}
+
+void ostream_compressed_snapshot_writer::write_row( const detail::abstract_snapshot_row_writer& row_writer ) {
+   current_part->add_row(row_writer);
+
+   // write out each chunk once it fills up rather than buffering the whole section
+   if(!current_part->chunks.empty()) {
+      finish_section_part(*current_part);
+      write_chunks(*current_part);
+      current_part.emplace().chunk_size = chunk_size;
+   }
+}
+
+void ostream_compressed_snapshot_writer::write_end_section( ) {
+   finish_section_part(*current_part);
+   write_chunks(*current_part);
+   current_part.reset();
+}
+
+void ostream_compressed_snapshot_writer::write_buffered_part( const detail::snapshot_section_part& part ) {
+   write_chunks(part);
+}
+
+void ostream_compressed_snapshot_writer::finish_section_part( detail::snapshot_section_part& part ) {
+   part.end_chunk();
+
+   std::vector<char> compressed;
+   for(detail::snapshot_section_chunk& chunk : part.chunks) {
+      const std::vector<char> c = compress_snapshot_chunk(part.data.data() + chunk.offset, chunk.size);
+      chunk.offset = compressed.size();
+      chunk.size = c.size();
+      compressed.insert(compressed.end(), c.begin(), c.end());
+   }
+   part.data = std::move(compressed);
+}
+
+void ostream_compressed_snapshot_writer::write_chunks( const detail::snapshot_section_part& part ) {
+   detail::compressed_snapshot_section& section = sections.back();
+   const uint64_t part_pos = snapshot.tellp() - header_pos;
+
+   snapshot.write(part.data.data(), part.data.size());
+   for(detail::snapshot_section_chunk chunk : part.chunks) {
+      chunk.offset += part_pos;
+      section.chunks.push_back(chunk);
+   }
+   section.row_count += part.row_count;
+}
+
+void ostream_compressed_snapshot_writer::finalize() {
+   EOS_ASSERT(!current_part, snapshot_exception, "Attempting to finalize a snapshot without closing the last section");
+
+   // the index is found through its offset in the last bytes of the file
+   const uint64_t index_pos = snapshot.tellp() - header_pos;
+   fc::raw::pack(snapshot, sections);
+   snapshot.write((char*)&index_pos, sizeof(index_pos));
+}
+
 ostream_json_snapshot_writer::ostream_json_snapshot_writer(std::ostream& snapshot)
       :snapshot(snapshot)
       ,row_count(0)
@@ -480,7 +622,27 @@ size_t istream_json_snapshot_reader::total_row_count() {
 threaded_snapshot_reader::threaded_snapshot_reader(const std::filesystem::path& snapshot_path) :
   snapshot_file(snapshot_path, fc::random_access_file::read_only),
   mapped_snap(snapshot_file, boost::interprocess::read_only),
-  mapped_snap_addr((char*)mapped_snap.get_address()) {}
+  mapped_snap_addr((char*)mapped_snap.get_address()) {
+   using magic_number_t = std::decay_t<decltype(ostream_snapshot_writer::magic_number)>;
+
+   if(mapped_snap.get_size() >= sizeof(magic_number_t) + sizeof(version))
+      version = snapshot_file.unpack_from<decltype(version)>(sizeof(magic_number_t));
+
+   if(version == compressed_snapshot_version) {
+      uint64_t index_pos = 0;
+      EOS_ASSERT(mapped_snap.get_size() >= sizeof(magic_number_t) + sizeof(version) + sizeof(index_pos), snapshot_exception, "Binary snapshot too short");
+      index_pos = snapshot_file.unpack_from<uint64_t>(mapped_snap.get_size() - sizeof(index_pos));
+      EOS_ASSERT(index_pos < mapped_snap.get_size() - sizeof(index_pos), snapshot_exception, "Binary snapshot has an invalid index position");
+
+      for(detail::compressed_snapshot_section& section : snapshot_file.unpack_from<std::vector<detail::compressed_snapshot_section>>(index_pos)) {
+         for(const detail::snapshot_section_chunk& chunk : section.chunks)
+            EOS_ASSERT(chunk.offset + chunk.size <= index_pos, snapshot_exception, "Binary snapshot section ${n} has a chunk past its end", ("n", section.name));
+         std::string name = section.name;
+         compressed_sections.emplace(std::move(name), std::move(section));
+      }
+      decompress_thread_pool.start(decompress_threads, decompress_thread_pool.make_on_except_abort());
+   }
+}
 
 void threaded_snapshot_reader::validate() {
    try {
@@ -490,8 +652,13 @@ void threaded_snapshot_reader::validate() {
       EOS_ASSERT(snapshot_file.unpack_from<magic_number_t>(0) == ostream_snapshot_writer::magic_number, snapshot_exception, "Binary snapshot has unexpected magic number!");
 
       const version_t actual_version = snapshot_file.unpack_from<version_t>(sizeof(magic_number_t));
-      EOS_ASSERT(actual_version == current_snapshot_version, snapshot_exception, "Binary snapshot is an unsuppored version.  Expected : ${expected}, Got: ${actual}",
-                                                                                 ("expected", current_snapshot_version)("actual", actual_version));
+      EOS_ASSERT(actual_version == current_snapshot_version || actual_version == compressed_snapshot_version, snapshot_exception,
+                 "Binary snapshot is an unsuppored version.  Expected : ${expected} or ${compressed}, Got: ${actual}",
+                 ("expected", current_snapshot_version)("compressed", compressed_snapshot_version)("actual", actual_version));
+
+      // version 2 index is validated on construction
+      if(actual_version == compressed_snapshot_version)
+         return;
 
       uint64_t next_section_offs = sizeof(magic_number_t) + sizeof(version_t);
       while(true) {
@@ -507,6 +674,22 @@ void threaded_snapshot_reader::set_section(const string& section_name) {
    using magic_number_t = std::decay_t<decltype(ostream_snapshot_writer::magic_number)>;
    using version_t = std::decay_t<decltype(current_snapshot_version)>;
 
+   if(version == compressed_snapshot_version) {
+      auto it = compressed_sections.find(section_name);
+      EOS_ASSERT(it != compressed_sections.end(), snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+
+      cur_section = &it->second;
+      cur_row = 0;
+      num_rows = cur_section->row_count;
+      cur_chunk = 0;
+      ds = fc::datastream<const char*>(nullptr, 0);
+      if(!cur_section->chunks.empty()) {
+         next_chunk_buffer = decompress_chunk(cur_section->chunks[0]);
+         next_chunk();
+      }
+      return;
+   }
+
    uint64_t next_section_offs = sizeof(magic_number_t) + sizeof(version_t);
    while(true) {
       const uint64_t this_section_size      = snapshot_file.unpack_from<uint64_t>(next_section_offs);
@@ -530,7 +713,25 @@ void threaded_snapshot_reader::set_section(const string& section_name) {
    EOS_THROW(snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
 }
 
+void threaded_snapshot_reader::next_chunk() {
+   EOS_ASSERT(next_chunk_buffer.valid(), snapshot_exception, "Binary snapshot section ${n} has fewer rows than expected", ("n", cur_section->name));
+   chunk_buffer = next_chunk_buffer.get();
+   ds = fc::datastream<const char*>(chunk_buffer.data(), chunk_buffer.size());
+
+   // decompress the following chunk while the rows of this one are ingested
+   if(++cur_chunk < cur_section->chunks.size())
+      next_chunk_buffer = decompress_chunk(cur_section->chunks[cur_chunk]);
+}
+
+std::future<std::vector<char>> threaded_snapshot_reader::decompress_chunk(const detail::snapshot_section_chunk& chunk) {
+   return post_async_task(decompress_thread_pool.get_executor(), [addr=mapped_snap_addr, chunk]() {
+      return decompress_snapshot_chunk(addr, chunk);
+   });
+}
+
 bool threaded_snapshot_reader::read_row(detail::abstract_snapshot_row_reader& row_reader) {
+   if(version == compressed_snapshot_version && ds.remaining() == 0)
+      next_chunk(); // chunks never split a row
    row_reader.provide(ds);
    return ++cur_row < num_rows;
 }
@@ -540,9 +741,17 @@ bool threaded_snapshot_reader::empty ( ) {
 }
 
 void threaded_snapshot_reader::clear_section() {
+   if(version == compressed_snapshot_version) {
+      if(next_chunk_buffer.valid())
+         next_chunk_buffer.wait();
+      next_chunk_buffer = {};
+      chunk_buffer = {};
+      cur_section = nullptr;
+      ds = fc::datastream<const char*>(nullptr, 0);
+   }
 #ifdef __linux__
    //this might work elsewhere, but unsure about alignment requirements on madvise() elsewhere
-   if(num_rows) {
+   else if(num_rows) {
       uintptr_t endp = (uintptr_t)ds.pos();
       ds.seekp(0);
       uintptr_t p = (uintptr_t)ds.pos();
@@ -562,6 +771,12 @@ size_t threaded_snapshot_reader::total_row_count() {
    using version_t = std::decay_t<decltype(current_snapshot_version)>;
 
    size_t total = 0;
+   if(version == compressed_snapshot_version) {
+      for(const auto& [name, section] : compressed_sections)
+         total += section.row_count;
+      return total;
+   }
+
    uint64_t next_section_offs = sizeof(magic_number_t) + sizeof(version_t);
    while(true) {
       const uint64_t this_section_size = snapshot_file.unpack_from<uint64_t>(next_section_offs);
@@ -593,6 +808,12 @@ void integrity_hash_snapshot_writer::write_end_section( ) {
    // no-op for structural details
 }
 
+void integrity_hash_snapshot_writer::write_buffered_part( const detail::snapshot_section_part& part ) {
+   constexpr size_t max_write_size = 1024*1024*1024;
+   for(size_t offset = 0; offset < part.data.size(); offset += max_write_size)
+      enc.write(part.data.data() + offset, std::min(part.data.size() - offset, max_write_size));
+}
+
 void integrity_hash_snapshot_writer::finalize() {
    // no-op for structural details
 }
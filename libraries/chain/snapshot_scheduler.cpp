@@ -120,6 +120,10 @@ void snapshot_scheduler::set_snapshots_path(fs::path sn_path) {
    _snapshots_dir = std::move(sn_path);
 }
 
+void snapshot_scheduler::set_compression(bool compress) {
+   _compress_snapshots = compress;
+}
+
 void snapshot_scheduler::add_pending_snapshot_info(const snapshot_information& si) {
    auto& snapshot_by_id = _snapshot_requests.get<by_snapshot_id>();
    auto snapshot_req = snapshot_by_id.find(_inflight_sid);
@@ -171,9 +175,15 @@ void snapshot_scheduler::create_snapshot(next_function<snapshot_information> nex
       if(predicate) predicate();
       fs::create_directory(p.parent_path());
       auto snap_out = std::ofstream(p.generic_string(), (std::ios::out | std::ios::binary));
-      auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
-      chain.write_snapshot(writer);
-      writer->finalize();
+      if(_compress_snapshots) {
+         auto writer = std::make_shared<ostream_compressed_snapshot_writer>(snap_out);
+         chain.write_snapshot(writer);
+         writer->finalize();
+      } else {
+         auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
+         chain.write_snapshot(writer);
+         writer->finalize();
+      }
       snap_out.flush();
       snap_out.close();
    };
@@ -0,0 +1,74 @@
+#include <eosio/chain/transaction_access_set.hpp>
+
+namespace eosio::chain {
+
+   bool transaction_access_set::intersects( const table_set& a, const table_set& b ) {
+      const table_set& smaller = a.size() <= b.size() ? a : b;
+      const table_set& larger  = a.size() <= b.size() ? b : a;
+      for( const auto& k : smaller ) {
+         if( larger.contains( k ) )
+            return true;
+      }
+      return false;
+   }
+
+   bool transaction_access_set::conflicts_with( const transaction_access_set& other ) const {
+      if( serial || other.serial )
+         return true;
+      // reads of the same table never conflict
+      if( intersects( writes, other.writes ) || intersects( writes, other.reads ) || intersects( reads, other.writes ) )
+         return true;
+      // RAM and CPU/NET usage is limit checked, so the order of changes to an account's usage matters
+      const auto& smaller = accounts.size() <= other.accounts.size() ? accounts : other.accounts;
+      const auto& larger  = accounts.size() <= other.accounts.size() ? other.accounts : accounts;
+      for( const auto& a : smaller ) {
+         if( larger.contains( a ) )
+            return true;
+      }
+      return false;
+   }
+
+   void transaction_access_set::merge( const transaction_access_set& other ) {
+      reads.insert( other.reads.begin(), other.reads.end() );
+      writes.insert( other.writes.begin(), other.writes.end() );
+      accounts.insert( other.accounts.begin(), other.accounts.end() );
+      serial |= other.serial;
+   }
+
+   void transaction_access_set::clear() {
+      reads.clear();
+      writes.clear();
+      accounts.clear();
+      serial = false;
+   }
+
+   std::vector<std::vector<size_t>> partition_conflict_free( std::span<const transaction_access_set* const> access_sets ) {
+      std::vector<std::vector<size_t>> batches;
+      std::vector<transaction_access_set> batch_access; // merged access set of each batch
+      size_t first_open = 0; // batches before the last serial transaction can not take later transactions
+
+      for( size_t i = 0; i < access_sets.size(); ++i ) {
+         const transaction_access_set* as = access_sets[i];
+         if( !as || as->is_serial() ) {
+            batches.push_back( {i} );
+            batch_access.emplace_back().mark_serial();
+            first_open = batches.size();
+            continue;
+         }
+
+         // the batch after the last one it conflicts with
+         size_t b = batches.size();
+         while( b > first_open && !batch_access[b-1].conflicts_with( *as ) )
+            --b;
+         if( b == batches.size() ) {
+            batches.emplace_back();
+            batch_access.emplace_back();
+         }
+         batches[b].push_back( i );
+         batch_access[b].merge( *as );
+      }
+
+      return batches;
+   }
+
+} // namespace eosio::chain
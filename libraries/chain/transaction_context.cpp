@@ -78,6 +78,9 @@ namespace eosio::chain {
       trace->block_time = control.pending_block_time();
       trace->producer_block_id = control.pending_producer_block_id();
       trace->net_usage = init_net_usage;
+      if (control.is_recording_trx_access_sets() && !is_read_only()) {
+         trace->access_set = std::make_shared<transaction_access_set>();
+      }
 
       if(auto dm_logger = control.get_deep_mind_logger(is_transient())) {
          dm_logger->on_start_transaction();
@@ -445,6 +448,11 @@ namespace eosio::chain {
 
       rl.add_transaction_usage( bill_to_accounts, static_cast<uint64_t>(billed_cpu_time_us), trace->net_usage,
                                 block_timestamp_type(control.pending_block_time()).slot, is_transient() ); // Should never fail
+      if (trace->access_set) {
+         for( const auto& a : bill_to_accounts ) {
+            trace->access_set->record_account( a );
+         }
+      }
    }
 
    void transaction_context::squash() {
@@ -660,6 +668,9 @@ namespace eosio::chain {
       if( ram_delta > 0 ) {
          validate_ram_usage.insert( account );
       }
+      if( trace->access_set ) {
+         trace->access_set->record_account( account );
+      }
    }
 
    uint32_t transaction_context::update_billed_cpu_time( fc::time_point now ) {
@@ -1,6 +1,7 @@
 #include <eosio/chain/transaction_metadata.hpp>
 #include <eosio/chain/thread_utils.hpp>
 #include <boost/asio/thread_pool.hpp>
+#include <algorithm>
 
 namespace eosio { namespace chain {
 
@@ -16,6 +17,47 @@ recover_keys_future transaction_metadata::start_recover_keys( packed_transaction
    });
 }
 
+std::vector<recover_keys_future> transaction_metadata::start_recover_keys( std::vector<packed_transaction_ptr> trxs,
+                                                                           boost::asio::io_context& thread_pool,
+                                                                           size_t num_tasks,
+                                                                           const chain_id_type& chain_id,
+                                                                           fc::microseconds time_limit,
+                                                                           trx_type t,
+                                                                           uint32_t max_variable_sig_size )
+{
+   struct chunk_entry {
+      packed_transaction_ptr                    trx;
+      std::promise<transaction_metadata_ptr>    promise;
+   };
+
+   std::vector<recover_keys_future> futures;
+   futures.reserve( trxs.size() );
+   if( trxs.empty() )
+      return futures;
+
+   num_tasks = std::clamp<size_t>( num_tasks, 1, trxs.size() );
+   const size_t chunk_size = (trxs.size() + num_tasks - 1) / num_tasks;
+   for( size_t begin = 0; begin < trxs.size(); begin += chunk_size ) {
+      const size_t end = std::min( begin + chunk_size, trxs.size() );
+      std::vector<chunk_entry> chunk;
+      chunk.reserve( end - begin );
+      for( size_t i = begin; i < end; ++i ) {
+         auto& e = chunk.emplace_back( chunk_entry{ .trx = std::move( trxs[i] ) } );
+         futures.emplace_back( e.promise.get_future() );
+      }
+      boost::asio::post( thread_pool, [chunk{std::move(chunk)}, chain_id, time_limit, t, max_variable_sig_size]() mutable {
+         for( auto& e : chunk ) {
+            try {
+               e.promise.set_value( recover_keys( std::move(e.trx), chain_id, time_limit, t, max_variable_sig_size ) );
+            } catch( ... ) {
+               e.promise.set_exception( std::current_exception() );
+            }
+         }
+      });
+   }
+   return futures;
+}
+
 transaction_metadata_ptr transaction_metadata::recover_keys( packed_transaction_ptr trx,
                                                               const chain_id_type& chain_id,
                                                               fc::microseconds time_limit,
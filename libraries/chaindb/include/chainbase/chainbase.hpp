@@ -543,6 +543,23 @@ namespace chainbase {
             return _db_file.check_memory_and_flush_if_needed();
          }
 
+         /**
+          * Persists the current state so it can be reopened after an unclean shutdown, see
+          * pinnable_mapped_file::checkpoint(). Must be called when the state is consistent
+          * (e.g. between blocks). Returns the number of pages written.
+          */
+         size_t checkpoint() {
+            return _db_file.checkpoint();
+         }
+
+         /**
+          * Returns the memory backing the free parts of the database to the OS, see
+          * pinnable_mapped_file::release_free_memory(). Returns the number of bytes released.
+          */
+         size_t release_free_memory() {
+            return _db_file.release_free_memory();
+         }
+
       private:
          pinnable_mapped_file                                        _db_file;
          bool                                                        _read_only = false;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <boost/interprocess/offset_ptr.hpp>
 
 #include <chainbase/pinnable_mapped_file.hpp>
@@ -47,11 +49,24 @@ namespace chainbase {
     private:
       template<typename T2, typename S2>
       friend class chainbase_node_allocator;
+      // Nodes are carved out of slabs which double in size every time the free list runs out, so that the nodes
+      // of a busy index end up packed together in large contiguous regions instead of being interleaved with those
+      // of every other index. Once a slab reaches the size of a 2MB huge page it is aligned on one, so a slab spans
+      // a single TLB entry in `heap` and `locked` modes.
       void get_some() {
          static_assert(sizeof(T) >= sizeof(list_item), "Too small for free list");
          static_assert(sizeof(T) % alignof(list_item) == 0, "Bad alignment for free list");
-         const unsigned allocation_batch_size = 64;
-         char* result = (char*)_manager->allocate(sizeof(T) * allocation_batch_size);
+         const size_t min_batch_size = 64;
+         const size_t max_batch_size = std::max(min_batch_size, max_slab_size / sizeof(T));
+         const size_t allocation_batch_size = std::min(min_batch_size << _slab_shift, max_batch_size);
+         char* result;
+         if (allocation_batch_size == max_batch_size && max_batch_size != min_batch_size) {
+            result = (char*)_manager->allocate_aligned(sizeof(T) * allocation_batch_size, max_slab_size);
+         } else {
+            result = (char*)_manager->allocate(sizeof(T) * allocation_batch_size);
+            if (allocation_batch_size < max_batch_size)
+               ++_slab_shift;
+         }
          _freelist_size += allocation_batch_size;
          _freelist = bip::offset_ptr<list_item>{(list_item*)result};
          for(unsigned i = 0; i < allocation_batch_size-1; ++i) {
@@ -62,9 +77,13 @@ namespace chainbase {
          new(result) list_item{nullptr};
       }
       struct list_item { bip::offset_ptr<list_item> _next; };
+      static constexpr size_t max_slab_size = 2*1024*1024;
       bip::offset_ptr<segment_manager> _manager;
       bip::offset_ptr<list_item> _freelist{};
-      size_t _freelist_size = 0;
+      // These two used to be a single `size_t _freelist_size`, the layout of existing databases is preserved on
+      // little endian platforms with `_slab_shift` reading as 0.
+      uint32_t _freelist_size = 0;
+      uint32_t _slab_shift = 0;
    };
 
 }  // namepsace chainbase
@@ -27,7 +27,8 @@ enum db_error_code {
    aborted,
    no_mlock,
    clear_refs_failed,
-   tempfs_incompatible_mode
+   tempfs_incompatible_mode,
+   checkpoint_failed
 };
 
 const std::error_category& chainbase_error_category();
@@ -53,7 +54,8 @@ class pinnable_mapped_file {
          mapped,        // file is mmaped in MAP_SHARED mode. Only mode where changes can be seen by another chainbase instance
          mapped_private,// file is mmaped in MAP_PRIVATE mode, and only updated at exit
          heap,          // file is copied at startup to an anonymous mapping using huge pages (if available)
-         locked         // file is copied at startup to an anonymous mapping using huge pages (if available) and locked in memory
+         locked,        // file is copied at startup to an anonymous mapping using huge pages (if available) and locked in memory
+         mapped_prefetch// as mapped_private, and pages resident at exit are recorded and read ahead at the next startup
       };
 
       pinnable_mapped_file(const std::filesystem::path& dir, bool writable, uint64_t shared_file_size, bool allow_dirty, map_mode mode);
@@ -66,6 +68,19 @@ class pinnable_mapped_file {
       segment_manager* get_segment_manager() const { return _segment_manager;}
       size_t           check_memory_and_flush_if_needed();
 
+      // Writes the pages modified since the previous checkpoint (or since open) to the database file so that, should
+      // the process terminate uncleanly, the file can be reopened in the state it had at this call instead of being
+      // flagged dirty. The pages are first written to a journal file, so a crash part way through is recovered on the
+      // next open. Only supported in `mapped_private` mode when Soft-Dirty pagemap tracking is available, in all other
+      // cases nothing is written. Returns the number of pages written.
+      size_t           checkpoint();
+
+      // Returns the memory backing unallocated parts of the segment to the OS: in `mapped` mode holes are punched in
+      // the database file, in `mapped_private` and `heap` modes the private pages are dropped. Objects on the free
+      // lists of chainbase_node_allocator are not part of the free memory. Does nothing in `locked` mode or when not
+      // writable. Returns the number of bytes released.
+      size_t           release_free_memory();
+
       template<typename T>
       static std::optional<allocator<T>> get_allocator(void *object) {
          if (!_segment_manager_map.empty()) {
@@ -91,18 +106,30 @@ class pinnable_mapped_file {
       void                                          setup_non_file_mapping();
       void                                          setup_copy_on_write_mapping();
       std::pair<std::byte*, size_t>                 get_region_to_save() const;
+      void                                          write_checkpoint_journal(const std::vector<size_t>& pages) const;
+      void                                          write_checkpoint_pages(int fd, const std::vector<size_t>& pages) const;
+      void                                          recover_checkpoint_journal();
+      void                                          set_file_header_dirty(bool dirty);
+      void                                          prefetch_hot_set();
+      void                                          save_hot_set();
 
       bip::file_lock                                _mapped_file_lock;
       std::filesystem::path                         _data_file_path;
+      std::filesystem::path                         _journal_file_path;
+      std::filesystem::path                         _hot_set_file_path;
       std::string                                   _database_name;
       size_t                                        _database_size = 0;
       bool                                          _writable = false;
       bool                                          _sharable = false;
+      bool                                          _checkpoint_on_disk = false; // file holds a clean checkpoint, header not dirty
 
       bip::file_mapping                             _file_mapping;
       bip::mapped_region                            _file_mapped_region;
       void*                                         _non_file_mapped_mapping = nullptr;
       size_t                                        _non_file_mapped_mapping_size = 0;
+      size_t                                        _non_file_mapped_page_size = 0;
+      bool                                          _locked = false;
+      bool                                          _record_hot_set = false;
 
 #ifdef _WIN32
       bip::permissions                              _db_permissions;
@@ -119,6 +146,7 @@ class pinnable_mapped_file {
 
       constexpr static unsigned                     _db_size_multiple_requirement = 1024*1024; //1MB
       constexpr static size_t                       _db_size_copy_increment       = 1024*1024*1024; //1GB
+      constexpr static size_t                       _db_size_parallel_copy_increment = 128*1024*1024; //128MB, per thread
 };
 
 std::istream& operator>>(std::istream& in, pinnable_mapped_file::map_mode& runtime);
@@ -6,8 +6,12 @@
 #include <fc/io/raw.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/reflect/variant.hpp>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <thread>
 //#include <unistd.h>
 
 #ifdef __linux__
@@ -62,6 +66,8 @@ std::string chainbase_error_category::message(int ev) const {
          return "Failed to clear Soft-Dirty bits";
       case tempfs_incompatible_mode:
          return "We recommend storing the state db file on tmpfs only when database-map-mode=mapped";
+      case checkpoint_failed:
+         return "Failed to write database checkpoint";
       default:
          return "Unrecognized error code";
    }
@@ -81,8 +87,49 @@ static bool on_tempfs_filesystem(std::filesystem::path& path) {
    return false;
 }
 
+// The checkpoint journal is laid out as
+//    [magic][page size][page count] { [file offset][page bytes] } * page count [magic][page count]
+// where the trailing magic and page count are only written (and synced) once all the pages are on disk.
+constexpr uint64_t checkpoint_journal_magic = 0x4c4e524a50434243; // "CBCPJRNL"
+
+static void write_all(int fd, const void* data, size_t sz) {
+   const char* p = (const char*)data;
+   while(sz) {
+      ssize_t ret = ::write(fd, p, sz);
+      if(ret < 0) {
+         if(errno == EINTR)
+            continue;
+         BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+      }
+      p += ret;
+      sz -= (size_t)ret;
+   }
+}
+
+static void pwrite_all(int fd, const void* data, size_t sz, size_t offset) {
+   const char* p = (const char*)data;
+   while(sz) {
+      ssize_t ret = ::pwrite(fd, p, sz, offset);
+      if(ret < 0) {
+         if(errno == EINTR)
+            continue;
+         BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+      }
+      p += ret;
+      offset += (size_t)ret;
+      sz -= (size_t)ret;
+   }
+}
+
+static void sync_fd(int fd) {
+   if(::fsync(fd))
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+}
+
 pinnable_mapped_file::pinnable_mapped_file(const std::filesystem::path& dir, bool writable, uint64_t shared_file_size, bool allow_dirty, map_mode mode) :
    _data_file_path(std::filesystem::absolute(dir/"shared_memory.bin")),
+   _journal_file_path(std::filesystem::absolute(dir/"shared_memory.journal")),
+   _hot_set_file_path(std::filesystem::absolute(dir/"shared_memory.hotset")),
    _database_name(dir.filename().string()),
    _database_size(shared_file_size),
    _writable(writable),
@@ -103,6 +150,9 @@ pinnable_mapped_file::pinnable_mapped_file(const std::filesystem::path& dir, boo
 
    std::filesystem::create_directories(dir);
 
+   if(_writable)
+      recover_checkpoint_journal();
+
    if(std::filesystem::exists(_data_file_path)) {
       char header[header_size];
       std::ifstream hs(_data_file_path.generic_string(), std::ifstream::binary);
@@ -184,7 +234,7 @@ pinnable_mapped_file::pinnable_mapped_file(const std::filesystem::path& dir, boo
       std::erase(_instance_tracker, this);
    });
 
-   if(mode == mapped || mode == mapped_private) {
+   if(mode == mapped || mode == mapped_private || mode == mapped_prefetch) {
       if (_writable && !_sharable) {
          // First make sure the db file is not on a ram-based tempfs, as it would be an
          // unnecessary waste of RAM to have both the db file *and* the modified pages in RAM.
@@ -202,6 +252,10 @@ pinnable_mapped_file::pinnable_mapped_file(const std::filesystem::path& dir, boo
       } else {
          _segment_manager = file_mapped_segment_manager;
       }
+      if (mode == mapped_prefetch) {
+         prefetch_hot_set();
+         _record_hot_set = _writable;
+      }
    }
    else {
       // First make sure the db file is not on a ram-based tempfs, as it would be an unnecessary
@@ -244,6 +298,7 @@ pinnable_mapped_file::pinnable_mapped_file(const std::filesystem::path& dir, boo
             std::string what_str("Failed to mlock database \"" + _database_name + "\". " + details);
             BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::no_mlock), what_str));
          }
+         _locked = true;
          ilog("Database \"${dbname}\" has been successfully locked in memory", ("dbname", _database_name));
       }
 #endif
@@ -311,6 +366,282 @@ size_t pinnable_mapped_file::check_memory_and_flush_if_needed() {
    return written_pages;
 }
 
+size_t pinnable_mapped_file::checkpoint() {
+   // only instances in `_instance_tracker` (writable, `mapped_private` mode, Soft-Dirty supported) know which pages
+   // changed since the last time the file was updated
+   if (std::find(_instance_tracker.begin(), _instance_tracker.end(), this) == _instance_tracker.end())
+      return 0;
+
+   auto [src, sz] = get_region_to_save();
+   const size_t pagesz = pagemap_accessor::page_size();
+
+   // the header page is always written last; it carries the clean flag which validates everything before it
+   std::vector<size_t> pages;
+   pagemap_accessor pagemap;
+   std::vector<uint64_t> pm;
+   for(size_t offset = 0; offset != sz; ) {
+      size_t copy_size = std::min(_db_size_copy_increment, sz - offset);
+      pm.resize(copy_size / pagesz);
+      if (!pagemap.read((uintptr_t)(src + offset), pm))
+         BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), "pagemap read failed"));
+      for (size_t i=0; i<pm.size(); ++i) {
+         if (pagemap_accessor::is_marked_dirty(pm[i]) && offset + i * pagesz != 0)
+            pages.push_back(offset + i * pagesz);
+      }
+      offset += copy_size;
+   }
+   pages.push_back(0);
+
+   write_checkpoint_journal(pages);
+
+   // the file stays flagged dirty while pages are being overwritten; should we crash, the journal restores them
+   set_file_header_dirty(true);
+
+   int fd = ::open(_data_file_path.generic_string().c_str(), O_WRONLY);
+   if (fd < 0)
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+   auto close_fd = scope_exit([&]() { ::close(fd); });
+
+   write_checkpoint_pages(fd, pages);
+   sync_fd(fd);
+   _checkpoint_on_disk = true;
+
+   std::filesystem::remove(_journal_file_path);
+
+   // Soft-Dirty bits are cleared for the whole process, so first bring other instances' files up to date, as is
+   // done when a new `mapped_private` instance is created
+   for (auto pmm : _instance_tracker) {
+      if (pmm != this)
+         pmm->save_database_file(true);
+   }
+   if (!pagemap.clear_refs())
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::clear_refs_failed)));
+
+   return pages.size();
+}
+
+void pinnable_mapped_file::write_checkpoint_journal(const std::vector<size_t>& pages) const {
+   const uint64_t pagesz = pagemap_accessor::page_size();
+   const uint64_t num_pages = pages.size();
+
+   int fd = ::open(_journal_file_path.generic_string().c_str(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH);
+   if (fd < 0)
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+   auto close_fd = scope_exit([&]() { ::close(fd); });
+
+   write_all(fd, &checkpoint_journal_magic, sizeof(checkpoint_journal_magic));
+   write_all(fd, &pagesz, sizeof(pagesz));
+   write_all(fd, &num_pages, sizeof(num_pages));
+
+   auto [src, sz] = get_region_to_save();
+   std::vector<std::byte> header_page(src, src + pagesz);
+   header_page[header_dirty_bit_offset] = std::byte{0};
+   for (uint64_t offset : pages) {
+      write_all(fd, &offset, sizeof(offset));
+      write_all(fd, offset ? src + offset : header_page.data(), pagesz);
+   }
+   sync_fd(fd);
+
+   // only now mark the journal complete
+   write_all(fd, &checkpoint_journal_magic, sizeof(checkpoint_journal_magic));
+   write_all(fd, &num_pages, sizeof(num_pages));
+   sync_fd(fd);
+
+   int dir_fd = ::open(_journal_file_path.parent_path().generic_string().c_str(), O_RDONLY);
+   if (dir_fd >= 0) {
+      ::fsync(dir_fd);
+      ::close(dir_fd);
+   }
+}
+
+void pinnable_mapped_file::write_checkpoint_pages(int fd, const std::vector<size_t>& pages) const {
+   const size_t pagesz = pagemap_accessor::page_size();
+   auto [src, sz] = get_region_to_save();
+   for (size_t i=0; i<pages.size(); ++i) {
+      size_t j = i + 1;
+      while (j<pages.size() && pages[j] == pages[j-1] + pagesz && pages[j] != 0)
+         ++j;
+      if (pages[i] == 0) {
+         std::vector<std::byte> header_page(src, src + pagesz);
+         header_page[header_dirty_bit_offset] = std::byte{0};
+         pwrite_all(fd, header_page.data(), pagesz, 0);
+      } else {
+         pwrite_all(fd, src + pages[i], pagesz * (j - i), pages[i]);
+      }
+      i = j - 1;
+   }
+}
+
+void pinnable_mapped_file::recover_checkpoint_journal() {
+   if (!std::filesystem::exists(_journal_file_path))
+      return;
+   auto remove_journal = scope_exit([&]() { std::filesystem::remove(_journal_file_path); });
+   if (!std::filesystem::exists(_data_file_path))
+      return;
+
+   bip::file_lock journal_lock(_data_file_path.generic_string().c_str());
+   if (!journal_lock.try_lock()) {
+      remove_journal.cancel();
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::no_access)));
+   }
+
+   std::ifstream js(_journal_file_path.generic_string(), std::ifstream::binary);
+   uint64_t magic = 0, pagesz = 0, num_pages = 0;
+   js.read((char*)&magic, sizeof(magic));
+   js.read((char*)&pagesz, sizeof(pagesz));
+   js.read((char*)&num_pages, sizeof(num_pages));
+   const uint64_t expected_size = 5 * sizeof(uint64_t) + num_pages * (sizeof(uint64_t) + pagesz);
+   if (js.fail() || magic != checkpoint_journal_magic || std::filesystem::file_size(_journal_file_path) != expected_size) {
+      // the journal was not completely written, the database file itself was not touched yet
+      wlog("\"${dbname}\" discarding incomplete checkpoint journal", ("dbname", _database_name));
+      return;
+   }
+   js.seekg(expected_size - 2 * sizeof(uint64_t));
+   uint64_t trailer_magic = 0, trailer_num_pages = 0;
+   js.read((char*)&trailer_magic, sizeof(trailer_magic));
+   js.read((char*)&trailer_num_pages, sizeof(trailer_num_pages));
+   if (js.fail() || trailer_magic != checkpoint_journal_magic || trailer_num_pages != num_pages) {
+      wlog("\"${dbname}\" discarding incomplete checkpoint journal", ("dbname", _database_name));
+      return;
+   }
+
+   ilog("\"${dbname}\" restoring ${n} pages from checkpoint journal", ("dbname", _database_name)("n", num_pages));
+   int fd = ::open(_data_file_path.generic_string().c_str(), O_WRONLY);
+   if (fd < 0)
+      BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), strerror(errno)));
+   auto close_fd = scope_exit([&]() { ::close(fd); });
+
+   js.seekg(3 * sizeof(uint64_t));
+   std::vector<char> page(pagesz);
+   for (uint64_t i=0; i<num_pages; ++i) {
+      uint64_t offset = 0;
+      js.read((char*)&offset, sizeof(offset));
+      js.read(page.data(), pagesz);
+      if (js.fail())
+         BOOST_THROW_EXCEPTION(std::system_error(make_error_code(db_error_code::checkpoint_failed), "checkpoint journal read failed"));
+      pwrite_all(fd, page.data(), pagesz, offset);
+   }
+   sync_fd(fd);
+}
+
+void pinnable_mapped_file::set_file_header_dirty(bool dirty) {
+   bip::mapped_region header_rgn(_file_mapping, bip::read_write, 0, _db_size_multiple_requirement);
+   *((char*)header_rgn.get_address()+header_dirty_bit_offset) = dirty;
+   if (header_rgn.flush(0, 0, false) == false)
+      wlog("syncing buffers failed");
+}
+
+// The hot set file holds [magic][page size][range count] { [first page][page count] } * range count
+constexpr uint64_t hot_set_magic = 0x5445535448424243; // "CBBHTSET"
+
+void pinnable_mapped_file::prefetch_hot_set() {
+#ifndef _WIN32
+   std::ifstream hs(_hot_set_file_path.generic_string(), std::ifstream::binary);
+   if (!hs)
+      return;
+   uint64_t magic = 0, pagesz = 0, num_ranges = 0;
+   hs.read((char*)&magic, sizeof(magic));
+   hs.read((char*)&pagesz, sizeof(pagesz));
+   hs.read((char*)&num_ranges, sizeof(num_ranges));
+   if (hs.fail() || magic != hot_set_magic || pagesz != pagemap_accessor::page_size()) {
+      wlog("\"${dbname}\" ignoring unrecognized hot set file", ("dbname", _database_name));
+      return;
+   }
+
+   // the kernel reads the ranges in asynchronously, so this does not delay startup
+   std::byte* const start = (std::byte*)_file_mapped_region.get_address();
+   const size_t num_pages = _file_mapped_region.get_size() / pagesz;
+   size_t prefetched_pages = 0;
+   for (uint64_t i=0; i<num_ranges; ++i) {
+      uint64_t first = 0, count = 0;
+      hs.read((char*)&first, sizeof(first));
+      hs.read((char*)&count, sizeof(count));
+      if (hs.fail() || first >= num_pages)
+         break;
+      count = std::min(count, num_pages - first);
+      madvise(start + first * pagesz, count * pagesz, MADV_WILLNEED);
+      prefetched_pages += count;
+   }
+   ilog("\"${dbname}\" prefetching ${mb} MiB hot set", ("dbname", _database_name)("mb", prefetched_pages * pagesz / (1024*1024)));
+#endif
+}
+
+void pinnable_mapped_file::save_hot_set() {
+#ifndef _WIN32
+   const uint64_t pagesz = pagemap_accessor::page_size();
+   const size_t num_pages = _file_mapped_region.get_size() / pagesz;
+   std::vector<unsigned char> resident(num_pages);
+   if (mincore(_file_mapped_region.get_address(), num_pages * pagesz, resident.data()) != 0) {
+      wlog("\"${dbname}\" unable to determine hot set: ${err}", ("dbname", _database_name)("err", strerror(errno)));
+      return;
+   }
+
+   std::vector<std::pair<uint64_t, uint64_t>> ranges;
+   for (size_t i=0; i<num_pages; ++i) {
+      if (resident[i] & 1) {
+         size_t j = i + 1;
+         while (j<num_pages && (resident[j] & 1))
+            ++j;
+         ranges.emplace_back(i, j - i);
+         i = j - 1;
+      }
+   }
+
+   std::ofstream hs(_hot_set_file_path.generic_string(), std::ofstream::binary | std::ofstream::trunc);
+   const uint64_t num_ranges = ranges.size();
+   hs.write((const char*)&hot_set_magic, sizeof(hot_set_magic));
+   hs.write((const char*)&pagesz, sizeof(pagesz));
+   hs.write((const char*)&num_ranges, sizeof(num_ranges));
+   for (const auto& [first, count] : ranges) {
+      hs.write((const char*)&first, sizeof(first));
+      hs.write((const char*)&count, sizeof(count));
+   }
+   if (hs.fail())
+      wlog("\"${dbname}\" failed to write hot set file", ("dbname", _database_name));
+#endif
+}
+
+size_t pinnable_mapped_file::release_free_memory() {
+   size_t released = 0;
+#ifndef _WIN32
+   if (!_writable || _locked)
+      return released;
+
+   // In `mapped` mode punch holes in the file, otherwise drop private pages (reverting them to the file's content in
+   // `mapped_private` mode, or to zero pages in `heap` mode).
+#ifdef MADV_REMOVE
+   const int advice = _sharable ? MADV_REMOVE : MADV_DONTNEED;
+#else
+   if (_sharable)
+      return released;
+   const int advice = MADV_DONTNEED;
+#endif
+   const size_t pagesz = _non_file_mapped_mapping ? _non_file_mapped_page_size : pagemap_accessor::page_size();
+
+   // Take ownership of every free block, largest first, so the allocator's bookkeeping at the start of each block
+   // is left untouched while the pages inside it are released.
+   std::vector<char*> blocks;
+   auto return_blocks = scope_exit([&]() {
+      for (char* b : blocks)
+         _segment_manager->deallocate(b);
+   });
+   for (;;) {
+      size_t received = _segment_manager->get_size();
+      char* reuse = nullptr;
+      char* p = _segment_manager->allocation_command<char>(bip::allocate_new | bip::nothrow_allocation, 2 * pagesz, received, reuse);
+      if (!p)
+         break;
+      blocks.push_back(p);
+
+      char* begin = (char*)(((uintptr_t)p + pagesz - 1) / pagesz * pagesz);
+      char* end   = (char*)(((uintptr_t)p + received) / pagesz * pagesz);
+      if (end > begin && madvise(begin, end - begin, advice) == 0)
+         released += end - begin;
+   }
+#endif
+   return released;
+}
+
 void pinnable_mapped_file::setup_non_file_mapping() {
    int common_map_opts = MAP_PRIVATE|MAP_ANONYMOUS;
 
@@ -326,6 +657,7 @@ void pinnable_mapped_file::setup_non_file_mapping() {
    _non_file_mapped_mapping = mmap(NULL, _non_file_mapped_mapping_size, PROT_READ|PROT_WRITE, common_map_opts|MAP_HUGETLB|MAP_HUGE_1GB, -1, 0);
    if(_non_file_mapped_mapping != MAP_FAILED) {
       round_up_mmaped_size(_1gb);
+      _non_file_mapped_page_size = _1gb;
       ilog("Database \"${dbname}\" using 1GB pages", ("dbname", _database_name));
       return;
    }
@@ -337,6 +669,7 @@ void pinnable_mapped_file::setup_non_file_mapping() {
    _non_file_mapped_mapping = mmap(NULL, _non_file_mapped_mapping_size, PROT_READ|PROT_WRITE, common_map_opts|MAP_HUGETLB|MAP_HUGE_2MB, -1, 0);
    if(_non_file_mapped_mapping != MAP_FAILED) {
       round_up_mmaped_size(_2mb);
+      _non_file_mapped_page_size = _2mb;
       ilog("Database \"${dbname}\" using 2MB pages", ("dbname", _database_name));
       return;
    }
@@ -346,6 +679,7 @@ void pinnable_mapped_file::setup_non_file_mapping() {
    round_up_mmaped_size(_2mb);
    _non_file_mapped_mapping = mmap(NULL, _non_file_mapped_mapping_size, PROT_READ|PROT_WRITE, common_map_opts, VM_FLAGS_SUPERPAGE_SIZE_2MB, 0);
    if(_non_file_mapped_mapping != MAP_FAILED) {
+      _non_file_mapped_page_size = _2mb;
       ilog("Database \"${dbname}\" using 2MB pages", ("dbname", _database_name));
       return;
    }
@@ -356,26 +690,97 @@ void pinnable_mapped_file::setup_non_file_mapping() {
    _non_file_mapped_mapping = mmap(NULL, _non_file_mapped_mapping_size, PROT_READ|PROT_WRITE, common_map_opts, -1, 0);
    if(_non_file_mapped_mapping == MAP_FAILED)
       BOOST_THROW_EXCEPTION(std::runtime_error(std::string("Failed to map database ") + _database_name + ": " + strerror(errno)));
+   _non_file_mapped_page_size = pagemap_accessor::page_size();
+#ifdef MADV_HUGEPAGE
+   // no huge pages could be reserved up front, let transparent huge pages back the mapping where possible
+   madvise(_non_file_mapped_mapping, _non_file_mapped_mapping_size, MADV_HUGEPAGE);
 #endif
+#endif
+}
+
+// Calls `process_chunk(offset, size)` for every `chunk_size` chunk of [0, sz) from a pool of threads which includes the
+// calling thread. `progress(bytes_done)` is called periodically on the calling thread, which may abort by throwing.
+static void parallel_for_each_chunk(size_t sz, size_t chunk_size, const std::function<void(size_t, size_t)>& process_chunk,
+                                    const std::function<void(size_t)>& progress) {
+   const size_t num_chunks  = (sz + chunk_size - 1) / chunk_size;
+   const size_t num_threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(num_chunks, 1));
+
+   std::atomic<size_t> next_chunk{0};
+   std::atomic<size_t> chunks_done{0};
+   std::atomic<size_t> bytes_done{0};
+   std::atomic<bool>   abort{false};
+   std::mutex          exception_mutex;
+   std::exception_ptr  worker_exception;
+
+   auto process_next_chunk = [&]() {
+      size_t c = next_chunk++;
+      if (abort || c >= num_chunks)
+         return false;
+      const size_t offset = c * chunk_size;
+      const size_t size   = std::min(chunk_size, sz - offset);
+      process_chunk(offset, size);
+      bytes_done += size;
+      ++chunks_done;
+      return true;
+   };
+
+   {
+      std::vector<std::thread> threads;
+      auto join_threads = scope_exit([&]() {
+         for (auto& t : threads)
+            t.join();
+      });
+      auto stop_threads = scope_fail([&]() { abort = true; });
+
+      for (size_t i = 1; i < num_threads; ++i) {
+         threads.emplace_back([&]() {
+            try {
+               while (process_next_chunk())
+                  ;
+            } catch (...) {
+               std::lock_guard g(exception_mutex);
+               if (!worker_exception)
+                  worker_exception = std::current_exception();
+               abort = true;
+            }
+         });
+      }
+
+      while (process_next_chunk())
+         progress(bytes_done);
+      while (!abort && chunks_done != num_chunks) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+         progress(bytes_done);
+      }
+   }
+
+   if (worker_exception)
+      std::rethrow_exception(worker_exception);
 }
 
 void pinnable_mapped_file::load_database_file(boost::asio::io_context& sig_ios) {
    ilog("Preloading \"${dbname}\" database file, this could take a moment...", ("dbname", _database_name));
    char* const dst = (char*)_non_file_mapped_mapping;
-   size_t offset = 0;
    time_t t = time(nullptr);
-   while(offset != _database_size) {
-      size_t copy_size = std::min(_db_size_copy_increment, _database_size - offset);
-      bip::mapped_region src_rgn(_file_mapping, bip::read_only, offset, copy_size);
-      memcpy(dst+offset, src_rgn.get_address(), copy_size);
-      offset += copy_size;
 
+   parallel_for_each_chunk(_database_size, _db_size_parallel_copy_increment, [&](size_t offset, size_t copy_size) {
+      bip::mapped_region src_rgn(_file_mapping, bip::read_only, offset, copy_size);
+      src_rgn.advise(bip::mapped_region::advice_sequential);
+      // pages of free memory which were released (or never touched) are zero, leave them unfaulted in the anonymous mapping
+      const std::byte* src = (const std::byte*)src_rgn.get_address();
+      const size_t pagesz = pagemap_accessor::page_size();
+      for(size_t page_offset = 0; page_offset < copy_size; page_offset += pagesz) {
+         const size_t sz = std::min(pagesz, copy_size - page_offset);
+         if(!all_zeros(src + page_offset, sz))
+            memcpy(dst + offset + page_offset, src + page_offset, sz);
+      }
+   }, [&](size_t bytes_done) {
       if(time(nullptr) != t) {
          t = time(nullptr);
-         ilog("Preloading \"${dbname}\" database file, ${pct}% complete...", ("dbname", _database_name)("pct", offset/(_database_size/100)));
+         ilog("Preloading \"${dbname}\" database file, ${pct}% complete...", ("dbname", _database_name)("pct", bytes_done/(_database_size/100)));
       }
       sig_ios.poll();
-   }
+   });
    ilog("Preloading \"${dbname}\" database file, complete.", ("dbname", _database_name));
 }
 
@@ -397,16 +802,19 @@ std::pair<std::byte*, size_t> pinnable_mapped_file::get_region_to_save() const {
 
 void pinnable_mapped_file::save_database_file(bool flush /* = true */) {
    assert(_writable);
+   if (_checkpoint_on_disk) {
+      // the file is about to be modified outside of a checkpoint, it is no longer consistent until we are done
+      set_file_header_dirty(true);
+      _checkpoint_on_disk = false;
+   }
    ilog("Writing \"${dbname}\" database file, this could take a moment...", ("dbname", _database_name));
-   size_t offset = 0;
    time_t t = time(nullptr);
-   pagemap_accessor pagemap;
-   size_t written_pages {0};
    auto [src, sz] = get_region_to_save();
-   
-   while(offset != sz) {
-      size_t copy_size = std::min(_db_size_copy_increment,  sz - offset);
-      bool mapped_writable_instance = std::find(_instance_tracker.begin(), _instance_tracker.end(), this) != _instance_tracker.end();
+   const bool mapped_writable_instance = std::find(_instance_tracker.begin(), _instance_tracker.end(), this) != _instance_tracker.end();
+
+   parallel_for_each_chunk(sz, _db_size_parallel_copy_increment, [&, src=src](size_t offset, size_t copy_size) {
+      pagemap_accessor pagemap;
+      size_t written_pages {0};
       if (!mapped_writable_instance ||
           !pagemap.update_file_from_region({ src + offset, copy_size }, _file_mapping, offset, flush, written_pages)) {
          if (mapped_writable_instance)
@@ -422,13 +830,12 @@ void pinnable_mapped_file::save_database_file(bool flush /* = true */) {
             }
          }
       }
-      offset += copy_size;
-
+   }, [&, sz=sz](size_t bytes_done) {
       if(time(nullptr) != t) {
          t = time(nullptr);
-         ilog("Writing \"${dbname}\" database file, ${pct}% complete...", ("dbname", _database_name)("pct", offset/(sz/100)));
+         ilog("Writing \"${dbname}\" database file, ${pct}% complete...", ("dbname", _database_name)("pct", bytes_done/(sz/100)));
       }
-   }
+   });
    ilog("Writing \"${dbname}\" database file, complete.", ("dbname", _database_name));
 }
 
@@ -441,14 +848,20 @@ pinnable_mapped_file::pinnable_mapped_file(pinnable_mapped_file&& o) noexcept
 pinnable_mapped_file& pinnable_mapped_file::operator=(pinnable_mapped_file&& o) noexcept {
    std::swap(_mapped_file_lock, o._mapped_file_lock);
    std::swap(_data_file_path, o._data_file_path);
+   std::swap(_journal_file_path, o._journal_file_path);
    std::swap(_database_name, o._database_name);
    std::swap(_database_size, o._database_size);
    std::swap(_writable, o._writable);
    std::swap(_sharable, o._sharable);
+   std::swap(_checkpoint_on_disk, o._checkpoint_on_disk);
    std::swap(_file_mapping, o._file_mapping);
    std::swap(_file_mapped_region, o._file_mapped_region);
    std::swap(_non_file_mapped_mapping, o._non_file_mapped_mapping);
    std::swap(_non_file_mapped_mapping_size, o._non_file_mapped_mapping_size);
+   std::swap(_non_file_mapped_page_size, o._non_file_mapped_page_size);
+   std::swap(_locked, o._locked);
+   std::swap(_record_hot_set, o._record_hot_set);
+   std::swap(_hot_set_file_path, o._hot_set_file_path);
    std::swap(_db_permissions, o._db_permissions);
    std::swap(_segment_manager, o._segment_manager);
    return *this;
@@ -467,6 +880,8 @@ pinnable_mapped_file::~pinnable_mapped_file() {
             if(_file_mapped_region.flush(0, 0, false) == false)
                wlog("syncing buffers failed");
          } else {
+            if (_record_hot_set)
+               save_hot_set();
             save_database_file(); // must be before `this` is removed from _instance_tracker
             if (auto it = std::find(_instance_tracker.begin(), _instance_tracker.end(), this); it != _instance_tracker.end())
                _instance_tracker.erase(it);
@@ -500,6 +915,8 @@ std::istream& operator>>(std::istream& in, pinnable_mapped_file::map_mode& runti
       runtime = pinnable_mapped_file::map_mode::heap;
    else if (s == "locked")
       runtime = pinnable_mapped_file::map_mode::locked;
+   else if (s == "mapped_prefetch")
+      runtime = pinnable_mapped_file::map_mode::mapped_prefetch;
    else
       in.setstate(std::ios_base::failbit);
    return in;
@@ -514,6 +931,8 @@ std::ostream& operator<<(std::ostream& osm, pinnable_mapped_file::map_mode m) {
       osm << "heap";
    else if (m == pinnable_mapped_file::map_mode::locked)
       osm << "locked";
+   else if (m == pinnable_mapped_file::map_mode::mapped_prefetch)
+      osm << "mapped_prefetch";
 
    return osm;
 }
@@ -9,6 +9,11 @@
 #include <iostream>
 #include "temp_directory.hpp"
 
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace chainbase;
 using namespace boost::multi_index;
 
@@ -659,6 +664,124 @@ BOOST_AUTO_TEST_CASE( shared_string_object ) {
 }
 
 
+BOOST_AUTO_TEST_CASE( node_allocator_slabs ) {
+   temp_directory temp_dir;
+   const auto& temp = temp_dir.path();
+
+   chainbase::database db(temp, database::read_write, 1024*1024*64);
+   struct node_t { char data[64]; };
+   chainbase::chainbase_node_allocator<node_t, segment_manager> alloc(db.get_segment_manager());
+
+   // slabs double in size as the free list runs out
+   for(size_t slab = 64; slab <= 1024; slab *= 2) {
+      auto first = alloc.allocate(1);
+      BOOST_REQUIRE_EQUAL( alloc.freelist_memory_usage(), (slab - 1) * sizeof(node_t) );
+      for(size_t i = 1; i < slab; ++i) {
+         auto p = alloc.allocate(1);
+         BOOST_REQUIRE_EQUAL( &*p - &*first, (std::ptrdiff_t)i ); // contiguous within a slab
+      }
+   }
+
+   // until they reach the size of a huge page, on which they are aligned
+   const size_t max_slab = 2*1024*1024 / sizeof(node_t);
+   for(size_t slab = 2048; slab < max_slab; slab *= 2) {
+      for(size_t i = 0; i < slab; ++i)
+         alloc.allocate(1);
+   }
+   BOOST_REQUIRE_EQUAL( alloc.freelist_memory_usage(), 0u );
+   auto p = alloc.allocate(1);
+   BOOST_REQUIRE_EQUAL( alloc.freelist_memory_usage(), (max_slab - 1) * sizeof(node_t) );
+   BOOST_REQUIRE_EQUAL( (uintptr_t)&*p % (2*1024*1024), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( node_allocator_large_nodes ) {
+   temp_directory temp_dir;
+   const auto& temp = temp_dir.path();
+
+   chainbase::database db(temp, database::read_write, 1024*1024*64);
+   struct node_t { char data[64*1024]; };
+   chainbase::chainbase_node_allocator<node_t, segment_manager> alloc(db.get_segment_manager());
+
+   // nodes this large never get more than the minimum batch per slab, and the slab size stops growing
+   for(size_t slab = 0; slab < 4; ++slab) {
+      alloc.allocate(1);
+      BOOST_REQUIRE_EQUAL( alloc.freelist_memory_usage(), 63 * sizeof(node_t) );
+      for(size_t i = 1; i < 64; ++i)
+         alloc.allocate(1);
+   }
+}
+
+BOOST_AUTO_TEST_CASE( release_free_memory ) {
+   for(auto mode : { pinnable_mapped_file::map_mode::mapped, pinnable_mapped_file::map_mode::mapped_private, pinnable_mapped_file::map_mode::heap }) {
+      temp_directory temp_dir;
+      const auto& temp = temp_dir.path();
+
+      {
+         chainbase::database db(temp, database::read_write, 1024*1024*32, false, mode);
+         db.add_index< titled_book_index >();
+
+         std::vector<titled_book::id_type> ids;
+         for(int i = 0; i < 1000; ++i) {
+            ids.push_back(db.create<titled_book>( [&]( titled_book& b) {
+               b.title = std::to_string(i) + std::string(8192, 'x');
+            } ).id);
+         }
+         for(size_t i = 0; i < ids.size(); i += 2)
+            db.remove(db.get(ids[i]));
+
+         BOOST_REQUIRE_GT( db.release_free_memory(), 0u );
+
+         // remaining objects are intact and released memory can be allocated again
+         for(size_t i = 1; i < ids.size(); i += 2)
+            BOOST_REQUIRE( db.get(ids[i]).title == std::to_string(i) + std::string(8192, 'x') );
+         for(int i = 0; i < 500; ++i) {
+            db.create<titled_book>( [&]( titled_book& b) {
+               b.title = std::to_string(1000 + i) + std::string(8192, 'y');
+            } );
+         }
+      }
+      {
+         chainbase::database db(temp, database::read_write, 0, false, mode);
+         db.add_index< titled_book_index >();
+         BOOST_REQUIRE_EQUAL( db.get_index<titled_book_index>().indices().size(), 1000u );
+         BOOST_REQUIRE( db.get(titled_book::id_type(999)).title == std::to_string(999) + std::string(8192, 'x') );
+      }
+   }
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE( mapped_prefetch_hot_set ) {
+   temp_directory temp_dir;
+   const auto& temp = temp_dir.path();
+   const auto hot_set_file = temp / "shared_memory.hotset";
+
+   {
+      chainbase::database db(temp, database::read_write, 1024*1024*8, false, pinnable_mapped_file::map_mode::mapped_prefetch);
+      db.add_index< book_index >();
+      for(int i = 0; i < 1000; ++i)
+         db.create<book>( [&]( book& b) { b.a = i; b.b = i+1; } );
+   }
+   // pages touched above were resident at exit and recorded
+   BOOST_REQUIRE( std::filesystem::exists(hot_set_file) );
+   BOOST_REQUIRE_GT( std::filesystem::file_size(hot_set_file), 3*sizeof(uint64_t) );
+
+   {
+      chainbase::database db(temp, database::read_write, 0, false, pinnable_mapped_file::map_mode::mapped_prefetch);
+      db.add_index< book_index >();
+      BOOST_REQUIRE_EQUAL( db.get_index<book_index>().indices().size(), 1000u );
+      BOOST_REQUIRE_EQUAL( db.get(book::id_type(999)).b, 1000 );
+   }
+
+   // a corrupt hot set file is ignored
+   std::ofstream(hot_set_file, std::ofstream::trunc) << "garbage";
+   {
+      chainbase::database db(temp, database::read_write, 0, false, pinnable_mapped_file::map_mode::mapped_prefetch);
+      db.add_index< book_index >();
+      BOOST_REQUIRE_EQUAL( db.get_index<book_index>().indices().size(), 1000u );
+   }
+}
+#endif
+
 // behavior of these tests are dependent on linux's overcommit behavior, they are also dependent on the system not having
 // enough memory+swap to balk at 6TB request
 #if defined(__linux__)
@@ -696,6 +819,53 @@ BOOST_AUTO_TEST_CASE( mapped_big_boy_extra ) {
    chainbase::database(temp, database::read_write, 0, false);
 }
 
+// simulates a crash after a checkpoint by terminating a child process without running any destructors
+BOOST_AUTO_TEST_CASE( checkpoint_survives_crash ) {
+   temp_directory temp_dir;
+   const auto& temp = temp_dir.path();
+
+   {
+      chainbase::database db(temp, database::read_write, 1024*1024*8);
+      db.add_index< book_index >();
+   }
+
+   pid_t pid = fork();
+   BOOST_REQUIRE(pid >= 0);
+   if(pid == 0) {
+      size_t checkpointed_pages = 0;
+      {
+         chainbase::database db(temp, database::read_write, 0, false, pinnable_mapped_file::map_mode::mapped_private);
+         db.add_index< book_index >();
+         const auto& new_book = db.create<book>( []( book& b ) {
+            b.a = 3;
+            b.b = 4;
+         } );
+         checkpointed_pages = db.checkpoint();
+         db.modify( new_book, [&]( book& b ) {
+            b.a = 5;
+            b.b = 6;
+         });
+         _exit(checkpointed_pages ? 0 : 1);
+      }
+   }
+   int status = 0;
+   BOOST_REQUIRE(waitpid(pid, &status, 0) == pid);
+   BOOST_REQUIRE(WIFEXITED(status));
+
+   if(WEXITSTATUS(status) != 0) {
+      // Soft-Dirty pagemap not supported, nothing was checkpointed and the database is left dirty
+      BOOST_REQUIRE_THROW(chainbase::database(temp, database::read_write, 0, false), std::system_error);
+      return;
+   }
+
+   chainbase::database db(temp, database::read_write, 0, false);
+   db.add_index< book_index >();
+   const auto& recovered_book = db.get( book::id_type(0) );
+   BOOST_REQUIRE_EQUAL( recovered_book.a, 3 );
+   BOOST_REQUIRE_EQUAL( recovered_book.b, 4 );
+   BOOST_REQUIRE( !std::filesystem::exists(temp / "shared_memory.journal") );
+}
+
 #endif
 
 // BOOST_AUTO_TEST_SUITE_END()
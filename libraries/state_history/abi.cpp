@@ -65,6 +65,46 @@ extern const char* const state_history_plugin_abi = R"({
                 { "name": "fetch_finality_data", "type": "bool" }
             ]
         },
+        {
+            "name": "get_blocks_request_v2", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_finality_data", "type": "bool" }
+            ]
+        },
+        {
+            "name": "action_filter", "fields": [
+                { "name": "account", "type": "name" },
+                { "name": "action", "type": "name" }
+            ]
+        },
+        {
+            "name": "table_filter", "fields": [
+                { "name": "code", "type": "name" },
+                { "name": "table", "type": "name" }
+            ]
+        },
+        {
+            "name": "get_blocks_request_v3", "fields": [
+                { "name": "start_block_num", "type": "uint32" },
+                { "name": "end_block_num", "type": "uint32" },
+                { "name": "max_messages_in_flight", "type": "uint32" },
+                { "name": "have_positions", "type": "block_position[]" },
+                { "name": "irreversible_only", "type": "bool" },
+                { "name": "fetch_block", "type": "bool" },
+                { "name": "fetch_traces", "type": "bool" },
+                { "name": "fetch_deltas", "type": "bool" },
+                { "name": "fetch_finality_data", "type": "bool" },
+                { "name": "action_filters", "type": "action_filter[]" },
+                { "name": "table_filters", "type": "table_filter[]" }
+            ]
+        },
         {
             "name": "get_blocks_ack_request_v0", "fields": [
                 { "name": "num_messages", "type": "uint32" }
@@ -93,6 +133,25 @@ extern const char* const state_history_plugin_abi = R"({
                 { "name": "finality_data", "type": "bytes?" }
             ]
         },
+        {
+            "name": "stored_log_entry", "fields": [
+                { "name": "codec", "type": "uint8" },
+                { "name": "uncompressed_size", "type": "uint64" },
+                { "name": "data", "type": "bytes" }
+            ]
+        },
+        {
+            "name": "get_blocks_result_v2", "fields": [
+                { "name": "head", "type": "block_position" },
+                { "name": "last_irreversible", "type": "block_position" },
+                { "name": "this_block", "type": "block_position?" },
+                { "name": "prev_block", "type": "block_position?" },
+                { "name": "block", "type": "bytes?" },
+                { "name": "traces", "type": "stored_log_entry?" },
+                { "name": "deltas", "type": "stored_log_entry?" },
+                { "name": "finality_data", "type": "stored_log_entry?" }
+            ]
+        },
         {
             "name": "row", "fields": [
                 { "name": "present", "type": "bool" },
@@ -681,8 +740,8 @@ extern const char* const state_history_plugin_abi = R"({
         { "new_type_name": "transaction_id", "type": "checksum256" }
     ],
     "variants": [
-        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0", "get_blocks_request_v1", "get_status_request_v1"] },
-        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0", "get_blocks_result_v1", "get_status_result_v1"] },
+        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0", "get_blocks_request_v1", "get_status_request_v1", "get_blocks_request_v2", "get_blocks_request_v3"] },
+        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0", "get_blocks_result_v1", "get_status_result_v1", "get_blocks_result_v2"] },
 
         { "name": "action_receipt", "types": ["action_receipt_v0"] },
         { "name": "action_trace", "types": ["action_trace_v0", "action_trace_v1"] },
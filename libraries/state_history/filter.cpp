@@ -0,0 +1,198 @@
+#include <eosio/state_history/filter.hpp>
+
+namespace eosio {
+namespace state_history {
+
+namespace {
+
+using in_stream = fc::datastream<const char*>;
+
+template <typename T>
+T read(in_stream& ds) {
+   T v;
+   fc::raw::unpack(ds, v);
+   return v;
+}
+
+void skip(in_stream& ds, size_t size) {
+   EOS_ASSERT(size <= ds.remaining(), chain::plugin_exception, "state history log entry is truncated");
+   ds.skip(size);
+}
+
+void skip_bytes(in_stream& ds) {
+   skip(ds, read<fc::unsigned_int>(ds).value);
+}
+
+void skip_optional(in_stream& ds, size_t size) {
+   if (read<bool>(ds))
+      skip(ds, size);
+}
+
+void skip_vector(in_stream& ds, size_t element_size) {
+   skip(ds, size_t(read<fc::unsigned_int>(ds).value) * element_size);
+}
+
+void append(std::vector<char>& out, const char* begin, const char* end) {
+   out.insert(out.end(), begin, end);
+}
+
+void append_varuint(std::vector<char>& out, uint32_t v) {
+   char  buf[5];
+   fc::datastream<char*> ds(buf, sizeof(buf));
+   fc::raw::pack(ds, fc::unsigned_int(v));
+   append(out, buf, buf + ds.tellp());
+}
+
+bool action_matches(const std::vector<action_filter>& filters, chain::name receiver, chain::name account, chain::name action) {
+   return std::any_of(filters.begin(), filters.end(), [&](const action_filter& f) {
+      return (f.account == account || f.account == receiver) && (f.action.empty() || f.action == action);
+   });
+}
+
+// action_trace_v1; returns whether it matches the filters
+bool walk_action_trace(in_stream& ds, const std::vector<action_filter>& filters) {
+   read<fc::unsigned_int>(ds);                       // variant index
+   read<fc::unsigned_int>(ds);                       // action_ordinal
+   read<fc::unsigned_int>(ds);                       // creator_action_ordinal
+   if (read<bool>(ds)) {                             // receipt
+      skip(ds, 1 + sizeof(uint64_t) + sizeof(chain::digest_type) + 2 * sizeof(uint64_t));
+      skip_vector(ds, 2 * sizeof(uint64_t));         // auth_sequence
+      read<fc::unsigned_int>(ds);                    // code_sequence
+      read<fc::unsigned_int>(ds);                    // abi_sequence
+   }
+   const chain::name receiver{read<uint64_t>(ds)};
+   const chain::name account{read<uint64_t>(ds)};
+   const chain::name action{read<uint64_t>(ds)};
+   skip_vector(ds, 2 * sizeof(uint64_t));            // authorization
+   skip_bytes(ds);                                   // data
+   skip(ds, sizeof(bool) + sizeof(int64_t));         // context_free, elapsed
+   skip_bytes(ds);                                   // console
+   skip_vector(ds, sizeof(uint64_t) + sizeof(int64_t)); // account_ram_deltas
+   if (read<bool>(ds))                               // except
+      skip_bytes(ds);
+   skip_optional(ds, sizeof(uint64_t));              // error_code
+   skip_bytes(ds);                                   // return_value
+   return action_matches(filters, receiver, account, action);
+}
+
+// transaction_trace_v0; returns whether any of its action traces, or those of its failed deferred trace, match the filters
+bool walk_transaction_trace(in_stream& ds, const std::vector<action_filter>& filters) {
+   read<fc::unsigned_int>(ds);                       // variant index
+   skip(ds, sizeof(chain::transaction_id_type) + sizeof(uint8_t) + sizeof(uint32_t));
+   read<fc::unsigned_int>(ds);                       // net_usage_words
+   skip(ds, sizeof(int64_t) + sizeof(uint64_t) + sizeof(bool));
+
+   bool matched = false;
+   const uint32_t num_actions = read<fc::unsigned_int>(ds).value;
+   for (uint32_t i = 0; i < num_actions; ++i)
+      matched |= walk_action_trace(ds, filters);
+
+   skip_optional(ds, sizeof(uint64_t) + sizeof(int64_t)); // account_ram_delta
+   if (read<bool>(ds))                               // except
+      skip_bytes(ds);
+   skip_optional(ds, sizeof(uint64_t));              // error_code
+   if (read<bool>(ds))                               // failed_dtrx_trace
+      matched |= walk_transaction_trace(ds, filters);
+   if (read<bool>(ds)) {                             // partial
+      read<fc::unsigned_int>(ds);                    // variant index
+      skip(ds, sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t));
+      read<fc::unsigned_int>(ds);                    // max_net_usage_words
+      skip(ds, sizeof(uint8_t));
+      read<fc::unsigned_int>(ds);                    // delay_sec
+      read<chain::extensions_type>(ds);
+      read<std::vector<signature_type>>(ds);
+      const uint32_t num_cfd = read<fc::unsigned_int>(ds).value;
+      for (uint32_t i = 0; i < num_cfd; ++i)
+         skip_bytes(ds);
+   }
+   return matched;
+}
+
+} // namespace
+
+std::vector<char> filter_traces(const char* data, size_t size, const std::vector<action_filter>& filters) {
+   if (filters.empty())
+      return {data, data + size};
+
+   in_stream ds(data, size);
+   const uint32_t num_traces = read<fc::unsigned_int>(ds).value;
+   uint32_t kept = 0;
+   std::vector<char> traces;
+   for (uint32_t i = 0; i < num_traces; ++i) {
+      const char* begin = ds.pos();
+      if (walk_transaction_trace(ds, filters)) {
+         append(traces, begin, ds.pos());
+         ++kept;
+      }
+   }
+
+   std::vector<char> result;
+   result.reserve(traces.size() + 5);
+   append_varuint(result, kept);
+   append(result, traces.data(), traces.data() + traces.size());
+   return result;
+}
+
+std::vector<char> filter_deltas(const char* data, size_t size, const std::vector<table_filter>& filters) {
+   if (filters.empty())
+      return {data, data + size};
+
+   auto row_matches = [&](const char* row, size_t row_size, bool secondary_index) {
+      // contract_table, contract_row and contract_index* rows all start with variant index, code, scope, table
+      in_stream rs(row, row_size);
+      read<fc::unsigned_int>(rs);
+      const chain::name code{read<uint64_t>(rs)};
+      read<uint64_t>(rs);
+      uint64_t table = read<uint64_t>(rs);
+      // secondary indexes live in tables named after their primary table with the index number in the low 4 bits
+      if (secondary_index)
+         table &= ~uint64_t(0xf);
+      return std::any_of(filters.begin(), filters.end(), [&](const table_filter& f) {
+         return f.code == code && (f.table.empty() || f.table.to_uint64_t() == table);
+      });
+   };
+
+   in_stream ds(data, size);
+   const uint32_t num_tables = read<fc::unsigned_int>(ds).value;
+   uint32_t kept_tables = 0;
+   std::vector<char> tables;
+   for (uint32_t i = 0; i < num_tables; ++i) {
+      const char* header_begin = ds.pos();
+      read<fc::unsigned_int>(ds);                    // struct_version
+      const std::string name = read<std::string>(ds);
+      const char* header_end = ds.pos();
+      const bool contract_table = name.starts_with("contract_");
+      const bool secondary_index = name.starts_with("contract_index");
+
+      const uint32_t num_rows = read<fc::unsigned_int>(ds).value;
+      uint32_t kept_rows = 0;
+      std::vector<char> rows;
+      for (uint32_t r = 0; r < num_rows; ++r) {
+         const char* row_begin = ds.pos();
+         read<bool>(ds);                             // present
+         const uint32_t row_size = read<fc::unsigned_int>(ds).value;
+         const char* row_data = ds.pos();
+         skip(ds, row_size);
+         if (contract_table && row_matches(row_data, row_size, secondary_index)) {
+            append(rows, row_begin, ds.pos());
+            ++kept_rows;
+         }
+      }
+
+      if (kept_rows) {
+         append(tables, header_begin, header_end);
+         append_varuint(tables, kept_rows);
+         append(tables, rows.data(), rows.data() + rows.size());
+         ++kept_tables;
+      }
+   }
+
+   std::vector<char> result;
+   result.reserve(tables.size() + 5);
+   append_varuint(result, kept_tables);
+   append(result, tables.data(), tables.data() + tables.size());
+   return result;
+}
+
+} // namespace state_history
+} // namespace eosio
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <eosio/state_history/types.hpp>
+
+namespace eosio {
+namespace state_history {
+
+// Filters operate on decompressed trace and chain state log entries without deserializing them into chain types.
+// The output is in the same format as the input, so clients decode filtered entries exactly as unfiltered ones.
+
+// returns the transaction traces of a trace log entry which have at least one action trace matching one of the filters
+std::vector<char> filter_traces(const char* data, size_t size, const std::vector<action_filter>& filters);
+
+// returns the table deltas of a chain state log entry, keeping only contract table rows matching one of the filters;
+// rows of secondary indexes match the filters of their primary table
+std::vector<char> filter_deltas(const char* data, size_t size, const std::vector<table_filter>& filters);
+
+} // namespace state_history
+} // namespace eosio
@@ -38,6 +38,9 @@ namespace bio = boost::iostreams;
  *    state_history_log_header
  *    payload
  *
+ * The payload is a zlib stream unless the entry's magic has the raw payload feature set, in which case the
+ *  payload is stored as-is. Raw and zlib entries may be freely mixed within a log.
+ *
  * When block pruning is enabled, a slight modification to the format is as followed:
  * For first entry in log, a unique version is used to indicate the log is a "pruned log": this prevents
  *  older versions from trying to read something with holes in it
@@ -61,6 +64,8 @@ static const uint16_t ship_current_version = 0;
 static const uint16_t ship_feature_pruned_log = 1;
 inline bool           is_ship_log_pruned(uint64_t magic) { return get_ship_features(magic) & ship_feature_pruned_log; }
 inline uint64_t       clear_ship_log_pruned_feature(uint64_t magic) { return ship_magic(get_ship_version(magic), get_ship_features(magic) & ~ship_feature_pruned_log); }
+static const uint16_t ship_feature_raw_payload = 2;
+inline bool           is_ship_payload_raw(uint64_t magic) { return get_ship_features(magic) & ship_feature_raw_payload; }
 
 struct log_header {
    uint64_t             magic        = ship_magic(ship_current_version);
@@ -75,20 +80,29 @@ struct log_header_with_sizes : log_header {
 struct ship_log_entry {
    uint64_t get_uncompressed_size() {
       if(!uncompressed_size) {
-         bio::filtering_istreambuf buf(bio::zlib_decompressor() | bio::restrict(device, compressed_data_offset, compressed_data_size));
+         bio::filtering_istreambuf buf = get_stream();
          uncompressed_size = bio::copy(buf, bio::null_sink());
       }
       return *uncompressed_size;
    }
 
    bio::filtering_istreambuf get_stream() {
+      if(raw_payload)
+         return get_stored_stream();
       return bio::filtering_istreambuf(bio::zlib_decompressor() | bio::restrict(device, compressed_data_offset, compressed_data_size));
    }
 
+   //the payload as stored in the log: a zlib stream, or the uncompressed payload when raw_payload is set
+   bio::filtering_istreambuf get_stored_stream() {
+      return bio::filtering_istreambuf(bio::restrict(device, compressed_data_offset, compressed_data_size));
+   }
+
    fc::random_access_file::device device;
    uint64_t                       compressed_data_offset;
    uint64_t                       compressed_data_size;
    std::optional<uint64_t>        uncompressed_size;
+   bool                           raw_payload = false;
+   chain::block_id_type           block_id;
 };
 
 class state_history_log {
@@ -101,6 +115,7 @@ public:
 private:
    std::optional<state_history::prune_config> prune_config;
    non_local_get_block_id_func                non_local_get_block_id;
+   ship_log_codec                             codec = ship_log_codec::zlib;
 
    fc::random_access_file       log;
    fc::random_access_file       index;
@@ -120,8 +135,9 @@ private:
 
    state_history_log(const std::filesystem::path& log_dir_and_stem,
                      non_local_get_block_id_func non_local_get_block_id = no_non_local_get_block_id_func,
-                     const std::optional<state_history::prune_config>& prune_conf = std::nullopt) :
-     prune_config(prune_conf), non_local_get_block_id(non_local_get_block_id),
+                     const std::optional<state_history::prune_config>& prune_conf = std::nullopt,
+                     ship_log_codec codec = ship_log_codec::zlib) :
+     prune_config(prune_conf), non_local_get_block_id(non_local_get_block_id), codec(codec),
      log(std::filesystem::path(log_dir_and_stem).replace_extension("log")),
      index(std::filesystem::path(log_dir_and_stem).replace_extension("index")) {
       EOS_ASSERT(!!non_local_get_block_id, chain::plugin_exception, "misuse of get_block_id");
@@ -146,7 +162,7 @@ private:
             prune();
 
             //update first header to indicate prune feature is enabled
-            first_header.magic = ship_magic(get_ship_version(first_header.magic), ship_feature_pruned_log);
+            first_header.magic = ship_magic(get_ship_version(first_header.magic), get_ship_features(first_header.magic) | ship_feature_pruned_log);
             log.pack_to(first_header, 0);
 
             //write trailer on log with num blocks
@@ -208,13 +224,15 @@ private:
          .device                 = log.seekable_device(),
          .compressed_data_offset = log_pos + packed_header_size + (header.compressed_size == 1 ? l4_head_size : prel4_head_size),
          .compressed_data_size   = header.payload_size          - (header.compressed_size == 1 ? l4_head_size : prel4_head_size),
-         .uncompressed_size      =                                (header.compressed_size == 1 ? std::optional<uint64_t>(header.uncompressed_size) : std::nullopt)
+         .uncompressed_size      =                                (header.compressed_size == 1 ? std::optional<uint64_t>(header.uncompressed_size) : std::nullopt),
+         .raw_payload            = is_ship_payload_raw(header.magic),
+         .block_id               = header.block_id
       };
    }
 
    template <typename F>
    void pack_and_write_entry(const chain::block_id_type& id, const chain::block_id_type& prev_id, F&& pack_to) {
-      log_header_with_sizes header = {{ship_magic(ship_current_version, 0), id}, 1};
+      log_header_with_sizes header = {{ship_magic(ship_current_version, codec == ship_log_codec::raw ? ship_feature_raw_payload : 0), id}, 1};
       const uint32_t block_num = chain::block_header::num_from_id(header.block_id);
 
       if(!empty())
@@ -242,16 +260,25 @@ private:
          if(!empty())  //overwrite the prune trailer that is at the end of the log
             log_insert_pos -= sizeof(uint32_t);
          else          //we're operating on a pruned block log and this is the first entry in the log, make note of the feature in the header
-            header.magic = ship_magic(get_ship_version(header.magic), ship_feature_pruned_log);
+            header.magic = ship_magic(get_ship_version(header.magic), get_ship_features(header.magic) | ship_feature_pruned_log);
       }
 
       const ssize_t payload_insert_pos = log_insert_pos + packed_header_with_sizes_size;
 
-      bio::filtering_ostreambuf buf(detail::counter() | bio::zlib_compressor(bio::zlib::no_compression) | detail::counter() | bio::restrict(log.seekable_device(), payload_insert_pos));
-      pack_to(buf);
-      bio::close(buf);
-      header.uncompressed_size = buf.component<detail::counter>(0)->characters();
-      header.payload_size = buf.component<detail::counter>(2)->characters() + sizeof(header.compressed_size) + sizeof(header.uncompressed_size);
+      if(codec == ship_log_codec::raw) {
+         bio::filtering_ostreambuf buf(detail::counter() | bio::restrict(log.seekable_device(), payload_insert_pos));
+         pack_to(buf);
+         bio::close(buf);
+         header.uncompressed_size = buf.component<detail::counter>(0)->characters();
+         header.payload_size = header.uncompressed_size + sizeof(header.compressed_size) + sizeof(header.uncompressed_size);
+      }
+      else {
+         bio::filtering_ostreambuf buf(detail::counter() | bio::zlib_compressor(bio::zlib::no_compression) | detail::counter() | bio::restrict(log.seekable_device(), payload_insert_pos));
+         pack_to(buf);
+         bio::close(buf);
+         header.uncompressed_size = buf.component<detail::counter>(0)->characters();
+         header.payload_size = buf.component<detail::counter>(2)->characters() + sizeof(header.compressed_size) + sizeof(header.uncompressed_size);
+      }
       log.pack_to(header, log_insert_pos);
 
       fc::random_access_file::write_datastream appender = log.append_ds();
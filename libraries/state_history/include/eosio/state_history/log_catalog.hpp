@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <mutex>
 #include <regex>
 
 #include <boost/multi_index_container.hpp>
@@ -43,6 +44,7 @@ class log_catalog {
    uint32_t              log_rotation_stride = std::numeric_limits<decltype(log_rotation_stride)>::max();
 
    const state_history_log::non_local_get_block_id_func non_local_get_block_id;
+   const ship_log_codec                                 codec;
 
    struct by_mru {};
    typedef multi_index_container<
@@ -58,13 +60,18 @@ class log_catalog {
 
    size_t global_used_counter = 0;
 
+   //the catalog may be written from a dedicated write thread while being read from the main thread. recursive since
+   // writing an entry may consult the catalog's (or a sibling catalog's) block ids via non_local_get_block_id
+   mutable std::recursive_mutex mtx;
+
 public:
    log_catalog(const log_catalog&) = delete;
    log_catalog& operator=(log_catalog&) = delete;
 
    log_catalog(const std::filesystem::path& log_dir, const state_history::state_history_log_config& config, const std::string& log_name,
-               state_history_log::non_local_get_block_id_func non_local_get_block_id = state_history_log::no_non_local_get_block_id_func) :
-     non_local_get_block_id(non_local_get_block_id), head_log_path_and_basename(log_dir / log_name) {
+               state_history_log::non_local_get_block_id_func non_local_get_block_id = state_history_log::no_non_local_get_block_id_func,
+               ship_log_codec codec = ship_log_codec::zlib) :
+     non_local_get_block_id(non_local_get_block_id), codec(codec), head_log_path_and_basename(log_dir / log_name) {
       std::visit(chain::overloaded {
          [this](const std::monostate&) {
             open_head_log();
@@ -83,6 +90,7 @@ public:
 
    template <typename F>
    void pack_and_write_entry(const chain::block_id_type& id, const chain::block_id_type& prev_id, F&& pack_to) {
+      std::lock_guard g(mtx);
       const uint32_t block_num = chain::block_header::num_from_id(id);
 
       if(!retained_log_files.empty()) {
@@ -121,18 +129,21 @@ public:
    }
 
    std::optional<ship_log_entry> get_entry(uint32_t block_num) {
+      std::lock_guard g(mtx);
       return call_for_log(block_num, [&](state_history_log&& l) {
          return l.get_entry(block_num);
       });
    }
 
    std::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
+      std::lock_guard g(mtx);
       return call_for_log(block_num, [&](state_history_log&& l) {
          return l.get_block_id(block_num);
       });
    }
 
    std::pair<uint32_t, uint32_t> block_range() const {
+      std::lock_guard g(mtx);
       uint32_t begin = 0;
       uint32_t end = 0;
 
@@ -155,6 +166,7 @@ public:
    }
 
    void clear() {
+      std::lock_guard g(mtx);
       if(empty())
          return;
 
@@ -277,7 +289,7 @@ private:
    }
 
    void open_head_log(std::optional<state_history::prune_config> prune_config = std::nullopt) {
-      head_log.emplace(head_log_path_and_basename, non_local_get_block_id, prune_config);
+      head_log.emplace(head_log_path_and_basename, non_local_get_block_id, prune_config, codec);
    }
 
    void delete_head_log() {
@@ -21,6 +21,12 @@ struct partition_config {
    uint32_t              max_retained_files = UINT32_MAX;
 };
 
+//how the payload of newly written log entries is encoded. entries of either encoding may be mixed within a log
+enum class ship_log_codec {
+   zlib,  //zlib stream (stored blocks); readable by all versions
+   raw    //payload stored as-is, flagged with ship_feature_raw_payload; skips deflate framing and checksumming on write and read
+};
+
 using state_history_log_config = std::variant<std::monostate, prune_config, partition_config>;
 
 std::ostream& boost_test_print_type(std::ostream& os, const state_history_log_config& conf) {
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <eosio/state_history/log.hpp>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace eosio::state_history {
+
+/*
+ * Bounded LRU cache of decompressed log entries shared by all sessions, so that an entry streamed to many clients
+ * following head is only decompressed once. Entries are keyed by the block id recorded in the entry, so the entry of
+ * a block that was forked out is never served for its replacement. Cached contents are reference counted and stay
+ * valid for sessions still sending them after they have been evicted.
+ */
+class log_entry_cache {
+public:
+   enum class log_type : uint8_t {
+      trace,
+      chain_state,
+      finality_data
+   };
+   using contents_ptr = std::shared_ptr<const std::vector<char>>;
+
+   explicit log_entry_cache(size_t max_bytes = 0) : max_bytes(max_bytes) {}
+
+   log_entry_cache(const log_entry_cache&) = delete;
+   log_entry_cache& operator=(const log_entry_cache&) = delete;
+
+   //largest entry that will be cached; one block's entry should not flush out everything else
+   uint64_t max_entry_size() const { return max_bytes / 4; }
+
+   //returns the decompressed contents of entry, decompressing it only if not already cached
+   contents_ptr get(log_type type, ship_log_entry& entry) {
+      const key_type key{type, entry.block_id};
+      {
+         std::lock_guard g(mtx);
+         if(auto it = entries.find(key); it != entries.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+         }
+      }
+
+      auto contents = std::make_shared<std::vector<char>>();
+      contents->reserve(entry.get_uncompressed_size());
+      bio::filtering_istreambuf decompression_stream = entry.get_stream();
+      bio::copy(decompression_stream, bio::back_inserter(*contents));
+
+      std::lock_guard g(mtx);
+      if(auto it = entries.find(key); it != entries.end()) //another session decompressed it meanwhile
+         return it->second->second;
+      lru.emplace_front(key, contents);
+      entries.emplace(key, lru.begin());
+      cached_bytes += contents->size();
+      while(cached_bytes > max_bytes) {
+         cached_bytes -= lru.back().second->size();
+         entries.erase(lru.back().first);
+         lru.pop_back();
+      }
+      return contents;
+   }
+
+   size_t size_in_bytes() const {
+      std::lock_guard g(mtx);
+      return cached_bytes;
+   }
+
+private:
+   using key_type = std::pair<log_type, chain::block_id_type>;
+   using lru_list = std::list<std::pair<key_type, contents_ptr>>;
+
+   const size_t                                    max_bytes;
+   mutable std::mutex                              mtx;
+   lru_list                                        lru; //most recently used first
+   std::map<key_type, lru_list::iterator>          entries;
+   size_t                                          cached_bytes = 0;
+};
+
+}
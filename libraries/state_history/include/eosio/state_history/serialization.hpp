@@ -722,6 +722,25 @@ datastream<ST>& operator<<(datastream<ST>& ds, const eosio::state_history::get_b
    return ds;
 }
 
+template <typename ST>
+datastream<ST>& operator<<(datastream<ST>& ds, const eosio::state_history::stored_log_entry& obj) {
+   fc::raw::pack(ds, obj.codec);
+   fc::raw::pack(ds, obj.uncompressed_size);
+   history_pack_big_bytes(ds, obj.data);
+   return ds;
+}
+
+template <typename ST>
+datastream<ST>& operator<<(datastream<ST>& ds, const eosio::state_history::get_blocks_result_v2& obj) {
+   ds << static_cast<const eosio::state_history::get_blocks_result_base&>(obj);
+   for(const std::optional<eosio::state_history::stored_log_entry>* entry : {&obj.traces, &obj.deltas, &obj.finality_data}) {
+      fc::raw::pack(ds, entry->has_value());
+      if(*entry)
+         ds << **entry;
+   }
+   return ds;
+}
+
 template <typename ST>
 datastream<ST>& operator<<(datastream<ST>& ds, const eosio::state_history::get_blocks_result_base& obj) {
    fc::raw::pack(ds, obj.head);
@@ -115,6 +115,25 @@ struct get_blocks_request_v1 : get_blocks_request_v0 {
    bool                        fetch_finality_data    = false;
 };
 
+// log entries are sent as stored in the state history logs instead of decompressed; results are get_blocks_result_v2
+struct get_blocks_request_v2 : get_blocks_request_v1 {};
+
+struct action_filter {
+   chain::name                 account = {};   // matches actions of this contract and notifications received by this account
+   chain::name                 action  = {};   // empty matches any action
+};
+
+struct table_filter {
+   chain::name                 code    = {};
+   chain::name                 table   = {};   // empty matches any table of code
+};
+
+// traces and deltas are filtered by the server before being sent; results are get_blocks_result_v1
+struct get_blocks_request_v3 : get_blocks_request_v1 {
+   std::vector<action_filter>  action_filters = {};   // when not empty, only transaction traces with a matching action trace are sent
+   std::vector<table_filter>   table_filters  = {};   // when not empty, only contract table rows matching a filter are sent
+};
+
 struct get_blocks_ack_request_v0 {
    uint32_t num_messages = 0;
 };
@@ -136,11 +155,26 @@ struct get_blocks_result_v1 : get_blocks_result_v0 {
    std::optional<bytes>          finality_data;
 };
 
+struct stored_log_entry {
+   static constexpr uint8_t      zlib_codec = 0;    // data is a zlib stream
+   static constexpr uint8_t      raw_codec  = 1;    // data is not compressed
+
+   uint8_t                       codec             = zlib_codec;
+   uint64_t                      uncompressed_size = 0;             // 0 when unknown
+   bytes                         data;
+};
+
+struct get_blocks_result_v2 : get_blocks_result_base {
+   std::optional<stored_log_entry> traces;
+   std::optional<stored_log_entry> deltas;
+   std::optional<stored_log_entry> finality_data;
+};
+
 // remember to add new request & result messages to end so binary numbering remains fixed for clients that don't consume the given current ABI
-using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_status_request_v1>;
-using state_result  = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1, get_status_result_v1>;
-using get_blocks_request = std::variant<get_blocks_request_v0, get_blocks_request_v1>;
-using get_blocks_result = std::variant<get_blocks_result_v0, get_blocks_result_v1>;
+using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_status_request_v1, get_blocks_request_v2, get_blocks_request_v3>;
+using state_result  = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1, get_status_result_v1, get_blocks_result_v2>;
+using get_blocks_request = std::variant<get_blocks_request_v0, get_blocks_request_v1, get_blocks_request_v2, get_blocks_request_v3>;
+using get_blocks_result = std::variant<get_blocks_result_v0, get_blocks_result_v1, get_blocks_result_v2>;
 
 } // namespace state_history
 } // namespace eosio
@@ -154,8 +188,14 @@ FC_REFLECT(eosio::state_history::get_status_result_v0, (head)(last_irreversible)
 FC_REFLECT_DERIVED(eosio::state_history::get_status_result_v1, (eosio::state_history::get_status_result_v0), (finality_data_begin_block)(finality_data_end_block));
 FC_REFLECT(eosio::state_history::get_blocks_request_v0, (start_block_num)(end_block_num)(max_messages_in_flight)(have_positions)(irreversible_only)(fetch_block)(fetch_traces)(fetch_deltas));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v1, (eosio::state_history::get_blocks_request_v0), (fetch_finality_data));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v2, (eosio::state_history::get_blocks_request_v1), );
+FC_REFLECT(eosio::state_history::action_filter, (account)(action));
+FC_REFLECT(eosio::state_history::table_filter, (code)(table));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v3, (eosio::state_history::get_blocks_request_v1), (action_filters)(table_filters));
 FC_REFLECT(eosio::state_history::get_blocks_ack_request_v0, (num_messages));
 FC_REFLECT(eosio::state_history::get_blocks_result_base, (head)(last_irreversible)(this_block)(prev_block)(block));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_result_v0, (eosio::state_history::get_blocks_result_base), (traces)(deltas));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_result_v1, (eosio::state_history::get_blocks_result_v0), (finality_data));
+FC_REFLECT(eosio::state_history::stored_log_entry, (codec)(uncompressed_size)(data));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_result_v2, (eosio::state_history::get_blocks_result_base), (traces)(deltas)(finality_data));
 // clang-format on
@@ -12,6 +12,7 @@
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/subjective_billing.hpp>
+#include <eosio/chain/signature_recovery_cache.hpp>
 #include <eosio/chain/deep_mind.hpp>
 #include <eosio/chain_plugin/trx_finality_status_processing.hpp>
 #include <eosio/chain/permission_link_object.hpp>
@@ -277,6 +278,10 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "the location of the blocks archive directory (absolute path or relative to blocks dir).\n"
           "If the value is empty, blocks files beyond the retained limit will be deleted.\n"
           "All files in the archive directory are completely under user's control, i.e. they won't be accessed by nodeos anymore.")
+         ("blocks-log-compression", bpo::bool_switch()->default_value(false),
+          "store each block compressed on its own in the block log, random access by block number is kept.\n"
+          "An existing block log must first be converted with `spring-util block-log compress`.\n"
+          "Cannot be used with block-log-retain-blocks or the partitioned block log options.")
          ("state-dir", bpo::value<std::filesystem::path>()->default_value(config::default_state_dir_name),
           "the location of the state directory (absolute path or relative to application data dir)")
          ("finalizers-dir", bpo::value<std::filesystem::path>()->default_value(config::default_finalizers_dir_name),
@@ -334,22 +339,34 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "In \"light\" mode all incoming blocks headers will be fully validated; transactions in those validated blocks will be trusted \n")
          ("disable-ram-billing-notify-checks", bpo::bool_switch()->default_value(false),
           "Disable the check which subjectively fails a transaction if a contract bills more RAM to another account within the context of a notification handler (i.e. when the receiver is not the code of the action).")
+         ("record-transaction-access-sets", bpo::bool_switch()->default_value(false),
+          "Experimental: record the contract tables each transaction reads and writes, and report how many conflict-free batches the transactions of applied and replayed blocks could execute in. Only used for this report; transactions are still applied sequentially.")
 #ifdef EOSIO_DEVELOPER
          ("disable-all-subjective-mitigations", bpo::bool_switch()->default_value(false),
           "Disable all subjective mitigations checks in the entire codebase.")
 #endif
          ("maximum-variable-signature-length", bpo::value<uint32_t>()->default_value(16384u),
           "Subjectively limit the maximum length of variable components in a variable legnth signature to this size in bytes")
+         ("signature-recovery-cache-size", bpo::value<uint32_t>()->default_value(signature_recovery_cache::default_max_size),
+          "Number of public keys recovered from transaction signatures to cache, so a transaction received from a peer and again in a block is only recovered once. 0 disables the cache.")
          ("trusted-producer", bpo::value<vector<string>>()->composing(), "Indicate a producer whose blocks headers signed by it will be fully validated, but transactions in those validated blocks will be trusted.")
          ("database-map-mode", bpo::value<chainbase::pinnable_mapped_file::map_mode>()->default_value(chainbase::pinnable_mapped_file::map_mode::mapped),
-          "Database map mode (\"mapped\", \"mapped_private\", \"heap\", or \"locked\").\n"
+          "Database map mode (\"mapped\", \"mapped_private\", \"mapped_prefetch\", \"heap\", or \"locked\").\n"
           "In \"mapped\" mode database is memory mapped as a file.\n"
           "In \"mapped_private\" mode database is memory mapped as a file using a private mapping (no disk writeback until program exit).\n"
 #ifndef _WIN32
+          "In \"mapped_prefetch\" mode database is mapped as in \"mapped_private\" mode, and the pages resident at exit are read ahead at the next startup.\n"
           "In \"heap\" mode database is preloaded in to swappable memory and will use huge pages if available.\n"
           "In \"locked\" mode database is preloaded, locked in to memory, and will use huge pages if available.\n"
 #endif
          )
+         ("database-checkpoint-interval-sec", bpo::value<uint32_t>()->default_value(0),
+          "Interval (in seconds) at which pages of the state database modified since the previous checkpoint are written to disk "
+          "after irreversible blocks are committed, allowing restart from the last irreversible block without replay after an unclean shutdown. "
+          "Only supported with database-map-mode = \"mapped_private\" or \"mapped_prefetch\" on Linux kernels with Soft-Dirty page tracking. 0 disables checkpoints.")
+         ("database-release-free-memory-interval-sec", bpo::value<uint32_t>()->default_value(0),
+          "Interval (in seconds) at which the memory backing free space of the state database is returned to the OS. "
+          "In \"mapped\" mode this punches holes in the database file. Not supported in \"locked\" mode. 0 disables it.")
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
          ("eos-vm-oc-cache-size-mb", bpo::value<uint64_t>()->default_value(eosvmoc::config().cache_size / (1024u*1024u)), "Maximum size (in MiB) of the EOS VM OC code cache")
@@ -683,12 +700,14 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
       chain_config->disable_replay_opts = options.at( "disable-replay-opts" ).as<bool>();
       chain_config->contracts_console = options.at( "contracts-console" ).as<bool>();
       chain_config->allow_ram_billing_in_notify = options.at( "disable-ram-billing-notify-checks" ).as<bool>();
+      chain_config->record_trx_access_sets = options.at( "record-transaction-access-sets" ).as<bool>();
 
 #ifdef EOSIO_DEVELOPER
       chain_config->disable_all_subjective_mitigations = options.at( "disable-all-subjective-mitigations" ).as<bool>();
 #endif
 
       chain_config->maximum_variable_signature_length = options.at( "maximum-variable-signature-length" ).as<uint32_t>();
+      signature_recovery_cache::instance().set_max_size( options.at( "signature-recovery-cache-size" ).as<uint32_t>() );
 
       chain_config->terminate_at_block = options.at( "terminate-at-block" ).as<uint32_t>();
       chain_config->truncate_at_block = options.at( "truncate-at-block" ).as<uint32_t>();
@@ -704,6 +723,9 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
 
       EOS_ASSERT(!has_partitioned_block_log_options || !has_retain_blocks_option, plugin_config_exception,
          "block-log-retain-blocks cannot be specified together with blocks-retained-dir, blocks-archive-dir or blocks-log-stride or max-retained-block-files.");
+      bool has_compression_option = options.at("blocks-log-compression").as<bool>();
+      EOS_ASSERT(!has_compression_option || (!has_partitioned_block_log_options && !has_retain_blocks_option), plugin_config_exception,
+         "blocks-log-compression cannot be specified together with block-log-retain-blocks, blocks-retained-dir, blocks-archive-dir, blocks-log-stride or max-retained-block-files.");
 
       std::filesystem::path retained_dir;
       if (has_partitioned_block_log_options) {
@@ -732,6 +754,8 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
                        "punching");
             chain_config->blog = eosio::chain::prune_blocklog_config{ .prune_blocks = block_log_retain_blocks };
          }
+      } else if(has_compression_option) {
+         chain_config->blog = eosio::chain::compressed_blocklog_config{};
       }
 
       
@@ -804,11 +828,9 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
 
          // recover genesis information from the snapshot
          // used for validation code below
-         auto infile = std::ifstream(snapshot_path->generic_string(), (std::ios::in | std::ios::binary));
-         istream_snapshot_reader reader(infile);
+         threaded_snapshot_reader reader(*snapshot_path);
          reader.validate();
          chain_id = controller::extract_chain_id(reader);
-         infile.close();
 
          EOS_ASSERT( options.count( "genesis-timestamp" ) == 0,
                  plugin_config_exception,
@@ -964,6 +986,8 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
       }
 
       chain_config->db_map_mode = options.at("database-map-mode").as<pinnable_mapped_file::map_mode>();
+      chain_config->state_checkpoint_interval_sec = options.at("database-checkpoint-interval-sec").as<uint32_t>();
+      chain_config->state_release_free_memory_interval_sec = options.at("database-release-free-memory-interval-sec").as<uint32_t>();
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
       if( options.count("eos-vm-oc-cache-size-mb") )
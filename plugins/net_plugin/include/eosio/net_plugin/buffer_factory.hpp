@@ -1,8 +1,10 @@
 #pragma once
 
 #include <eosio/net_plugin/protocol.hpp>
+#include <eosio/net_plugin/message_compression.hpp>
 #include <eosio/net_plugin/gossip_bps_index.hpp>
 #include <eosio/net_plugin/net_logger.hpp>
+#include <eosio/chain/block_log.hpp>
 #include <fc/io/raw.hpp>
 
 #include <memory>
@@ -24,8 +26,32 @@ namespace eosio {
 
    protected:
       send_buffer_type send_buffer;
+      send_buffer_type compressed_send_buffer;
 
    protected:
+      /// @return compressed_message send buffer of the packed net_message parts, nullptr if it would not be smaller
+      static send_buffer_type create_compressed_send_buffer( compression_codec codec,
+                                                             std::initializer_list<std::span<const char>> parts ) {
+         size_t size = 0;
+         for( const auto& part : parts )
+            size += part.size();
+         if( size < min_compressed_message_size )
+            return {};
+
+         compressed_message cm{ .codec = static_cast<uint8_t>(codec), .data = compress_message( codec, parts ) };
+         auto compressed = create_send_buffer( to_index(msg_type_t::compressed_message), cm );
+         if( compressed->size() >= message_header_size + size )
+            return {};
+         return compressed;
+      }
+
+      /// @return compressed_message send buffer of uncompressed, or uncompressed if compressing would not make it smaller
+      static send_buffer_type create_compressed_send_buffer( compression_codec codec, const send_buffer_type& uncompressed ) {
+         auto compressed = create_compressed_send_buffer( codec,
+            { std::span<const char>( uncompressed->data() + message_header_size, uncompressed->size() - message_header_size ) } );
+         return compressed ? compressed : uncompressed;
+      }
+
       static send_buffer_type create_send_buffer( const net_message& m ) {
          const uint32_t payload_size = fc::raw::pack_size( m );
 
@@ -77,6 +103,25 @@ namespace eosio {
          return send_buffer;
       }
 
+      /// message header of a serialized signed block whose bytes are sent separately, directly from a block_view
+      static send_buffer_type create_send_buffer_header_for_serialized_block( size_t block_size ) {
+         constexpr uint32_t signed_block_which = to_index(msg_type_t::signed_block);
+
+         // match net_message static_variant pack
+         const uint32_t which_size = fc::raw::pack_size( unsigned_int( signed_block_which ) );
+         const uint32_t payload_size = which_size + block_size;
+
+         const char* const header = reinterpret_cast<const char* const>(&payload_size); // avoid variable size encoding of uint32_t
+         const size_t buffer_size = message_header_size + which_size;
+
+         auto send_buffer = std::make_shared<vector<char>>( buffer_size );
+         fc::datastream<char*> ds( send_buffer->data(), buffer_size );
+         ds.write( header, message_header_size );
+         fc::raw::pack( ds, unsigned_int( signed_block_which ) );
+
+         return send_buffer;
+      }
+
    };
 
    struct block_buffer_factory : public buffer_factory {
@@ -89,9 +134,36 @@ namespace eosio {
          return send_buffer;
       }
 
-      const send_buffer_type& get_send_buffer( const std::vector<char>& sb ) {
+      /// caches result for subsequent calls, only provide same signed_block_ptr instance and codec for each invocation.
+      /// The block is compressed once for all peers accepting codec, uncompressed if that would not make it smaller.
+      const send_buffer_type& get_send_buffer( const signed_block_ptr& sb, compression_codec codec ) {
+         if( codec == compression_codec::none )
+            return get_send_buffer( sb );
+         if( !compressed_send_buffer ) {
+            compressed_send_buffer = buffer_factory::create_compressed_send_buffer( codec, get_send_buffer( sb ) );
+         }
+         return compressed_send_buffer;
+      }
+
+      /// caches result for subsequent calls, only provide same block_view and codec for each invocation.
+      /// @return the complete compressed_message of the block, nullptr if compression would not make it smaller
+      const send_buffer_type& get_compressed_send_buffer( const block_view& sb, compression_codec codec ) {
+         if( !compressed_send_buffer ) {
+            constexpr uint32_t signed_block_which = to_index(msg_type_t::signed_block);
+            std::array<char, 5> which_buffer; // max size of unsigned_int
+            fc::datastream<char*> ds( which_buffer.data(), which_buffer.size() );
+            fc::raw::pack( ds, unsigned_int( signed_block_which ) );
+            compressed_send_buffer = buffer_factory::create_compressed_send_buffer( codec,
+               { std::span<const char>( which_buffer.data(), ds.tellp() ), sb.packed } );
+         }
+         return compressed_send_buffer;
+      }
+
+      /// caches result for subsequent calls, only provide same block_view for each invocation.
+      /// Only the message header is buffered, the block is sent from the block_view.
+      const send_buffer_type& get_send_buffer_header( const block_view& sb ) {
          if( !send_buffer ) {
-            send_buffer = create_send_buffer( sb );
+            send_buffer = buffer_factory::create_send_buffer_header_for_serialized_block( sb.size() );
          }
          return send_buffer;
       }
@@ -104,11 +176,36 @@ namespace eosio {
          fc_dlog( p2p_blk_log, "sending block ${bn}", ("bn", sb->block_num()) );
          return buffer_factory::create_send_buffer_from_serialized_block(sb->packed_signed_block());
       }
+   };
 
-      static send_buffer_type create_send_buffer( const std::vector<char>& ssb ) { // ssb: serialized signed block
-         // this implementation is to avoid copy of signed_block to net_message
-         // matches which of net_message for signed_block
-         return buffer_factory::create_send_buffer_from_serialized_block( ssb );
+   struct compact_block_buffer_factory : public buffer_factory {
+
+      /// caches result for subsequent calls, only provide same signed_block_ptr instance for each invocation.
+      const send_buffer_type& get_send_buffer( const signed_block_ptr& sb ) {
+         if( !send_buffer ) {
+            send_buffer = create_send_buffer( sb );
+         }
+         return send_buffer;
+      }
+
+   private:
+
+      static send_buffer_type create_send_buffer( const signed_block_ptr& sb ) {
+         constexpr uint32_t compact_block_which = to_index(msg_type_t::compact_block_message);
+
+         fc_dlog( p2p_blk_log, "sending compact block ${bn}", ("bn", sb->block_num()) );
+         compact_block_message cb{ .header = *sb, .block_extensions = sb->block_extensions };
+         cb.transactions.reserve( sb->transactions.size() );
+         for( const auto& receipt : sb->transactions ) {
+            if( std::holds_alternative<packed_transaction>(receipt.trx) ) {
+               cb.packed_trx_indexes.push_back( cb.transactions.size() );
+               auto& r = cb.transactions.emplace_back( std::get<packed_transaction>(receipt.trx).id() );
+               static_cast<transaction_receipt_header&>(r) = receipt;
+            } else {
+               cb.transactions.push_back( receipt );
+            }
+         }
+         return buffer_factory::create_send_buffer( compact_block_which, cb );
       }
    };
 
@@ -122,6 +219,17 @@ namespace eosio {
          return send_buffer;
       }
 
+      /// caches result for subsequent calls, only provide same packed_transaction_ptr instance and codec for each invocation.
+      /// The trx is compressed once for all peers accepting codec, uncompressed if that would not make it smaller.
+      const send_buffer_type& get_send_buffer( const packed_transaction_ptr& trx, compression_codec codec ) {
+         if( codec == compression_codec::none )
+            return get_send_buffer( trx );
+         if( !compressed_send_buffer ) {
+            compressed_send_buffer = buffer_factory::create_compressed_send_buffer( codec, get_send_buffer( trx ) );
+         }
+         return compressed_send_buffer;
+      }
+
       /// caches result for subsequent calls, only provide same packed_transaction_ptr instance for each invocation.
       /// Do not use get_send_buffer() with get_notice_send_buffer(), only one valid per trx_buffer_factory instance.
       const send_buffer_type& get_notice_send_buffer( const packed_transaction_ptr& trx ) {
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <eosio/net_plugin/protocol.hpp>
+#include <eosio/chain/merkle.hpp>
+#include <eosio/chain/merkle_legacy.hpp>
+
+#include <vector>
+
+namespace eosio {
+
+   // true if the transaction merkle root of a reconstructed block matches its header, calculated as the controller does
+   inline bool transaction_mroot_matches( const signed_block& b ) {
+      deque<digest_type> digests;
+      for( const auto& receipt : b.transactions )
+         digests.emplace_back( receipt.digest() );
+      const digest_type mroot = b.is_proper_svnn_block() ? calculate_merkle( digests ) : calculate_merkle_legacy( std::move(digests) );
+      return mroot == b.transaction_mroot;
+   }
+
+   // compact block from a peer being reconstructed from local transactions and transactions requested from the peer
+   struct pending_compact_block {
+      enum class status {
+         complete,  // all transactions filled in and the transaction merkle root matches
+         missing,   // request the transactions at indexes missing from the peer
+         invalid    // peer sent an invalid compact block or transactions
+      };
+
+      block_id_type          id;
+      mutable_block_ptr      block;
+      std::vector<uint32_t>  packed_trx_indexes;
+      std::vector<uint32_t>  missing;               // indexes of requested transactions, empty when complete
+      bool                   all_requested = false; // every packed transaction requested after a merkle root mismatch
+
+      /// Fill in the transactions of msg found with get_txn(const transaction_id_type&) -> packed_transaction_ptr
+      template<typename GetTxn>
+      status init( const block_id_type& blk_id, const compact_block_message& msg, GetTxn&& get_txn ) {
+         id = blk_id;
+         block = signed_block::create_mutable_block( msg.header );
+         packed_trx_indexes = msg.packed_trx_indexes;
+         missing.clear();
+         all_requested = false;
+
+         signed_block& b = *block;
+         b.transactions.reserve( msg.transactions.size() );
+         for( const auto& receipt : msg.transactions )
+            b.transactions.emplace_back( receipt );
+         b.block_extensions = msg.block_extensions;
+         for( uint32_t i : packed_trx_indexes ) {
+            if( i >= b.transactions.size() || !std::holds_alternative<transaction_id_type>( b.transactions[i].trx ) )
+               return status::invalid;
+            transaction_receipt& receipt = b.transactions[i];
+            if( packed_transaction_ptr trx = get_txn( std::get<transaction_id_type>( receipt.trx ) ) ) {
+               receipt.trx.emplace<packed_transaction>( *trx );
+            } else {
+               missing.push_back( i );
+            }
+         }
+         if( !missing.empty() )
+            return status::missing;
+         // a local transaction with the same id but different signatures or context free data
+         return check_transaction_mroot();
+      }
+
+      /// Fill in trxs, the requested transactions in the order of missing
+      status add_transactions( const std::vector<packed_transaction>& trxs ) {
+         if( trxs.size() != missing.size() )
+            return status::invalid;
+         signed_block& b = *block;
+         for( size_t i = 0; i < trxs.size(); ++i )
+            b.transactions[missing[i]].trx.emplace<packed_transaction>( trxs[i] );
+         missing.clear();
+         return check_transaction_mroot();
+      }
+
+   private:
+      status check_transaction_mroot() {
+         if( transaction_mroot_matches( *block ) )
+            return status::complete;
+         if( all_requested || packed_trx_indexes.empty() )
+            return status::invalid;
+         missing = packed_trx_indexes;
+         all_requested = true;
+         return status::missing;
+      }
+   };
+
+} // namespace eosio
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <eosio/net_plugin/protocol.hpp>
+#include <eosio/chain/multi_index_includes.hpp>
+#include <eosio/chain/thread_utils.hpp>
+
+#include <fc/mutex.hpp>
+
+#include <boost/unordered/unordered_flat_set.hpp>
+
+#include <array>
+#include <map>
+
+namespace eosio {
+
+   using connection_id_t = uint32_t;
+   using connection_id_set = boost::unordered_flat_set<connection_id_t>;
+
+   struct node_transaction_state {
+      transaction_id_type        id;
+      time_point_sec             expires;           // time after which this may be purged.
+      mutable connection_id_set  connection_ids;    // all connections trx or trx notice received or trx sent
+      mutable bool               have_trx = false;  // trx received, not just trx notice, mutable because not indexed
+      mutable packed_transaction_ptr trx;           // set when accepted locally, used to reconstruct compact blocks
+      mutable connection_id_set  announced_by;      // connections that announced the trx, may be requested from
+      mutable connection_id_set  announced_to;      // connections the trx was announced to that have not requested it
+      connection_id_t            requested_from = 0; // connection the announced trx was requested from, 0 if none
+      fc::time_point             requested_time;     // when requested from requested_from
+   };
+
+   typedef boost::multi_index_container<
+      node_transaction_state,
+      indexed_by<
+         ordered_unique<
+            tag<by_id>,
+            member<node_transaction_state, transaction_id_type, &node_transaction_state::id>
+         >,
+         ordered_non_unique<
+            tag< struct by_expiry >,
+            member< node_transaction_state, fc::time_point_sec, &node_transaction_state::expires > >,
+         ordered_non_unique<
+            tag< struct by_request >,
+            composite_key< node_transaction_state,
+               member< node_transaction_state, connection_id_t, &node_transaction_state::requested_from >,
+               member< node_transaction_state, fc::time_point, &node_transaction_state::requested_time >
+            >
+         >
+      >
+      >
+   node_transaction_index;
+
+   struct peer_block_state {
+      block_id_type      id;
+      connection_id_t    connection_id = 0;
+
+      block_num_type block_num() const { return block_header::num_from_id(id); }
+   };
+
+   struct by_connection_id;
+
+   typedef boost::multi_index_container<
+      eosio::peer_block_state,
+      indexed_by<
+         ordered_unique< tag<by_connection_id>,
+               composite_key< peer_block_state,
+                     const_mem_fun<peer_block_state, block_num_type, &eosio::peer_block_state::block_num>,
+                     member<peer_block_state, block_id_type, &eosio::peer_block_state::id>,
+                     member<peer_block_state, connection_id_t, &eosio::peer_block_state::connection_id>
+               >,
+                         composite_key_compare< std::less<>, std::less<block_id_type>, std::less<> >
+         >
+      >
+      > peer_block_state_index;
+
+   // Index split by id into independently locked shards, so net threads handling different blocks and
+   // transactions rarely wait on each other
+   template <typename Index>
+   class sharded_index {
+   protected:
+      static constexpr size_t num_shards = 16;
+
+      struct shard {
+         alignas(hardware_destructive_interference_sz)
+         mutable fc::mutex mtx;
+         Index             index GUARDED_BY(mtx);
+      };
+
+      std::array<shard, num_shards> shards;
+
+      // the first 32 bits of a block id are the block number, the last 64 bits of block and transaction ids are hash
+      static size_t shard_index( const fc::sha256& id ) { return id._hash[3] % num_shards; }
+
+      shard&       shard_of( const fc::sha256& id )       { return shards[shard_index(id)]; }
+      const shard& shard_of( const fc::sha256& id ) const { return shards[shard_index(id)]; }
+
+   public:
+      /// number of entries, shards are locked one at a time so it is approximate while others modify the index
+      size_t size() const {
+         size_t s = 0;
+         for( const auto& sh : shards ) {
+            fc::lock_guard g( sh.mtx );
+            s += sh.index.size();
+         }
+         return s;
+      }
+   };
+
+   // blocks received from or sent to each connection, thread safe
+   class peer_block_state_shards : public sharded_index<peer_block_state_index> {
+   public:
+      /// @return true if not already tracked for connection_id
+      bool add_peer_block( const block_id_type& blkid, connection_id_t connection_id ) {
+         block_num_type block_num = block_header::num_from_id(blkid);
+         auto& shard = shard_of(blkid);
+         fc::lock_guard g( shard.mtx );
+         auto bptr = shard.index.get<by_connection_id>().find( std::forward_as_tuple(block_num, blkid, connection_id) );
+         bool added = (bptr == shard.index.end());
+         if( added ) {
+            shard.index.insert( {blkid, connection_id} );
+         }
+         return added;
+      }
+
+      bool peer_has_block( const block_id_type& blkid, connection_id_t connection_id ) const {
+         block_num_type block_num = block_header::num_from_id(blkid);
+         const auto& shard = shard_of(blkid);
+         fc::lock_guard g( shard.mtx );
+         const auto blk_itr = shard.index.get<by_connection_id>().find( std::forward_as_tuple(block_num, blkid, connection_id) );
+         return blk_itr != shard.index.end();
+      }
+
+      /// @return true if tracked for any connection
+      bool have_block( const block_id_type& blkid ) const {
+         block_num_type block_num = block_header::num_from_id(blkid);
+         const auto& shard = shard_of(blkid);
+         fc::lock_guard g( shard.mtx );
+         const auto& index = shard.index.get<by_connection_id>();
+         auto blk_itr = index.find( std::forward_as_tuple(block_num, blkid) );
+         return blk_itr != index.end();
+      }
+
+      void rm_block( const block_id_type& blkid ) {
+         block_num_type block_num = block_header::num_from_id(blkid);
+         auto& shard = shard_of(blkid);
+         fc::lock_guard g( shard.mtx );
+         auto& index = shard.index.get<by_connection_id>();
+         auto p = index.equal_range( std::forward_as_tuple(block_num, blkid) );
+         index.erase(p.first, p.second);
+      }
+
+      /// remove blocks up to and including fork_db_root_num
+      void expire_blocks( uint32_t fork_db_root_num ) {
+         for( auto& shard : shards ) { // one shard locked at a time
+            fc::lock_guard g( shard.mtx );
+            auto& stale_blk = shard.index.get<by_connection_id>();
+            stale_blk.erase( stale_blk.lower_bound( 1 ), stale_blk.upper_bound( fork_db_root_num ) );
+         }
+      }
+   };
+
+   // transactions and trx notices received from each connection and transactions accepted locally, thread safe
+   class node_transaction_shards : public sharded_index<node_transaction_index> {
+   public:
+      // does not account for the overhead of the multindex entry, but this is just an approximation
+      static constexpr uint32_t trx_full_entry_size = sizeof(node_transaction_state);
+      static constexpr uint32_t trx_conn_entry_size = sizeof(connection_id_t);
+
+      struct add_peer_txn_result {
+         uint32_t entries_size = 0; // approximate size added for connection_id
+         bool     have_trx = false; // true if we already have received the trx
+      };
+      add_peer_txn_result add_peer_txn( const transaction_id_type& id, const time_point_sec& expires, connection_id_t connection_id ) {
+         auto& shard = shard_of(id);
+         fc::lock_guard g( shard.mtx );
+
+         auto& id_idx = shard.index.get<by_id>();
+         if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
+            add_peer_txn_result result{ .have_trx = tptr->have_trx };
+            if (tptr->connection_ids.insert(connection_id).second)
+               result.entries_size = trx_conn_entry_size;
+            if (!result.have_trx) {
+               shard.index.modify(tptr, [&](auto& v) {
+                  v.expires = expires;
+                  v.have_trx = true;
+                  v.announced_by.clear();
+                  v.requested_from = 0;
+                  v.requested_time = fc::time_point{};
+               });
+            }
+            return result;
+         }
+         shard.index.insert( node_transaction_state{
+            .id = id,
+            .expires = expires,
+            .connection_ids = {connection_id},
+            .have_trx = true } );
+         return { .entries_size = trx_full_entry_size };
+      }
+
+      /// @return approximate size added for connection_id
+      uint32_t add_peer_txn_notice( const transaction_id_type& id, const time_point_sec& expires, connection_id_t connection_id ) {
+         auto& shard = shard_of(id);
+         fc::lock_guard g( shard.mtx );
+
+         auto& id_idx = shard.index.get<by_id>();
+         if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
+            return tptr->connection_ids.insert(connection_id).second ? trx_conn_entry_size : 0;
+         }
+         shard.index.insert( node_transaction_state{
+            .id = id,
+            .expires = expires,
+            .connection_ids = {connection_id},
+            .have_trx = false } );
+         return trx_full_entry_size;
+      }
+
+      struct add_peer_txn_announce_result {
+         uint32_t                         entries_size = 0; // approximate size added for connection_id
+         std::vector<transaction_id_type> unseen;           // ids to request from connection_id, not received or requested
+      };
+      /// Records connection_id as an announcer of ids, ids not received or already requested from another
+      /// announcer are requested from connection_id at now.
+      add_peer_txn_announce_result add_peer_txn_announce( const std::vector<transaction_id_type>& ids, const time_point_sec& expires,
+                                                          connection_id_t connection_id, const fc::time_point& now ) {
+         add_peer_txn_announce_result result;
+         for (const auto& id : ids) {
+            auto& shard = shard_of(id);
+            fc::lock_guard g( shard.mtx );
+
+            auto& id_idx = shard.index.get<by_id>();
+            if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
+               if (tptr->connection_ids.insert(connection_id).second)
+                  result.entries_size += trx_conn_entry_size;
+               if (tptr->have_trx || tptr->trx)
+                  continue;
+               tptr->announced_by.insert(connection_id);
+               if (tptr->requested_from == 0) {
+                  shard.index.modify(tptr, [&](auto& v) {
+                     v.requested_from = connection_id;
+                     v.requested_time = now;
+                  });
+                  result.unseen.push_back( id );
+               }
+            } else {
+               shard.index.insert( node_transaction_state{
+                  .id = id,
+                  .expires = expires,
+                  .connection_ids = {connection_id},
+                  .have_trx = false,
+                  .announced_by = {connection_id},
+                  .requested_from = connection_id,
+                  .requested_time = now } );
+               result.entries_size += trx_full_entry_size;
+               result.unseen.push_back( id );
+            }
+         }
+         return result;
+      }
+
+      struct reassign_txn_requests_result {
+         std::map<connection_id_t, std::vector<transaction_id_type>> requests; // ids to request by connection
+         bool pending = false; // requests from connection_id after requested_before are still outstanding
+      };
+      /// Requests of announced trxs made to connection_id at or before requested_before that have not been received
+      /// move to another connection that announced the trx. connection_id is no longer asked for those trxs.
+      /// Use fc::time_point::maximum() for requested_before when connection_id closes.
+      reassign_txn_requests_result reassign_txn_requests( connection_id_t connection_id, const fc::time_point& requested_before,
+                                                          const fc::time_point& now ) {
+         reassign_txn_requests_result result;
+         for( auto& shard : shards ) { // one shard locked at a time
+            fc::lock_guard g( shard.mtx );
+            auto& req_idx = shard.index.get<by_request>();
+            // requests from connection_id in the order made, each one handled moves out of them
+            for( auto cur = req_idx.lower_bound( std::make_tuple( connection_id ) );
+                 cur != req_idx.end() && cur->requested_from == connection_id;
+                 cur = req_idx.lower_bound( std::make_tuple( connection_id ) ) ) {
+               if( cur->requested_time > requested_before ) {
+                  result.pending = true;
+                  break;
+               }
+               connection_id_t next = 0;
+               if( !cur->have_trx && !cur->trx ) {
+                  cur->announced_by.erase( connection_id );
+                  if( !cur->announced_by.empty() ) {
+                     next = *cur->announced_by.begin();
+                     result.requests[next].push_back( cur->id );
+                  }
+               }
+               req_idx.modify( cur, [&]( auto& v ) {
+                  v.requested_from = next;
+                  v.requested_time = next ? now : fc::time_point{};
+               } );
+            }
+            if( requested_before == fc::time_point::maximum() ) {
+               // never pick a closed connection for a later reassignment of requests outstanding from others
+               for( auto i = req_idx.lower_bound( std::make_tuple( connection_id_t{1} ) ); i != req_idx.end(); ++i )
+                  i->announced_by.erase( connection_id );
+            }
+         }
+         return result;
+      }
+
+      /// Records ids as announced to connection_id, each may then be served once by get_announced_txn
+      void add_txns_announced( const std::vector<transaction_id_type>& ids, connection_id_t connection_id ) {
+         for (const auto& id : ids) {
+            auto& shard = shard_of(id);
+            fc::lock_guard g( shard.mtx );
+            auto& id_idx = shard.index.get<by_id>();
+            if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
+               tptr->announced_to.insert(connection_id);
+            }
+         }
+      }
+
+      /// @return trx if it was announced to connection_id and not already returned for connection_id
+      packed_transaction_ptr get_announced_txn( const transaction_id_type& id, connection_id_t connection_id ) {
+         auto& shard = shard_of(id);
+         fc::lock_guard g( shard.mtx );
+         auto& id_idx = shard.index.get<by_id>();
+         if (auto tptr = id_idx.find(id); tptr != id_idx.end() && tptr->announced_to.erase(connection_id)) {
+            return tptr->trx;
+         }
+         return {};
+      }
+
+      /// @return connections that trx was received from or sent to
+      connection_id_set add_local_txn( const packed_transaction_ptr& trx, const time_point_sec& expires ) {
+         auto& shard = shard_of(trx->id());
+         fc::lock_guard g( shard.mtx );
+         auto& id_idx = shard.index.get<by_id>();
+         if (auto tptr = id_idx.find(trx->id()); tptr != id_idx.end()) {
+            tptr->trx = trx;
+            return tptr->connection_ids;
+         }
+         shard.index.insert( node_transaction_state{
+            .id = trx->id(),
+            .expires = expires,
+            .have_trx = true,
+            .trx = trx } );
+         return {};
+      }
+
+      /// @return trx if accepted locally and not expired
+      packed_transaction_ptr get_txn( const transaction_id_type& id ) const {
+         const auto& shard = shard_of(id);
+         fc::lock_guard g( shard.mtx );
+         auto& id_idx = shard.index.get<by_id>();
+         if (auto tptr = id_idx.find(id); tptr != id_idx.end()) {
+            return tptr->trx;
+         }
+         return {};
+      }
+
+      /// remove entries expiring up to and including expire_upto
+      /// @return number of entries removed
+      size_t expire_txns( const time_point_sec& expire_upto ) {
+         size_t removed = 0;
+         for( auto& shard : shards ) { // one shard locked at a time
+            fc::lock_guard g( shard.mtx );
+            auto& old = shard.index.get<by_expiry>();
+            auto ex_lo = old.lower_bound( fc::time_point_sec( 0 ) );
+            auto ex_up = old.upper_bound( expire_upto );
+            const size_t start_size = shard.index.size();
+            old.erase( ex_lo, ex_up );
+            removed += start_size - shard.index.size();
+         }
+         return removed;
+      }
+   };
+
+} // namespace eosio
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <eosio/net_plugin/protocol.hpp>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace eosio {
+
+   // packed messages smaller than this are not worth the compression cpu time, transfer trx is ~170 bytes
+   constexpr size_t min_compressed_message_size = 512;
+
+   // a compressed_message may not decompress to more than the maximum size of a received message
+   constexpr size_t max_decompressed_message_size = 2*4*1024*1024;
+
+   // zip bomb protection, decompressed size is limited the same as the size of a received message
+   struct decompressed_message_limiter {
+      using char_type = char;
+      using category = boost::iostreams::multichar_output_filter_tag;
+
+      size_t limit = 0;
+      size_t total = 0;
+
+      template<typename Sink>
+      std::streamsize write(Sink& sink, const char* s, std::streamsize count) {
+         EOS_ASSERT( total + count <= limit, plugin_exception, "Exceeded maximum decompressed message size ${l}", ("l", limit) );
+         total += count;
+         return boost::iostreams::write(sink, s, count);
+      }
+   };
+
+   /// @return the concatenation of parts compressed with codec
+   inline std::vector<char> compress_message( compression_codec codec, std::initializer_list<std::span<const char>> parts ) {
+      namespace bio = boost::iostreams;
+      EOS_ASSERT( codec == compression_codec::zlib, plugin_exception, "Unsupported compression codec ${c}", ("c", static_cast<uint32_t>(codec)) );
+      std::vector<char> out;
+      bio::filtering_ostream comp;
+      comp.push(bio::zlib_compressor(bio::zlib::default_compression));
+      comp.push(bio::back_inserter(out));
+      for( const auto& part : parts )
+         bio::write(comp, part.data(), part.size());
+      bio::close(comp);
+      return out;
+   }
+
+   /// @return data decompressed with codec, throws if it decompresses to more than max_size bytes
+   inline std::vector<char> decompress_message( compression_codec codec, const std::vector<char>& data, size_t max_size ) {
+      namespace bio = boost::iostreams;
+      EOS_ASSERT( codec == compression_codec::zlib, plugin_exception, "Unsupported compression codec ${c}", ("c", static_cast<uint32_t>(codec)) );
+      std::vector<char> out;
+      bio::filtering_ostream decomp;
+      decomp.push(bio::zlib_decompressor());
+      decomp.push(decompressed_message_limiter{ .limit = max_size });
+      decomp.push(bio::back_inserter(out));
+      bio::write(decomp, data.data(), data.size());
+      bio::close(decomp);
+      return out;
+   }
+
+} // namespace eosio
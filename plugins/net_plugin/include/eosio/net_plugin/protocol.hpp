@@ -140,6 +140,52 @@ namespace eosio {
       transaction_id_type id;
    };
 
+   enum class compression_codec : uint8_t {
+      none = 0,
+      zlib = 1
+   };
+
+   // sent after the handshake, the codec the sender accepts compressed_message in, none for uncompressed only
+   struct compression_message {
+      uint8_t codec = static_cast<uint8_t>(compression_codec::none);
+   };
+
+   // a packed net_message, which followed by the message, compressed with codec
+   struct compressed_message {
+      uint8_t           codec = static_cast<uint8_t>(compression_codec::none);
+      std::vector<char> data;
+   };
+
+   // a signed_block with the packed_transaction of its receipts replaced by the transaction id
+   struct compact_block_message {
+      signed_block_header               header;
+      std::vector<transaction_receipt>  transactions;
+      std::vector<uint32_t>             packed_trx_indexes; // receipts of transactions that held a packed_transaction
+      extensions_type                   block_extensions;
+   };
+
+   // request for the packed_transaction of the receipts at indexes of the transactions of block id
+   struct block_transactions_request_message {
+      block_id_type         id;
+      std::vector<uint32_t> indexes;
+   };
+
+   // reply to block_transactions_request_message in requested order, empty if the block is not available
+   struct block_transactions_message {
+      block_id_type                    id;
+      std::vector<packed_transaction>  trxs;
+   };
+
+   // ids of transactions the sender has accepted, the receiver requests the ones it has not seen
+   struct transaction_announce_message {
+      std::vector<transaction_id_type> ids;
+   };
+
+   // request for the packed_transaction of announced ids, ids no longer available are skipped
+   struct transaction_request_message {
+      std::vector<transaction_id_type> ids;
+   };
+
    struct gossip_bp_peers_message {
       struct bp_peer_info_v1 {
          std::string               server_endpoint;      // externally available address to connect to
@@ -180,7 +226,14 @@ namespace eosio {
                                     block_nack_message,
                                     block_notice_message,
                                     gossip_bp_peers_message,
-                                    transaction_notice_message>;
+                                    transaction_notice_message,
+                                    compression_message,
+                                    compressed_message,
+                                    compact_block_message,
+                                    block_transactions_request_message,
+                                    block_transactions_message,
+                                    transaction_announce_message,
+                                    transaction_request_message>;
 
    // see protocol net_message
    enum class msg_type_t {
@@ -198,6 +251,13 @@ namespace eosio {
       block_notice_message   = fc::get_index<net_message, block_notice_message>(),
       gossip_bp_peers_message    = fc::get_index<net_message, gossip_bp_peers_message>(),
       transaction_notice_message = fc::get_index<net_message, transaction_notice_message>(),
+      compression_message        = fc::get_index<net_message, compression_message>(),
+      compressed_message         = fc::get_index<net_message, compressed_message>(),
+      compact_block_message      = fc::get_index<net_message, compact_block_message>(),
+      block_transactions_request_message = fc::get_index<net_message, block_transactions_request_message>(),
+      block_transactions_message = fc::get_index<net_message, block_transactions_message>(),
+      transaction_announce_message = fc::get_index<net_message, transaction_announce_message>(),
+      transaction_request_message  = fc::get_index<net_message, transaction_request_message>(),
       unknown
    };
 
@@ -232,6 +292,13 @@ FC_REFLECT( eosio::sync_request_message, (start_block)(end_block) )
 FC_REFLECT( eosio::block_nack_message, (id) )
 FC_REFLECT( eosio::block_notice_message, (previous)(id) )
 FC_REFLECT( eosio::transaction_notice_message, (id) )
+FC_REFLECT( eosio::compression_message, (codec) )
+FC_REFLECT( eosio::compressed_message, (codec)(data) )
+FC_REFLECT( eosio::compact_block_message, (header)(transactions)(packed_trx_indexes)(block_extensions) )
+FC_REFLECT( eosio::block_transactions_request_message, (id)(indexes) )
+FC_REFLECT( eosio::block_transactions_message, (id)(trxs) )
+FC_REFLECT( eosio::transaction_announce_message, (ids) )
+FC_REFLECT( eosio::transaction_request_message, (ids) )
 FC_REFLECT( eosio::gossip_bp_peers_message::bp_peer_info_v1, (server_endpoint)(outbound_ip_address)(expiration) )
 FC_REFLECT( eosio::gossip_bp_peers_message::bp_peer, (version)(producer_name)(bp_peer_info) )
 FC_REFLECT_DERIVED(eosio::gossip_bp_peers_message::signed_bp_peer, (eosio::gossip_bp_peers_message::bp_peer), (sig) )
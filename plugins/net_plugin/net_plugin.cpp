@@ -1,5 +1,7 @@
 #include <eosio/net_plugin/net_plugin.hpp>
 #include <eosio/net_plugin/buffer_factory.hpp>
+#include <eosio/net_plugin/compact_block.hpp>
+#include <eosio/net_plugin/dispatch_index.hpp>
 #include <eosio/net_plugin/gossip_bps_index.hpp>
 #include <eosio/net_plugin/protocol.hpp>
 #include <eosio/net_plugin/net_logger.hpp>
@@ -84,52 +86,6 @@ namespace eosio {
    static constexpr int64_t block_interval_ns =
       std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(config::block_interval_ms)).count();
 
-   using connection_id_t = uint32_t;
-   using connection_id_set = boost::unordered_flat_set<connection_id_t>;
-   struct node_transaction_state {
-      transaction_id_type        id;
-      time_point_sec             expires;           // time after which this may be purged.
-      mutable connection_id_set  connection_ids;    // all connections trx or trx notice received or trx sent
-      mutable bool               have_trx = false;  // trx received, not just trx notice, mutable because not indexed
-   };
-
-   typedef multi_index_container<
-      node_transaction_state,
-      indexed_by<
-         ordered_unique<
-            tag<by_id>,
-            member<node_transaction_state, transaction_id_type, &node_transaction_state::id>
-         >,
-         ordered_non_unique<
-            tag< struct by_expiry >,
-            member< node_transaction_state, fc::time_point_sec, &node_transaction_state::expires > >
-         >
-      >
-   node_transaction_index;
-
-   struct peer_block_state {
-      block_id_type      id;
-      connection_id_t    connection_id = 0;
-
-      block_num_type block_num() const { return block_header::num_from_id(id); }
-   };
-
-   struct by_connection_id;
-
-   typedef multi_index_container<
-      eosio::peer_block_state,
-      indexed_by<
-         ordered_unique< tag<by_connection_id>,
-               composite_key< peer_block_state,
-                     const_mem_fun<peer_block_state, block_num_type, &eosio::peer_block_state::block_num>,
-                     member<peer_block_state, block_id_type, &eosio::peer_block_state::id>,
-                     member<peer_block_state, connection_id_t, &eosio::peer_block_state::connection_id>
-               >,
-                         composite_key_compare< std::less<>, std::less<block_id_type>, std::less<> >
-         >
-      >
-      > peer_block_state_index;
-
    class sync_manager {
    private:
       enum stages {
@@ -145,8 +101,25 @@ namespace eosio {
       uint32_t       sync_next_expected_num      GUARDED_BY(sync_mtx) {0};  // the next block number we need from peer
       connection_ptr sync_source                 GUARDED_BY(sync_mtx);      // connection we are currently syncing from
 
+      // striped sync: disjoint ranges requested from up to sync_peer_limit peers at once; blocks received ahead of
+      // sync_next_expected_num are held until the blocks before them arrive and are then handed to the controller in order
+      struct sync_stripe {
+         uint32_t       start = 0;
+         uint32_t       end = 0;
+         connection_ptr source;
+      };
+      struct sync_pending_block {
+         block_id_type    id;
+         signed_block_ptr block;
+         connection_ptr   source;
+      };
+      std::vector<sync_stripe>                      sync_stripes GUARDED_BY(sync_mtx);          // outstanding ranges, one per peer
+      std::deque<std::pair<uint32_t, uint32_t>>     sync_orphaned_ranges GUARDED_BY(sync_mtx);  // ranges of failed stripes to request again
+      std::map<uint32_t, sync_pending_block>        sync_reassembly GUARDED_BY(sync_mtx);       // blocks received ahead, by block num
+
       const uint32_t sync_fetch_span {0};
       const uint32_t sync_peer_limit {0};
+      const bool     sync_striped {false};
 
       alignas(hardware_destructive_interference_sz)
       std::atomic<stages> sync_state{in_sync};
@@ -169,7 +142,12 @@ namespace eosio {
       bool is_sync_required( uint32_t fork_db_head_block_num ) const REQUIRES(sync_mtx);
       bool is_sync_request_ahead_allowed(block_num_type blk_num) const REQUIRES(sync_mtx);
       void request_next_chunk( const connection_ptr& conn = connection_ptr() ) REQUIRES(sync_mtx);
-      connection_ptr find_next_sync_node(); // call with locked mutex
+      bool request_next_stripes() REQUIRES(sync_mtx);
+      bool orphan_stripe( const connection_ptr& c ) REQUIRES(sync_mtx);
+      bool sync_stripe_progress( const connection_ptr& c, uint32_t blk_num ) REQUIRES(sync_mtx);
+      void reset_stripes() REQUIRES(sync_mtx);
+      void release_reassembled_blocks() REQUIRES(sync_mtx);
+      connection_ptr find_next_sync_node(uint32_t start_num); // call with locked mutex
       void start_sync( const connection_ptr& c, uint32_t target ); // locks mutex
       bool sync_recently_active() const;
       bool verify_catchup( const connection_ptr& c, uint32_t num, const block_id_type& id ); // locks mutex
@@ -178,7 +156,7 @@ namespace eosio {
          immediately,  // closing connection immediately
          handshake     // sending handshake message
       };
-      explicit sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance );
+      explicit sync_manager( uint32_t span, uint32_t sync_peer_limit, bool striped, uint32_t min_blocks_distance );
       static void send_handshakes();
       static void send_block_nack_resets();
       bool syncing_from_peer() const { return sync_state == lib_catchup; }
@@ -193,16 +171,15 @@ namespace eosio {
       void recv_handshake( const connection_ptr& c, const handshake_message& msg, uint32_t nblk_combined_latency );
       void sync_recv_notice( const connection_ptr& c, const notice_message& msg );
       void send_handshakes_if_synced(const fc::microseconds& blk_latency);
+      bool sync_reassemble_block( const connection_ptr& c, const block_id_type& blk_id, const signed_block_ptr& ptr );
+      void sync_have_block( uint32_t blk_num );
    };
 
    class dispatch_manager {
-      alignas(hardware_destructive_interference_sz)
-      mutable fc::mutex      blk_state_mtx;
-      peer_block_state_index  blk_state GUARDED_BY(blk_state_mtx);
+      peer_block_state_shards  blk_state;
+      node_transaction_shards  local_txns;
 
-      alignas(hardware_destructive_interference_sz)
-      mutable fc::mutex      local_txns_mtx;
-      node_transaction_index  local_txns GUARDED_BY(local_txns_mtx);
+      void add_trx_entries_size( connection& c, uint32_t entries_size );
 
    public:
       boost::asio::io_context::strand  strand;
@@ -230,7 +207,15 @@ namespace eosio {
       };
       add_peer_txn_info add_peer_txn(const transaction_id_type& id, const time_point_sec& trx_expires, connection& c);
       size_t add_peer_txn_notice(const transaction_id_type& id, connection& c);
-      connection_id_set peer_connections(const transaction_id_type& id) const;
+      // returns the announced ids to request from c, not already received or requested from any connection
+      std::vector<transaction_id_type> add_peer_txn_announce(const std::vector<transaction_id_type>& ids, connection& c);
+      // requests from connection_id made at or before requested_before are sent to another announcer of the trx,
+      // returns true if requests made to connection_id after requested_before are outstanding
+      bool reassign_txn_requests(connection_id_t connection_id, const fc::time_point& requested_before);
+      void add_txns_announced(const std::vector<transaction_id_type>& ids, connection_id_t connection_id);
+      packed_transaction_ptr get_announced_txn(const transaction_id_type& id, connection_id_t connection_id);
+      connection_id_set add_local_txn(const packed_transaction_ptr& trx);
+      packed_transaction_ptr get_txn(const transaction_id_type& id) const;
       void expire_txns();
 
       void bcast_vote_msg( connection_id_t exclude_peer, const send_buffer_type& msg );
@@ -267,20 +252,28 @@ namespace eosio {
       savanna = 9,                   // savanna, adds vote_message
       block_nack = 10,               // adds block_nack_message & block_notice_message
       gossip_bp_peers = 11,          // adds gossip_bp_peers_message
-      trx_notice = 12                // adds transaction_notice_message
+      trx_notice = 12,               // adds transaction_notice_message
+      compression = 13,              // adds compression_message & compressed_message
+      compact_block = 14,            // adds compact_block_message, block_transactions_request_message & block_transactions_message
+      trx_announce = 15              // adds transaction_announce_message & transaction_request_message
    };
 
-   constexpr proto_version_t net_version_max = proto_version_t::trx_notice;
+   constexpr proto_version_t net_version_max = proto_version_t::trx_announce;
 
    /**
     * default value initializers
     */
    constexpr auto     def_send_buffer_size_mb = 4;
    constexpr auto     def_send_buffer_size = 1024*1024*def_send_buffer_size_mb;
+   static_assert(max_decompressed_message_size == 2u*def_send_buffer_size, "decompressed messages limited to received message size");
    constexpr auto     def_max_write_queue_size = def_send_buffer_size*10;
    constexpr uint32_t def_max_trx_in_progress_size = 100u*1024u*1024u; // 100 MB
    constexpr uint32_t def_max_trx_entries_per_conn_size = 100u*1024u*1024u; // 100 MB = ~100K TPS
    constexpr auto     def_max_consecutive_immediate_connection_close = 9; // back off if client keeps closing
+   constexpr size_t   def_max_pending_compact_blocks = 16; // compact blocks waiting on transactions from a peer
+   constexpr size_t   def_max_trx_announce_ids = 1000; // ids per transaction_announce_message & transaction_request_message
+   constexpr auto     def_trx_announce_window_ms = 10;
+   constexpr auto     def_trx_request_timeout = std::chrono::seconds(1); // request an announced trx from another announcer after
    constexpr auto     def_max_clients = 25; // 0 for unlimited clients
    constexpr auto     def_max_nodes_per_host = 1;
    constexpr auto     def_conn_retry_wait = 30;
@@ -430,6 +423,10 @@ namespace eosio {
       uint32_t                              max_nodes_per_host = 1;
       bool                                  p2p_accept_transactions = true;
       bool                                  p2p_disable_block_nack = false;
+      compression_codec                     p2p_compression = compression_codec::none;
+      bool                                  p2p_compact_block_relay = false;
+      bool                                  p2p_trx_announce = false;
+      std::chrono::milliseconds             p2p_trx_announce_window{def_trx_announce_window_ms};
       bool                                  p2p_accept_votes = true;
       fc::microseconds                      p2p_dedup_cache_expire_time_us{};
 
@@ -634,19 +631,22 @@ namespace eosio {
 
       enum class queue_t { block_sync, general };
       // @param callback must not callback into queued_buffer
+      // @param payload if not empty, written directly after buff
       bool add_write_queue(msg_type_t net_msg,
                            queue_t queue,
                            const send_buffer_type& buff,
-                           std::function<void(boost::system::error_code, std::size_t)> callback) {
+                           std::function<void(boost::system::error_code, std::size_t)> callback,
+                           const block_view& payload = {}) {
          fc::lock_guard g( _mtx );
-         if( net_msg == msg_type_t::packed_transaction || net_msg == msg_type_t::transaction_notice_message ) {
-            _trx_write_queue.emplace_back( buff, std::move(callback) );
+         if( net_msg == msg_type_t::packed_transaction || net_msg == msg_type_t::transaction_notice_message ||
+             net_msg == msg_type_t::transaction_announce_message ) {
+            _trx_write_queue.emplace_back( buff, std::move(callback), payload );
          } else if (queue == queue_t::block_sync) {
-            _sync_write_queue.emplace_back( buff, std::move(callback) );
+            _sync_write_queue.emplace_back( buff, std::move(callback), payload );
          } else {
-            _write_queue.emplace_back( buff, std::move(callback) );
+            _write_queue.emplace_back( buff, std::move(callback), payload );
          }
-         _write_queue_size += buff->size();
+         _write_queue_size += buff->size() + payload.size();
          if( _write_queue_size > 2 * def_max_write_queue_size ) {
             return false;
          }
@@ -672,7 +672,9 @@ namespace eosio {
          while ( !w_queue.empty() ) {
             auto& m = w_queue.front();
             bufs.emplace_back( m.buff->data(), m.buff->size() );
-            _write_queue_size -= m.buff->size();
+            if( !m.payload.empty() )
+               bufs.emplace_back( m.payload.packed.data(), m.payload.size() );
+            _write_queue_size -= m.buff->size() + m.payload.size();
             _out_queue.emplace_back( m );
             w_queue.pop_front();
          }
@@ -688,6 +690,7 @@ namespace eosio {
       struct queued_write {
          send_buffer_type buff;
          std::function<void( boost::system::error_code, std::size_t )> callback;
+         block_view       payload; // serialized block sent in place from the block log, follows buff
       };
 
       alignas(hardware_destructive_interference_sz)
@@ -740,6 +743,26 @@ namespace eosio {
       block_status_monitor& operator=( block_status_monitor&& ) = delete;
    }; // block_status_monitor
 
+   /**
+    * A net_message serialized in memory, the decompressed message of a compressed_message or a reconstructed
+    * compact block. Provides the part of the fc::message_buffer interface used to process a message so blocks
+    * and transactions are processed the same however they were received.
+    */
+   class serialized_message_buffer {
+   public:
+      explicit serialized_message_buffer( std::vector<char> msg ) : msg_( std::move(msg) ) {}
+
+      size_t size() const { return msg_.size(); }
+      fc::datastream<const char*> create_peek_datastream() const { return {msg_.data() + read_pos_, msg_.size() - read_pos_}; }
+      // nothing follows the message, so reading from the datastream does not need to advance the read position
+      fc::datastream<const char*> create_datastream() const { return create_peek_datastream(); }
+      void advance_read_ptr( size_t bytes ) { read_pos_ = std::min( read_pos_ + bytes, msg_.size() ); }
+
+   private:
+      std::vector<char> msg_;
+      size_t            read_pos_ = 0;
+   };
+
 
    class connection : public std::enable_shared_from_this<connection> {
    public:
@@ -858,9 +881,6 @@ namespace eosio {
       // approximate size of trx entries in the local txn cache local_txns, accessed by connection strand
       uint32_t                   trx_entries_size{0};
       fc::time_point             trx_entries_reset = fc::time_point::now();
-      // does not account for the overhead of the multindex entry, but this is just an approximation
-      static constexpr uint32_t  trx_full_entry_size = sizeof(node_transaction_state);
-      static constexpr uint32_t  trx_conn_entry_size = sizeof(connection_id_t);
 
       fc::time_point          last_dropped_trx_msg_time;
       const connection_id_t   connection_id;
@@ -882,6 +902,12 @@ namespace eosio {
       alignas(hardware_destructive_interference_sz)
       fc::mutex                        sync_response_expected_timer_mtx;
       boost::asio::steady_timer        sync_response_expected_timer GUARDED_BY(sync_response_expected_timer_mtx);
+      // ids of transactions to announce to the peer and the batching window timer, connection strand only
+      std::vector<transaction_id_type> trx_announce_batch;
+      boost::asio::steady_timer        trx_announce_timer;
+      // checks announced trxs requested from the peer are received, connection strand only
+      boost::asio::steady_timer        trx_request_timer;
+      bool                             trx_request_timer_active = false;
 
       alignas(hardware_destructive_interference_sz)
       std::atomic<go_away_reason>      no_retry{go_away_reason::no_reason};
@@ -906,6 +932,24 @@ namespace eosio {
       block_id_type   last_block_nack;
       block_id_type   last_block_nack_request_message_id GUARDED_BY(conn_mtx);
 
+      // compact blocks from the peer being reconstructed, connection strand only
+      std::deque<pending_compact_block> pending_compact_blocks; // in order received
+
+      // codec of the peer's compression_message, none until received
+      std::atomic<compression_codec> peer_compression{compression_codec::none};
+      // codec to compress blocks and transactions sent to the peer with, thread safe
+      compression_codec send_compression() const {
+         return my_impl->p2p_compression == compression_codec::none ? compression_codec::none : peer_compression.load();
+      }
+      // set when the peer sends a transaction_announce_message, it does so only with p2p-trx-announce enabled
+      std::atomic<bool> peer_trx_announce{false};
+      // true if transactions are announced to the peer by id instead of sent, both sides enable p2p-trx-announce, thread safe
+      bool trx_announce_connection() const {
+         return my_impl->p2p_trx_announce && peer_trx_announce && protocol_version >= proto_version_t::trx_announce;
+      }
+      void announce_transaction(const transaction_id_type& id);
+      void start_trx_request_timer();
+
       connection_status get_status()const;
 
       /** \name Peer Timestamps
@@ -934,14 +978,22 @@ namespace eosio {
    private:
       void _close( bool reconnect, bool shutdown ); // for easy capture
 
-      bool process_next_block_message(uint32_t message_length);
-      bool process_next_trx_message(uint32_t message_length);
+      template <typename MessageBuffer>
+      bool process_next_block_message(MessageBuffer& buffer, uint32_t message_length);
+      template <typename MessageBuffer>
+      bool process_next_trx_message(MessageBuffer& buffer, uint32_t message_length);
+      bool process_next_compressed_message(uint32_t message_length);
+      void request_block_transactions(const pending_compact_block& pending);
+      void process_ready_compact_blocks();
+      void send_trx_announce_batch();
+      void send_trx_announce_support();
       bool process_next_trx_notice_message(uint32_t message_length);
       bool process_next_vote_message(uint32_t message_length);
       void update_endpoints(const tcp::endpoint& endpoint = tcp::endpoint());
 
       void send_gossip_bp_peers_initial_message();
       void send_gossip_bp_peers_message();
+      void send_compression_message();
    public:
       static void send_gossip_bp_peers_message_to_bp_peers();
 
@@ -996,12 +1048,13 @@ namespace eosio {
       void blk_send_branch(uint32_t msg_head_num, uint32_t fork_db_root_num, uint32_t head_num, peer_sync_state::sync_t sync_type);
 
       void enqueue( const net_message& msg );
-      size_t enqueue_block( const std::vector<char>& sb, uint32_t block_num, queued_buffer::queue_t queue );
+      size_t enqueue_block( const block_view& sb, uint32_t block_num, queued_buffer::queue_t queue );
       void enqueue_buffer( msg_type_t net_msg,
                            std::optional<block_num_type> block_num,
                            queued_buffer::queue_t queue,
                            const send_buffer_type& send_buffer,
-                           go_away_reason close_after_send);
+                           go_away_reason close_after_send,
+                           const block_view& payload = {});
       void cancel_sync();
       void flush_queues();
       bool enqueue_sync_block();
@@ -1014,7 +1067,8 @@ namespace eosio {
                        std::optional<block_num_type> block_num,
                        queued_buffer::queue_t queue,
                        const send_buffer_type& buff,
-                       std::function<void(boost::system::error_code, std::size_t)> callback);
+                       std::function<void(boost::system::error_code, std::size_t)> callback,
+                       const block_view& payload = {});
       void do_queue_write(std::optional<block_num_type> block_num);
       void log_send_buffer_stats() const;
 
@@ -1043,6 +1097,7 @@ namespace eosio {
       void handle_message( const sync_request_message& msg );
       void handle_message( const signed_block& msg ) = delete; // signed_block_ptr overload used instead
       void handle_message( const block_id_type& id, signed_block_ptr ptr );
+      void dispatch_block( const block_id_type& id, signed_block_ptr ptr );
       void handle_message( const packed_transaction& msg ) = delete; // packed_transaction_ptr overload used instead
       void handle_message( const packed_transaction_ptr& trx );
       void handle_message( const vote_message_ptr& msg );
@@ -1052,6 +1107,12 @@ namespace eosio {
       void handle_message( gossip_bp_peers_message& msg);
       void handle_message( const gossip_bp_peers_message& msg) = delete;
       void handle_message( const transaction_notice_message& msg);
+      void handle_message( const compression_message& msg);
+      void handle_message( const compact_block_message& msg);
+      void handle_message( const block_transactions_request_message& msg);
+      void handle_message( const block_transactions_message& msg);
+      void handle_message( const transaction_announce_message& msg);
+      void handle_message( const transaction_request_message& msg);
 
       // returns calculated number of blocks combined latency
       uint32_t calc_block_latency();
@@ -1151,6 +1212,44 @@ namespace eosio {
          peer_dlog( p2p_msg_log, c, "handle gossip_bp_peers_message ${m}", ("m", msg) );
          c->handle_message( msg );
       }
+
+      void operator()( const compression_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_msg_log, c, "handle compression_message ${c}", ("c", msg.codec) );
+         c->handle_message( msg );
+      }
+
+      void operator()( const compact_block_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_blk_log, c, "handle compact_block_message #${bn}", ("bn", msg.header.block_num()) );
+         c->handle_message( msg );
+      }
+
+      void operator()( const block_transactions_request_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_blk_log, c, "handle block_transactions_request_message #${bn}, trxs ${n}",
+                    ("bn", block_header::num_from_id(msg.id))("n", msg.indexes.size()) );
+         c->handle_message( msg );
+      }
+
+      void operator()( const block_transactions_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_blk_log, c, "handle block_transactions_message #${bn}, trxs ${n}",
+                    ("bn", block_header::num_from_id(msg.id))("n", msg.trxs.size()) );
+         c->handle_message( msg );
+      }
+
+      void operator()( const transaction_announce_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_trx_log, c, "handle transaction_announce_message, trxs ${n}", ("n", msg.ids.size()) );
+         c->handle_message( msg );
+      }
+
+      void operator()( const transaction_request_message& msg ) const {
+         // continue call to handle_message on connection strand
+         peer_dlog( p2p_trx_log, c, "handle transaction_request_message, trxs ${n}", ("n", msg.ids.size()) );
+         c->handle_message( msg );
+      }
    };
 
    template<typename Function>
@@ -1230,6 +1329,8 @@ namespace eosio {
         log_p2p_address( endpoint ),
         connection_id( ++my_impl->current_connection_id ),
         sync_response_expected_timer( my_impl->thread_pool.get_executor() ),
+        trx_announce_timer( my_impl->thread_pool.get_executor() ),
+        trx_request_timer( my_impl->thread_pool.get_executor() ),
         last_handshake_recv(),
         last_handshake_sent(),
         p2p_address( endpoint )
@@ -1249,6 +1350,8 @@ namespace eosio {
         listen_address( listen_address ),
         connection_id( ++my_impl->current_connection_id ),
         sync_response_expected_timer( my_impl->thread_pool.get_executor() ),
+        trx_announce_timer( my_impl->thread_pool.get_executor() ),
+        trx_request_timer( my_impl->thread_pool.get_executor() ),
         last_handshake_recv(),
         last_handshake_sent()
    {
@@ -1476,6 +1579,14 @@ namespace eosio {
       consecutive_blocks_nacks = 0;
       last_block_nack = block_id_type{};
       bp_connection = bp_connection_type::non_bp;
+      peer_compression = compression_codec::none;
+      pending_compact_blocks.clear();
+      trx_announce_batch.clear();
+      trx_announce_timer.cancel();
+      peer_trx_announce = false;
+      trx_request_timer.cancel();
+      trx_request_timer_active = false;
+      my_impl->dispatcher.reassign_txn_requests( connection_id, fc::time_point::maximum() );
 
       // if recently received a block from the connection then reset all connection block nacks
       if (last_received_block_time.load() >= my_impl->last_block_received_time.load() - fc::seconds(3)) {
@@ -1680,8 +1791,9 @@ namespace eosio {
                                 std::optional<block_num_type> block_num,
                                 queued_buffer::queue_t queue,
                                 const send_buffer_type& buff,
-                                std::function<void(boost::system::error_code, std::size_t)> callback) {
-      if( !buffer_queue.add_write_queue( net_msg, queue, buff, std::move(callback) )) {
+                                std::function<void(boost::system::error_code, std::size_t)> callback,
+                                const block_view& payload) {
+      if( !buffer_queue.add_write_queue( net_msg, queue, buff, std::move(callback), payload )) {
          peer_wlog( p2p_conn_log, this, "write_queue full ${s} bytes, giving up on connection", ("s", buffer_queue.write_queue_size()) );
          close();
          return;
@@ -1777,9 +1889,9 @@ namespace eosio {
       uint32_t num = peer_requested->last + 1;
 
       controller& cc = my_impl->chain_plug->chain();
-      std::vector<char> sb;
+      block_view sb;
       try {
-         sb = cc.fetch_serialized_block_by_number( num ); // thread-safe
+         sb = cc.fetch_block_view_by_number( num ); // thread-safe
       } FC_LOG_AND_DROP();
       if( !sb.empty() ) {
          // Skip transmitting block this loop if threshold exceeded
@@ -1850,15 +1962,22 @@ namespace eosio {
    }
 
    // called from connection strand
-   size_t connection::enqueue_block( const std::vector<char>& b, uint32_t block_num, queued_buffer::queue_t queue ) {
+   size_t connection::enqueue_block( const block_view& b, uint32_t block_num, queued_buffer::queue_t queue ) {
       peer_dlog( p2p_blk_log, this, "enqueue block ${num}", ("num", block_num) );
       verify_strand_in_this_thread( strand, __func__, __LINE__ );
 
       block_buffer_factory buff_factory;
-      const auto& sb = buff_factory.get_send_buffer( b );
       latest_blk_time = std::chrono::steady_clock::now();
-      enqueue_buffer( msg_type_t::signed_block, block_num, queue, sb, go_away_reason::no_reason);
-      return sb->size();
+      if( const compression_codec codec = send_compression(); codec != compression_codec::none ) {
+         const auto& csb = buff_factory.get_compressed_send_buffer( b, codec );
+         if( csb ) {
+            enqueue_buffer( msg_type_t::signed_block, block_num, queue, csb, go_away_reason::no_reason );
+            return csb->size();
+         }
+      }
+      const auto& sb = buff_factory.get_send_buffer_header( b );
+      enqueue_buffer( msg_type_t::signed_block, block_num, queue, sb, go_away_reason::no_reason, b );
+      return sb->size() + b.size();
    }
 
    // called from connection strand
@@ -1866,7 +1985,8 @@ namespace eosio {
                                     std::optional<block_num_type> block_num, // only valid for net_msg == signed_block variant which
                                     queued_buffer::queue_t queue,
                                     const send_buffer_type& send_buffer,
-                                    go_away_reason close_after_send)
+                                    go_away_reason close_after_send,
+                                    const block_view& payload)
    {
       connection_ptr self = shared_from_this();
       queue_write(net_msg, block_num, queue, send_buffer,
@@ -1885,7 +2005,7 @@ namespace eosio {
                            conn->close();
                            return;
                         }
-                  });
+                  }, payload);
    }
 
    // thread safe
@@ -1942,13 +2062,14 @@ namespace eosio {
    }
    //-----------------------------------------------------------
 
-    sync_manager::sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance )
+    sync_manager::sync_manager( uint32_t span, uint32_t sync_peer_limit, bool striped, uint32_t min_blocks_distance )
       :sync_known_fork_db_root_num( 0 )
       ,sync_last_requested_num( 0 )
       ,sync_next_expected_num( 1 )
       ,sync_source()
       ,sync_fetch_span( span )
       ,sync_peer_limit( sync_peer_limit )
+      ,sync_striped( striped )
       ,sync_state(in_sync)
       ,min_blocks_distance(min_blocks_distance)
    {
@@ -1996,7 +2117,10 @@ namespace eosio {
          sync_known_fork_db_root_num = highest_fork_db_root_num;
 
          // if closing the connection we are currently syncing from then request from a diff peer
-         if( c == sync_source ) {
+         if( sync_striped ) {
+            if( orphan_stripe( c ) )
+               request_next_chunk();
+         } else if( c == sync_source ) {
             // if starting to sync need to always start from fork_db_root as we might be on our own fork
             uint32_t fork_db_root_num = my_impl->get_fork_db_root_num();
             sync_last_requested_num = 0;
@@ -2007,15 +2131,19 @@ namespace eosio {
       }
    }
 
-   connection_ptr sync_manager::find_next_sync_node() REQUIRES(sync_mtx) {
-      fc_dlog(p2p_blk_log, "Number connections ${s}, sync_next_expected_num: ${e}, sync_known_fork_db_root_num: ${l}",
-              ("s", my_impl->connections.number_connections())("e", sync_next_expected_num)("l", sync_known_fork_db_root_num));
+   connection_ptr sync_manager::find_next_sync_node(uint32_t start_num) REQUIRES(sync_mtx) {
+      fc_dlog(p2p_blk_log, "Number connections ${s}, start_num: ${e}, sync_known_fork_db_root_num: ${l}",
+              ("s", my_impl->connections.number_connections())("e", start_num)("l", sync_known_fork_db_root_num));
       deque<connection_ptr> conns;
-      my_impl->connections.for_each_block_connection([sync_next_expected_num = sync_next_expected_num,
+      my_impl->connections.for_each_block_connection([start_num,
                                                       sync_known_froot_num = sync_known_fork_db_root_num,
                                                       sync_fetch_span = sync_fetch_span,
+                                                      &stripes = sync_stripes,
                                                       &conns](const auto& c) {
-         if (c->should_sync_from(sync_next_expected_num, sync_known_froot_num, sync_fetch_span)) {
+         // a peer serves at most one stripe at a time
+         if (std::ranges::any_of(stripes, [&c](const sync_stripe& s) { return s.source == c; }))
+            return;
+         if (c->should_sync_from(start_num, sync_known_froot_num, sync_fetch_span)) {
             conns.push_back(c);
          }
       });
@@ -2076,10 +2204,9 @@ namespace eosio {
        * a provider is supplied and able to be used, use it.
        * otherwise select the next available from the list, round-robin style.
        */
-      connection_ptr new_sync_source = (conn && conn->current()) ? conn : find_next_sync_node();
-
       auto reset_on_failure = [&]() REQUIRES(sync_mtx) {
          sync_source.reset();
+         reset_stripes();
          sync_known_fork_db_root_num = chain_info.fork_db_root_num;
          sync_last_requested_num = 0;
          sync_next_expected_num = std::max( sync_known_fork_db_root_num + 1, sync_next_expected_num );
@@ -2088,6 +2215,16 @@ namespace eosio {
          send_handshakes();
       };
 
+      if( sync_striped ) {
+         if( !request_next_stripes() && sync_stripes.empty() ) {
+            fc_wlog( p2p_blk_log, "Unable to request any range, sending handshakes to everyone" );
+            reset_on_failure();
+         }
+         return;
+      }
+
+      connection_ptr new_sync_source = (conn && conn->current()) ? conn : find_next_sync_node(sync_next_expected_num);
+
       // verify there is an available source
       if( !new_sync_source ) {
          fc_wlog( p2p_blk_log, "Unable to continue syncing at this time");
@@ -2118,6 +2255,140 @@ namespace eosio {
       }
    }
 
+   // call with g_sync locked; assigns orphaned ranges and then new ranges to idle peers.
+   // returns false if a range is waiting to be requested but no peer is able to serve it
+   bool sync_manager::request_next_stripes() REQUIRES(sync_mtx) {
+      // blocks not yet applied are bounded to one fetch span per peer, this also bounds the reassembly buffer.
+      // In irreversible mode blocks are only applied once irreversible, bound by the fork database head instead.
+      const bool irreversible = my_impl->chain_plug->chain().get_read_mode() == db_read_mode::IRREVERSIBLE;
+      const uint32_t head_num = irreversible ? my_impl->get_fork_db_head_num() : my_impl->get_chain_head_num();
+      const uint32_t max_requested_num = head_num + sync_fetch_span * std::max(sync_peer_limit, 1u);
+
+      bool peer_source_available = true;
+      while( sync_stripes.size() < std::max(sync_peer_limit, 1u) ) {
+         uint32_t start = 0, end = 0;
+         const bool orphaned = !sync_orphaned_ranges.empty();
+         if( orphaned ) {
+            std::tie(start, end) = sync_orphaned_ranges.front();
+            start = std::max( start, sync_next_expected_num ); // part of the range may already have arrived from elsewhere
+         } else {
+            if( sync_last_requested_num >= sync_known_fork_db_root_num || sync_last_requested_num >= max_requested_num )
+               break;
+            start = std::max( sync_last_requested_num + 1, sync_next_expected_num );
+            end = std::min( start + sync_fetch_span - 1, sync_known_fork_db_root_num );
+         }
+         if( start > end ) {
+            sync_orphaned_ranges.pop_front();
+            continue;
+         }
+
+         connection_ptr c = find_next_sync_node( start );
+         if( !c ) {
+            peer_source_available = false;
+            break;
+         }
+         if( orphaned )
+            sync_orphaned_ranges.pop_front();
+         sync_last_requested_num = std::max( sync_last_requested_num, end );
+         sync_stripes.push_back( sync_stripe{ start, end, c } );
+         sync_active_time = std::chrono::steady_clock::now();
+         boost::asio::post(c->strand, [c, start, end, head_num]() {
+            peer_ilog( p2p_blk_log, c, "requesting stripe ${s} to ${e}, head ${h}", ("s", start)("e", end)("h", head_num) );
+            c->request_sync_blocks( start, end );
+         } );
+      }
+      fc_dlog( p2p_blk_log, "sync stripes ${n}, orphaned ranges ${o}, reassembly buffer ${b}, next expected ${ne}, last requested ${lr}",
+               ("n", sync_stripes.size())("o", sync_orphaned_ranges.size())("b", sync_reassembly.size())
+               ("ne", sync_next_expected_num)("lr", sync_last_requested_num) );
+      return peer_source_available;
+   }
+
+   // call with g_sync locked; returns true if c was serving a stripe, its range is then requested from another peer
+   bool sync_manager::orphan_stripe( const connection_ptr& c ) REQUIRES(sync_mtx) {
+      auto i = std::ranges::find_if( sync_stripes, [&c](const sync_stripe& s) { return s.source == c; } );
+      if( i == sync_stripes.end() )
+         return false;
+      // request again only the gaps, blocks of the range already held in sync_reassembly are not needed
+      uint32_t gap_start = std::max( i->start, sync_next_expected_num );
+      for( auto b = sync_reassembly.lower_bound( gap_start ); gap_start <= i->end; ++b ) {
+         const bool last_gap = b == sync_reassembly.end() || b->first > i->end;
+         const uint32_t gap_end = last_gap ? i->end : b->first - 1;
+         if( gap_start <= gap_end )
+            sync_orphaned_ranges.emplace_back( gap_start, gap_end );
+         if( last_gap )
+            break;
+         gap_start = b->first + 1;
+      }
+      sync_stripes.erase( i );
+      return true;
+   }
+
+   // call with g_sync locked, from c's connection strand when c sends a block, before the block may be held in
+   // sync_reassembly. A stripe progresses when its blocks are received, not when they are dispatched, so c's sync
+   // timer is re-armed here. Only blocks within c's current stripe count, a late block of a range c was previously
+   // assigned must not complete the stripe it is serving now. Returns true if blk_num completes c's stripe.
+   bool sync_manager::sync_stripe_progress( const connection_ptr& c, uint32_t blk_num ) REQUIRES(sync_mtx) {
+      auto i = std::ranges::find_if( sync_stripes, [&c](const sync_stripe& s) { return s.source == c; } );
+      if( i == sync_stripes.end() || blk_num < i->start || blk_num > i->end )
+         return false;
+      if( blk_num == i->end ) {
+         peer_dlog(p2p_blk_log, c, "stripe complete, calling cancel_sync_wait, block ${b}", ("b", blk_num));
+         sync_stripes.erase( i );
+         c->cancel_sync_wait();
+         return true;
+      }
+      c->sync_wait();
+      return false;
+   }
+
+   // call with g_sync locked
+   void sync_manager::reset_stripes() REQUIRES(sync_mtx) {
+      sync_stripes.clear();
+      sync_orphaned_ranges.clear();
+      sync_reassembly.clear();
+   }
+
+   // call with g_sync locked; hands the contiguous run of buffered blocks starting at sync_next_expected_num to the
+   // controller. Done under the lock so that blocks released by different connections cannot be reordered.
+   void sync_manager::release_reassembled_blocks() REQUIRES(sync_mtx) {
+      for( auto i = sync_reassembly.begin(); i != sync_reassembly.end() && i->first <= sync_next_expected_num; ) {
+         if( i->first == sync_next_expected_num ) {
+            i->second.source->dispatch_block( i->second.id, std::move(i->second.block) );
+            ++sync_next_expected_num;
+         }
+         i = sync_reassembly.erase( i );
+      }
+   }
+
+   // called from c's connection strand; returns true if the block was taken by striped sync, which dispatches it in order.
+   // c's stripe progress and sync timer were already updated by sync_recv_block() when the block was received.
+   bool sync_manager::sync_reassemble_block( const connection_ptr& c, const block_id_type& blk_id, const signed_block_ptr& ptr ) {
+      if( !sync_striped || sync_state != lib_catchup )
+         return false;
+      const uint32_t blk_num = block_header::num_from_id( blk_id );
+      fc::lock_guard g( sync_mtx );
+      if( blk_num < sync_next_expected_num )
+         return false; // not part of the outstanding stripes, let the controller sort it out
+      if( blk_num > sync_last_requested_num ) {
+         peer_dlog( p2p_blk_log, c, "dropping unrequested sync block ${n}, last requested ${lr}", ("n", blk_num)("lr", sync_last_requested_num) );
+         return true;
+      }
+      sync_reassembly.insert_or_assign( blk_num, sync_pending_block{ blk_id, ptr, c } );
+      release_reassembled_blocks();
+      return true;
+   }
+
+   // called from connection strand when a sync block is received that has already been accepted
+   void sync_manager::sync_have_block( uint32_t blk_num ) {
+      if( !sync_striped || sync_state != lib_catchup )
+         return;
+      fc::lock_guard g( sync_mtx );
+      if( blk_num == sync_next_expected_num ) {
+         ++sync_next_expected_num;
+         release_reassembled_blocks();
+      }
+   }
+
    // static, thread safe
    void sync_manager::send_handshakes() {
       my_impl->connections.for_each_connection( []( const connection_ptr& ci ) {
@@ -2205,9 +2476,12 @@ namespace eosio {
          peer_dlog(p2p_blk_log, c, "requesting next chuck, set to lib_catchup and request_next_chunk, sync_state ${s}, sync_next_expected_num ${nen}",
                    ("s", stage_str(current_sync_state))("nen", sync_next_expected_num));
          set_state( lib_catchup );
+         reset_stripes();
          sync_last_requested_num = 0;
          sync_next_expected_num = chain_info.fork_db_root_num + 1;
          request_next_chunk( c );
+      } else if (sync_striped && sync_last_requested_num > 0) {
+         request_next_chunk(); // a new peer may take a stripe
       } else if (sync_last_requested_num > 0 && is_sync_request_ahead_allowed(sync_next_expected_num-1)) {
          request_next_chunk();
       } else {
@@ -2249,7 +2523,13 @@ namespace eosio {
    // called from connection strand
    void sync_manager::sync_reassign_fetch(const connection_ptr& c) {
       fc::unique_lock g( sync_mtx );
-      if( c == sync_source ) {
+      if( sync_striped ) {
+         if( orphan_stripe( c ) ) {
+            peer_ilog(p2p_blk_log, c, "reassign_fetch of stripe, next expected is ${ne}", ("ne", sync_next_expected_num));
+            c->cancel_sync();
+            request_next_chunk();
+         }
+      } else if( c == sync_source ) {
          peer_ilog(p2p_blk_log, c, "reassign_fetch, our last req is ${cc}, next expected is ${ne}",
                    ("cc", sync_last_requested_num)("ne", sync_next_expected_num));
          c->cancel_sync();
@@ -2458,6 +2738,7 @@ namespace eosio {
          // reset sync on rejected block
          fc::lock_guard g( sync_mtx );
          if (sync_last_requested_num != 0 && blk_num <= sync_next_expected_num-1) { // no need to reset if we already reset and are syncing again
+            reset_stripes();
             sync_last_requested_num = 0;
             sync_next_expected_num = my_impl->get_fork_db_root_num() + 1;
          }
@@ -2545,10 +2826,23 @@ namespace eosio {
             fc_dlog(p2p_blk_log, "All caught up ${b} with last known froot ${r} resending handshake",
                     ("b", blk_num)("r", sync_known_fork_db_root_num));
             set_state( head_catchup );
+            reset_stripes();
             g_sync.unlock();
             send_handshakes();
          } else {
-            if (!blk_applied) {
+            if (!blk_applied && sync_striped) {
+               // called as c's block is received, possibly long before it is dispatched from sync_reassembly
+               const bool stripe_done = sync_stripe_progress(c, blk_num);
+               if (sync_last_requested_num == 0) { // block was rejected
+                  sync_next_expected_num = my_impl->get_fork_db_root_num() + 1;
+                  peer_dlog(p2p_blk_log, c, "Reset sync_next_expected_num to ${n}", ("n", sync_next_expected_num));
+                  request_next_chunk();
+               } else if (blk_num >= sync_known_fork_db_root_num) {
+                  send_handshakes_when_synced = true;
+               } else if (stripe_done) {
+                  request_next_chunk();
+               }
+            } else if (!blk_applied) {
                if (blk_num >= c->sync_last_requested_block) {
                   peer_dlog(p2p_blk_log, c, "calling cancel_sync_wait, block ${b}, sync_last_requested_block ${lrb}",
                             ("b", blk_num)("lrb", c->sync_last_requested_block));
@@ -2589,7 +2883,11 @@ namespace eosio {
                   // Use last received number instead so when end of range is reached we check the IRREVERSIBLE conditions below.
                   blk_num = sync_next_expected_num-1;
                }
-               if (is_sync_request_ahead_allowed(blk_num)) {
+               if (sync_striped) {
+                  // applying blocks makes room for further stripes
+                  if (sync_last_requested_num > 0)
+                     request_next_stripes();
+               } else if (is_sync_request_ahead_allowed(blk_num)) {
                   fc_dlog(p2p_blk_log, "Requesting blocks, head: ${h} fhead ${fh} blk_num: ${bn} sync_next_expected_num ${nen} "
                                        "sync_last_requested_num: ${lrn}",
                           ("h", my_impl->get_chain_head_num())("fh", my_impl->get_fork_db_head_num())
@@ -2619,70 +2917,25 @@ namespace eosio {
    // thread safe
 
    bool dispatch_manager::add_peer_block( const block_id_type& blkid, connection_id_t connection_id) {
-      block_num_type block_num = block_header::num_from_id(blkid);
-      fc::lock_guard g( blk_state_mtx );
-      auto bptr = blk_state.get<by_connection_id>().find( std::forward_as_tuple(block_num, blkid, connection_id) );
-      bool added = (bptr == blk_state.end());
-      if( added ) {
-         blk_state.insert( {blkid, connection_id} );
-      }
-      return added;
+      return blk_state.add_peer_block( blkid, connection_id );
    }
 
    bool dispatch_manager::peer_has_block( const block_id_type& blkid, connection_id_t connection_id ) const {
-      block_num_type block_num = block_header::num_from_id(blkid);
-      fc::lock_guard g(blk_state_mtx);
-      const auto blk_itr = blk_state.get<by_connection_id>().find( std::forward_as_tuple(block_num, blkid, connection_id) );
-      return blk_itr != blk_state.end();
+      return blk_state.peer_has_block( blkid, connection_id );
    }
 
    bool dispatch_manager::have_block( const block_id_type& blkid ) const {
-      block_num_type block_num = block_header::num_from_id(blkid);
-      fc::lock_guard g(blk_state_mtx);
-      const auto& index = blk_state.get<by_connection_id>();
-      auto blk_itr = index.find( std::forward_as_tuple(block_num, blkid) );
-      return blk_itr != index.end();
+      return blk_state.have_block( blkid );
    }
 
    void dispatch_manager::rm_block( const block_id_type& blkid ) {
-      block_num_type block_num = block_header::num_from_id(blkid);
-      fc_dlog( p2p_blk_log, "rm_block ${n}, id: ${id}", ("n", block_num)("id", blkid));
-      fc::lock_guard g(blk_state_mtx);
-      auto& index = blk_state.get<by_connection_id>();
-      auto p = index.equal_range( std::forward_as_tuple(block_num, blkid) );
-      index.erase(p.first, p.second);
+      fc_dlog( p2p_blk_log, "rm_block ${n}, id: ${id}", ("n", block_header::num_from_id(blkid))("id", blkid));
+      blk_state.rm_block( blkid );
    }
 
-   dispatch_manager::add_peer_txn_info dispatch_manager::add_peer_txn( const transaction_id_type& id, const time_point_sec& trx_expires, connection& c )
-   {
-      fc::lock_guard g( local_txns_mtx );
-
-      auto& id_idx = local_txns.get<by_id>();
-      bool already_have_trx = false;
-      if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
-         if (tptr->connection_ids.insert(c.connection_id).second)
-            c.trx_entries_size += connection::trx_conn_entry_size;
-         already_have_trx = tptr->have_trx;
-         if (!already_have_trx) {
-            time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
-            expires = std::min( trx_expires, expires );
-            local_txns.modify(tptr, [&](auto& v) {
-               v.expires = expires;
-               v.have_trx = true;
-            });
-         }
-      } else {
-         // expire at either transaction expiration or configured max expire time whichever is less
-         time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
-         expires = std::min( trx_expires, expires );
-         local_txns.insert( node_transaction_state{
-            .id = id,
-            .expires = expires,
-            .connection_ids = {c.connection_id},
-            .have_trx = true } );
-         c.trx_entries_size += connection::trx_full_entry_size;
-      }
-
+   // called from connection strand of c
+   void dispatch_manager::add_trx_entries_size( connection& c, uint32_t entries_size ) {
+      c.trx_entries_size += entries_size;
       if (c.trx_entries_size > def_max_trx_entries_per_conn_size) {
          auto now = fc::time_point::now();
          if (now - c.trx_entries_reset > my_impl->p2p_dedup_cache_expire_time_us) {
@@ -2690,67 +2943,91 @@ namespace eosio {
             c.trx_entries_reset = now;
          }
       }
-      return {c.trx_entries_size, already_have_trx};
    }
 
-   size_t dispatch_manager::add_peer_txn_notice( const transaction_id_type& id, connection& c )
+   dispatch_manager::add_peer_txn_info dispatch_manager::add_peer_txn( const transaction_id_type& id, const time_point_sec& trx_expires, connection& c )
    {
-      fc::lock_guard g( local_txns_mtx );
+      // expire at either transaction expiration or configured max expire time whichever is less
+      time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
+      expires = std::min( trx_expires, expires );
 
-      auto& id_idx = local_txns.get<by_id>();
-      if (auto tptr = id_idx.find( id ); tptr != id_idx.end()) {
-         if (tptr->connection_ids.insert(c.connection_id).second)
-            c.trx_entries_size += connection::trx_conn_entry_size;
-      } else {
-         time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
-         local_txns.insert( node_transaction_state{
-            .id = id,
-            .expires = expires,
-            .connection_ids = {c.connection_id},
-            .have_trx = false } );
-         c.trx_entries_size += connection::trx_full_entry_size;
-      }
+      const auto result = local_txns.add_peer_txn( id, expires, c.connection_id );
+      add_trx_entries_size( c, result.entries_size );
+      return {c.trx_entries_size, result.have_trx};
+   }
 
-      if (c.trx_entries_size > def_max_trx_entries_per_conn_size) {
-         auto now = fc::time_point::now();
-         if (now - c.trx_entries_reset > my_impl->p2p_dedup_cache_expire_time_us) {
-            c.trx_entries_size = 0;
-            c.trx_entries_reset = now;
-         }
-      }
+   size_t dispatch_manager::add_peer_txn_notice( const transaction_id_type& id, connection& c )
+   {
+      const time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
+
+      add_trx_entries_size( c, local_txns.add_peer_txn_notice( id, expires, c.connection_id ) );
       return c.trx_entries_size;
    }
 
-   connection_id_set dispatch_manager::peer_connections(const transaction_id_type& id) const {
-      fc::lock_guard g( local_txns_mtx );
-      auto& id_idx = local_txns.get<by_id>();
-      if (auto tptr = id_idx.find(id); tptr != id_idx.end()) {
-         return tptr->connection_ids;
-      }
-      return {};
+   std::vector<transaction_id_type> dispatch_manager::add_peer_txn_announce( const std::vector<transaction_id_type>& ids, connection& c )
+   {
+      const auto now = fc::time_point::now();
+      const time_point_sec expires{now + my_impl->p2p_dedup_cache_expire_time_us};
+
+      auto result = local_txns.add_peer_txn_announce( ids, expires, c.connection_id, now );
+      add_trx_entries_size( c, result.entries_size );
+      return std::move(result.unseen);
+   }
+
+   bool dispatch_manager::reassign_txn_requests( connection_id_t connection_id, const fc::time_point& requested_before ) {
+      auto result = local_txns.reassign_txn_requests( connection_id, requested_before, fc::time_point::now() );
+      if( result.requests.empty() )
+         return result.pending;
+
+      fc_dlog( p2p_trx_log, "reassigning requested trxs of connection - ${cid} to ${n} connections",
+               ("cid", connection_id)("n", result.requests.size()) );
+      my_impl->connections.for_each_connection( [&]( const connection_ptr& cp ) {
+         auto i = result.requests.find( cp->connection_id );
+         if( i == result.requests.end() )
+            return;
+         // a closed connection reassigns its requests when closing
+         boost::asio::post( cp->strand, [cp, ids = std::move(i->second)]() {
+            for( size_t b = 0; b < ids.size(); b += def_max_trx_announce_ids ) {
+               const auto e = std::min( ids.size(), b + def_max_trx_announce_ids );
+               peer_dlog( p2p_trx_log, cp, "requesting ${n} trxs announced by another peer", ("n", e - b) );
+               cp->enqueue( net_message( transaction_request_message{ .ids = std::vector<transaction_id_type>( ids.begin() + b, ids.begin() + e ) } ) );
+            }
+            cp->start_trx_request_timer();
+         } );
+      } );
+      return result.pending;
+   }
+
+   void dispatch_manager::add_txns_announced( const std::vector<transaction_id_type>& ids, connection_id_t connection_id ) {
+      local_txns.add_txns_announced( ids, connection_id );
+   }
+
+   packed_transaction_ptr dispatch_manager::get_announced_txn( const transaction_id_type& id, connection_id_t connection_id ) {
+      return local_txns.get_announced_txn( id, connection_id );
+   }
+
+   connection_id_set dispatch_manager::add_local_txn(const packed_transaction_ptr& trx) {
+      time_point_sec expires{fc::time_point::now() + my_impl->p2p_dedup_cache_expire_time_us};
+      expires = std::min( trx->expiration(), expires );
+
+      return local_txns.add_local_txn( trx, expires );
+   }
+
+   packed_transaction_ptr dispatch_manager::get_txn(const transaction_id_type& id) const {
+      return local_txns.get_txn( id );
    }
 
    void dispatch_manager::expire_txns() {
       fc::time_point now = time_point::now();
 
-      size_t start_size = 0, end_size = 0;
-      {
-         fc::lock_guard g( local_txns_mtx );
-         start_size = local_txns.size();
-         auto& old = local_txns.get<by_expiry>();
-         auto ex_lo = old.lower_bound( fc::time_point_sec( 0 ) );
-         auto ex_up = old.upper_bound( fc::time_point_sec{now - def_allowed_clock_skew} ); // allow for some clock-skew
-         old.erase( ex_lo, ex_up );
-         end_size = local_txns.size();
-      }
+      const fc::time_point_sec expire_upto{now - def_allowed_clock_skew}; // allow for some clock-skew
+      const size_t removed = local_txns.expire_txns( expire_upto );
 
-      fc_dlog( p2p_trx_log, "expire_local_txns size ${s} removed ${r} in ${t}us", ("s", start_size)("r", start_size - end_size)("t", fc::time_point::now() - now) );
+      fc_dlog( p2p_trx_log, "expire_local_txns size ${s} removed ${r} in ${t}us", ("s", local_txns.size())("r", removed)("t", fc::time_point::now() - now) );
    }
 
    void dispatch_manager::expire_blocks( uint32_t fork_db_root_num ) {
-      fc::lock_guard g( blk_state_mtx );
-      auto& stale_blk = blk_state.get<by_connection_id>();
-      stale_blk.erase( stale_blk.lower_bound( 1 ), stale_blk.upper_bound( fork_db_root_num ) );
+      blk_state.expire_blocks( fork_db_root_num );
    }
 
    // thread safe
@@ -2760,9 +3037,11 @@ namespace eosio {
       if(my_impl->sync_master->syncing_from_peer() ) return;
 
       block_buffer_factory buff_factory;
+      block_buffer_factory compressed_buff_factory; // only one codec is supported
+      compact_block_buffer_factory compact_buff_factory;
       buffer_factory block_notice_buff_factory;
       const auto bnum = b->block_num();
-      my_impl->connections.for_each_block_connection( [this, &id, &bnum, &b, &buff_factory, &block_notice_buff_factory]( auto& cp ) {
+      my_impl->connections.for_each_block_connection( [&, this]( auto& cp ) {
          fc_dlog( p2p_blk_log, "socket_is_open ${s}, state ${c}, syncing ${ss}, connection - ${cid}",
                   ("s", cp->socket_is_open())("c", connection::state_str(cp->state()))("ss", cp->peer_syncing_from_us.load())("cid", cp->connection_id) );
          if( !cp->current() ) return;
@@ -2787,14 +3066,20 @@ namespace eosio {
             }
          }
 
-         const send_buffer_type& sb = buff_factory.get_send_buffer( b );
+         // compact blocks are sent even without transactions so blocks from a peer are reconstructed in order
+         const bool compact = my_impl->p2p_compact_block_relay && cp->protocol_version >= proto_version_t::compact_block;
+         const compression_codec codec = cp->send_compression();
+         const send_buffer_type& sb = compact                          ? compact_buff_factory.get_send_buffer( b )
+                                    : codec == compression_codec::none ? buff_factory.get_send_buffer( b )
+                                                                       : compressed_buff_factory.get_send_buffer( b, codec );
+         const msg_type_t msg_type = compact ? msg_type_t::compact_block_message : msg_type_t::signed_block;
 
-         boost::asio::post(cp->strand, [cp, bnum, sb]() {
+         boost::asio::post(cp->strand, [cp, bnum, sb, msg_type]() {
             cp->latest_blk_time = std::chrono::steady_clock::now();
             bool has_block = cp->peer_fork_db_root_num >= bnum;
             if( !has_block ) {
                peer_dlog( p2p_blk_log, cp, "bcast block ${b}", ("b", bnum) );
-               cp->enqueue_buffer( msg_type_t::signed_block, bnum, queued_buffer::queue_t::general, sb, go_away_reason::no_reason );
+               cp->enqueue_buffer( msg_type, bnum, queued_buffer::queue_t::general, sb, go_away_reason::no_reason );
             }
          });
       } );
@@ -2816,18 +3101,27 @@ namespace eosio {
    // called from any thread
    void dispatch_manager::bcast_transaction(const packed_transaction_ptr& trx) {
       trx_buffer_factory buff_factory;
-      std::optional<connection_id_set> trx_connections;
+      trx_buffer_factory compressed_buff_factory; // only one codec is supported
+      const connection_id_set trx_connections = add_local_txn(trx);
       my_impl->connections.for_each_connection( [&]( const connection_ptr& cp ) {
          if( !cp->is_transactions_connection() || !cp->current() ) {
             return;
          }
-         if (!trx_connections)
-            trx_connections = peer_connections(trx->id());
-         if( trx_connections->contains(cp->connection_id) ) {
+         if( trx_connections.contains(cp->connection_id) ) {
+            return;
+         }
+
+         if( cp->trx_announce_connection() ) {
+            fc_dlog( p2p_trx_log, "announcing trx: ${id}, to connection - ${cid}", ("id", trx->id())("cid", cp->connection_id) );
+            boost::asio::post(cp->strand, [cp, id = trx->id()]() {
+               cp->announce_transaction( id );
+            } );
             return;
          }
 
-         const send_buffer_type& sb = buff_factory.get_send_buffer( trx );
+         const compression_codec codec = cp->send_compression();
+         const send_buffer_type& sb = codec == compression_codec::none ? buff_factory.get_send_buffer( trx )
+                                                                       : compressed_buff_factory.get_send_buffer( trx, codec );
          fc_dlog( p2p_trx_log, "sending trx: ${id}, to connection - ${cid}, size ${s}", ("id", trx->id())("cid", cp->connection_id)("s", sb->size()) );
          boost::asio::post(cp->strand, [cp, sb]() {
             cp->enqueue_buffer( msg_type_t::packed_transaction, std::nullopt, queued_buffer::queue_t::general, sb, go_away_reason::no_reason );
@@ -3119,9 +3413,11 @@ namespace eosio {
 
          if( net_msg == msg_type_t::signed_block ) {
             latest_blk_time = now;
-            return process_next_block_message( message_length );
+            return process_next_block_message( pending_message_buffer, message_length );
          } else if( net_msg == msg_type_t::packed_transaction ) {
-            return process_next_trx_message( message_length );
+            return process_next_trx_message( pending_message_buffer, message_length );
+         } else if( net_msg == msg_type_t::compressed_message ) {
+            return process_next_compressed_message( message_length );
          } else if( net_msg == msg_type_t::transaction_notice_message ) {
             return process_next_trx_notice_message( message_length );
          } else if( net_msg == msg_type_t::vote_message ) {
@@ -3143,8 +3439,43 @@ namespace eosio {
    }
 
    // called from connection strand
-   bool connection::process_next_block_message(uint32_t message_length) {
-      auto peek_ds = pending_message_buffer.create_peek_datastream();
+   bool connection::process_next_compressed_message(uint32_t message_length) {
+      auto ds = pending_message_buffer.create_datastream();
+      unsigned_int which{};
+      fc::raw::unpack( ds, which );
+      compressed_message cm;
+      fc::raw::unpack( ds, cm );
+
+      const auto codec = static_cast<compression_codec>(cm.codec);
+      if( codec == compression_codec::none || codec != my_impl->p2p_compression ) {
+         peer_wlog( p2p_msg_log, this, "received compressed_message with codec ${c} not accepted, closing", ("c", cm.codec) );
+         close();
+         return false;
+      }
+
+      serialized_message_buffer buffer( decompress_message( codec, cm.data, max_decompressed_message_size ) );
+      auto peek_ds = buffer.create_peek_datastream();
+      fc::raw::unpack( peek_ds, which );
+      const uint32_t decompressed_length = buffer.size();
+      peer_dlog( p2p_msg_log, this, "received compressed_message ${s} bytes, decompressed ${d} bytes",
+                 ("s", message_length)("d", decompressed_length) );
+
+      msg_type_t net_msg = to_msg_type_t(which.value);
+      if( net_msg == msg_type_t::signed_block ) {
+         latest_blk_time = std::chrono::steady_clock::now();
+         return process_next_block_message( buffer, decompressed_length );
+      } else if( net_msg == msg_type_t::packed_transaction ) {
+         return process_next_trx_message( buffer, decompressed_length );
+      }
+      peer_wlog( p2p_msg_log, this, "received compressed_message of unexpected type ${t}, closing", ("t", which.value) );
+      close();
+      return false;
+   }
+
+   // called from connection strand
+   template <typename MessageBuffer>
+   bool connection::process_next_block_message(MessageBuffer& buffer, uint32_t message_length) {
+      auto peek_ds = buffer.create_peek_datastream();
       unsigned_int which{};
       fc::raw::unpack( peek_ds, which ); // throw away
       block_header bh;
@@ -3155,7 +3486,7 @@ namespace eosio {
       my_impl->last_block_received_time = last_received_block_time = now;
       const fc::microseconds age(now - bh.timestamp);
       if( my_impl->dispatcher.have_block( blk_id ) ) {
-         pending_message_buffer.advance_read_ptr( message_length ); // advance before any send
+         buffer.advance_read_ptr( message_length ); // advance before any send
 
          // if we have the block then it has been header validated, add for this connection_id
          my_impl->dispatcher.add_peer_block(blk_id, connection_id);
@@ -3164,6 +3495,7 @@ namespace eosio {
          peer_dlog( p2p_blk_log, this, "already received block ${num}, id ${id}..., latency ${l}ms",
                     ("num", blk_num)("id", blk_id.str().substr(8,16))("l", age.count()/1000) );
          my_impl->sync_master->sync_recv_block( shared_from_this(), blk_id, blk_num, age );
+         my_impl->sync_master->sync_have_block( blk_num );
 
          return true;
       }
@@ -3173,7 +3505,7 @@ namespace eosio {
       if( !my_impl->sync_master->syncing_from_peer() ) { // guard against peer thinking it needs to send us old blocks
          block_num_type fork_db_root_num = my_impl->get_fork_db_root_num();
          if( blk_num <= fork_db_root_num ) {
-            pending_message_buffer.advance_read_ptr( message_length ); // advance before any send
+            buffer.advance_read_ptr( message_length ); // advance before any send
             peer_dlog( p2p_blk_log, this, "received block ${n} less than froot ${fr}", ("n", blk_num)("fr", fork_db_root_num) );
             send_block_nack(blk_id);
             cancel_sync_wait();
@@ -3186,14 +3518,14 @@ namespace eosio {
          const bool block_le_lib = blk_num <= fork_db_root_num;
          if (block_le_lib) {
             peer_dlog( p2p_blk_log, this, "received block ${n} less than froot ${fr} while syncing", ("n", blk_num)("fr", fork_db_root_num) );
-            pending_message_buffer.advance_read_ptr( message_length ); // advance before any send
+            buffer.advance_read_ptr( message_length ); // advance before any send
          }
          my_impl->sync_master->sync_recv_block(shared_from_this(), blk_id, blk_num, age);
          if (block_le_lib)
             return true;
       }
 
-      auto mb_ds = pending_message_buffer.create_datastream();
+      auto mb_ds = buffer.create_datastream();
       fc::raw::unpack( mb_ds, which );
 
       fc::datastream_mirror ds(mb_ds, message_length);
@@ -3220,22 +3552,23 @@ namespace eosio {
    }
 
    // called from connection strand
-   bool connection::process_next_trx_message(uint32_t message_length) {
+   template <typename MessageBuffer>
+   bool connection::process_next_trx_message(MessageBuffer& buffer, uint32_t message_length) {
       if( !my_impl->p2p_accept_transactions ) {
          peer_dlog( p2p_trx_log, this, "p2p-accept-transaction=false - dropping trx" );
-         pending_message_buffer.advance_read_ptr( message_length );
+         buffer.advance_read_ptr( message_length );
          return true;
       }
       if (my_impl->sync_master->syncing_from_peer()) {
          peer_dlog(p2p_trx_log, this, "syncing, dropping trx");
-         pending_message_buffer.advance_read_ptr( message_length );
+         buffer.advance_read_ptr( message_length );
          return true;
       }
 
       const uint32_t trx_in_progress_sz = this->trx_in_progress_size.load();
 
       auto now = fc::time_point::now();
-      auto ds = pending_message_buffer.create_datastream();
+      auto ds = buffer.create_datastream();
       unsigned_int which{};
       fc::raw::unpack( ds, which );
       // shared_ptr<packed_transaction> needed here because packed_transaction_ptr is shared_ptr<const packed_transaction>
@@ -3590,6 +3923,8 @@ namespace eosio {
          }
 
          send_gossip_bp_peers_initial_message();
+         send_compression_message();
+         send_trx_announce_support();
       }
 
       uint32_t nblk_combined_latency = calc_block_latency();
@@ -3983,6 +4318,255 @@ namespace eosio {
    }
 
    // called from connection strand
+   void connection::send_compression_message() {
+      if (protocol_version < proto_version_t::compression || my_impl->p2p_compression == compression_codec::none)
+         return;
+      peer_dlog(p2p_msg_log, this, "sending compression_message ${c}", ("c", static_cast<uint8_t>(my_impl->p2p_compression)));
+      enqueue(compression_message{ .codec = static_cast<uint8_t>(my_impl->p2p_compression) });
+   }
+
+   // called from connection strand
+   void connection::handle_message( const compression_message& msg ) {
+      const auto codec = static_cast<compression_codec>(msg.codec);
+      if (codec != compression_codec::none && codec != compression_codec::zlib) {
+         peer_wlog(p2p_msg_log, this, "peer accepts unknown compression codec ${c}, sending uncompressed", ("c", msg.codec));
+         peer_compression = compression_codec::none;
+         return;
+      }
+      peer_compression = codec;
+   }
+
+   // called from connection strand
+   void connection::handle_message( const compact_block_message& msg ) {
+      const block_id_type blk_id = msg.header.calculate_id();
+      const uint32_t blk_num = block_header::num_from_id(blk_id);
+      if( my_impl->dispatcher.have_block( blk_id ) ) {
+         my_impl->dispatcher.add_peer_block( blk_id, connection_id );
+         send_block_nack( blk_id );
+         peer_dlog( p2p_blk_log, this, "already received compact block ${num}, id ${id}...", ("num", blk_num)("id", blk_id.str().substr(8,16)) );
+         return;
+      }
+      if( my_impl->sync_master->syncing_from_peer() ) {
+         peer_dlog( p2p_blk_log, this, "syncing, dropping compact block ${num}", ("num", blk_num) );
+         return;
+      }
+      if( pending_compact_blocks.size() >= def_max_pending_compact_blocks ) {
+         peer_wlog( p2p_blk_log, this, "${s} compact blocks waiting on transactions, closing", ("s", pending_compact_blocks.size()) );
+         close();
+         return;
+      }
+
+      pending_compact_block pending;
+      const auto status = pending.init( blk_id, msg, [&]( const transaction_id_type& id ) {
+         return my_impl->dispatcher.get_txn( id );
+      } );
+      if( status == pending_compact_block::status::invalid ) {
+         peer_wlog( p2p_blk_log, this, "invalid compact block ${num}, closing", ("num", blk_num) );
+         close();
+         return;
+      }
+      peer_dlog( p2p_blk_log, this, "received compact block ${num}, id ${id}..., trxs ${t}, missing ${m}, all ${a}",
+                 ("num", blk_num)("id", blk_id.str().substr(8,16))("t", pending.packed_trx_indexes.size())
+                 ("m", pending.missing.size())("a", pending.all_requested) );
+
+      if( status == pending_compact_block::status::missing )
+         request_block_transactions( pending );
+      pending_compact_blocks.push_back( std::move(pending) );
+      process_ready_compact_blocks();
+   }
+
+   // called from connection strand
+   void connection::request_block_transactions( const pending_compact_block& pending ) {
+      peer_dlog( p2p_blk_log, this, "requesting ${n} transactions of compact block ${num}",
+                 ("n", pending.missing.size())("num", block_header::num_from_id(pending.id)) );
+      enqueue( block_transactions_request_message{ .id = pending.id, .indexes = pending.missing } );
+   }
+
+   // called from connection strand
+   void connection::process_ready_compact_blocks() {
+      while( !pending_compact_blocks.empty() && pending_compact_blocks.front().missing.empty() ) {
+         pending_compact_block pending = std::move( pending_compact_blocks.front() );
+         pending_compact_blocks.pop_front();
+
+         // process the reconstructed block the same as a signed_block message received from the peer
+         const unsigned_int which = to_index(msg_type_t::signed_block);
+         std::vector<char> msg( fc::raw::pack_size( which ) + fc::raw::pack_size( *pending.block ) );
+         fc::datastream<char*> ds( msg.data(), msg.size() );
+         fc::raw::pack( ds, which );
+         fc::raw::pack( ds, *pending.block );
+
+         serialized_message_buffer buffer( std::move(msg) );
+         if( !process_next_block_message( buffer, buffer.size() ) )
+            return;
+      }
+   }
+
+   // called from connection strand
+   void connection::handle_message( const block_transactions_request_message& msg ) {
+      signed_block_ptr b = my_impl->chain_plug->chain().fetch_block_by_id( msg.id ); // thread-safe
+      block_transactions_message reply{ .id = msg.id };
+      if( b ) {
+         reply.trxs.reserve( msg.indexes.size() );
+         for( uint32_t i : msg.indexes ) {
+            if( i >= b->transactions.size() || !std::holds_alternative<packed_transaction>( b->transactions[i].trx ) ) {
+               peer_wlog( p2p_blk_log, this, "invalid block_transactions_request_message for block ${num}, transaction ${i}, closing",
+                          ("num", b->block_num())("i", i) );
+               close();
+               return;
+            }
+            reply.trxs.push_back( std::get<packed_transaction>( b->transactions[i].trx ) );
+         }
+      }
+      // an empty reply tells the peer the block is no longer available
+      enqueue( net_message( std::move(reply) ) );
+   }
+
+   // called from connection strand
+   void connection::handle_message( const block_transactions_message& msg ) {
+      const uint32_t blk_num = block_header::num_from_id( msg.id );
+      auto pending = std::ranges::find_if( pending_compact_blocks, [&]( const pending_compact_block& p ) {
+         return p.id == msg.id && !p.missing.empty();
+      } );
+      if( pending == pending_compact_blocks.end() ) {
+         peer_dlog( p2p_blk_log, this, "block_transactions_message for block ${num} not requested", ("num", blk_num) );
+         return;
+      }
+      if( msg.trxs.empty() ) {
+         peer_dlog( p2p_blk_log, this, "compact block ${num} no longer available from peer, dropping", ("num", blk_num) );
+         pending_compact_blocks.erase( pending );
+         process_ready_compact_blocks();
+         return;
+      }
+
+      const size_t requested = pending->missing.size();
+      const auto status = pending->add_transactions( msg.trxs );
+      if( status == pending_compact_block::status::invalid ) {
+         peer_wlog( p2p_blk_log, this, "block_transactions_message for block ${num} has ${n} transactions, requested ${r}, "
+                    "not matching its merkle root, closing", ("num", blk_num)("n", msg.trxs.size())("r", requested) );
+         close();
+         return;
+      }
+      if( status == pending_compact_block::status::missing ) {
+         peer_dlog( p2p_blk_log, this, "compact block ${num} merkle root mismatch, requesting all transactions", ("num", blk_num) );
+         request_block_transactions( *pending );
+         return;
+      }
+      process_ready_compact_blocks();
+   }
+
+   // called from connection strand
+   void connection::announce_transaction( const transaction_id_type& id ) {
+      trx_announce_batch.push_back( id );
+      if( trx_announce_batch.size() >= def_max_trx_announce_ids ) {
+         send_trx_announce_batch();
+      } else if( trx_announce_batch.size() == 1 ) {
+         // first id of the batch starts the window, ids announced within it go out in one message
+         trx_announce_timer.expires_from_now( my_impl->p2p_trx_announce_window );
+         trx_announce_timer.async_wait( boost::asio::bind_executor( strand, [c = shared_from_this()]( boost::system::error_code ec ) {
+            if( !ec ) {
+               c->send_trx_announce_batch();
+            }
+         } ) );
+      }
+   }
+
+   // called from connection strand
+   void connection::send_trx_announce_batch() {
+      if( trx_announce_batch.empty() || closed() )
+         return;
+      trx_announce_timer.cancel();
+      // the peer may request each announced trx once
+      my_impl->dispatcher.add_txns_announced( trx_announce_batch, connection_id );
+      peer_dlog( p2p_trx_log, this, "sending transaction_announce_message, trxs ${n}", ("n", trx_announce_batch.size()) );
+      enqueue( net_message( transaction_announce_message{ .ids = std::move(trx_announce_batch) } ) );
+      trx_announce_batch.clear();
+   }
+
+   // called from connection strand
+   void connection::send_trx_announce_support() {
+      if( protocol_version < proto_version_t::trx_announce || !my_impl->p2p_trx_announce )
+         return;
+      // an empty announce tells the peer to announce its transactions to us
+      peer_dlog( p2p_trx_log, this, "sending empty transaction_announce_message" );
+      enqueue( net_message( transaction_announce_message{} ) );
+   }
+
+   // called from connection strand
+   void connection::start_trx_request_timer() {
+      if( trx_request_timer_active || closed() )
+         return;
+      trx_request_timer_active = true;
+      trx_request_timer.expires_from_now( def_trx_request_timeout );
+      trx_request_timer.async_wait( boost::asio::bind_executor( strand, [c = shared_from_this()]( boost::system::error_code ec ) {
+         if( ec || !c->trx_request_timer_active )
+            return;
+         c->trx_request_timer_active = false;
+         const auto requested_before = fc::time_point::now() - fc::microseconds(
+            std::chrono::duration_cast<std::chrono::microseconds>( def_trx_request_timeout ).count() );
+         if( my_impl->dispatcher.reassign_txn_requests( c->connection_id, requested_before ) )
+            c->start_trx_request_timer();
+      } ) );
+   }
+
+   // called from connection strand
+   void connection::handle_message( const transaction_announce_message& msg ) {
+      peer_trx_announce = true;
+      if( msg.ids.empty() )
+         return;
+      if( !my_impl->p2p_accept_transactions ) {
+         peer_dlog( p2p_trx_log, this, "p2p-accept-transaction=false - dropping trx announce" );
+         return;
+      }
+      if( my_impl->sync_master->syncing_from_peer() ) {
+         peer_dlog( p2p_trx_log, this, "syncing, dropping trx announce" );
+         return;
+      }
+      if( msg.ids.size() > def_max_trx_announce_ids ) {
+         peer_wlog( p2p_trx_log, this, "transaction_announce_message of ${n} trxs exceeds max ${m}, closing",
+                    ("n", msg.ids.size())("m", def_max_trx_announce_ids) );
+         close();
+         return;
+      }
+
+      std::vector<transaction_id_type> unseen = my_impl->dispatcher.add_peer_txn_announce( msg.ids, *this );
+      if( trx_entries_size > def_max_trx_entries_per_conn_size ) {
+         peer_wlog( p2p_conn_log, this, "Max tracked trx reached ${c}, closing", ("c", trx_entries_size) );
+         close();
+         return;
+      }
+      if( unseen.empty() )
+         return;
+
+      peer_dlog( p2p_trx_log, this, "requesting ${r} of ${n} announced trxs", ("r", unseen.size())("n", msg.ids.size()) );
+      enqueue( net_message( transaction_request_message{ .ids = std::move(unseen) } ) );
+      start_trx_request_timer();
+   }
+
+   // called from connection strand
+   void connection::handle_message( const transaction_request_message& msg ) {
+      if( msg.ids.size() > def_max_trx_announce_ids ) {
+         peer_wlog( p2p_trx_log, this, "transaction_request_message of ${n} trxs exceeds max ${m}, closing",
+                    ("n", msg.ids.size())("m", def_max_trx_announce_ids) );
+         close();
+         return;
+      }
+
+      const compression_codec codec = send_compression();
+      for( const auto& id : msg.ids ) {
+         // only trxs announced to the peer are sent, each at most once. Trxs expired from the dispatcher cache are
+         // skipped, when its request times out the peer requests them from another peer that announced them, if any.
+         packed_transaction_ptr trx = my_impl->dispatcher.get_announced_txn( id, connection_id );
+         if( !trx ) {
+            peer_dlog( p2p_trx_log, this, "requested trx ${id} not announced, already sent or expired", ("id", id) );
+            continue;
+         }
+         trx_buffer_factory buff_factory;
+         const send_buffer_type& sb = codec == compression_codec::none ? buff_factory.get_send_buffer( trx )
+                                                                       : buff_factory.get_send_buffer( trx, codec );
+         enqueue_buffer( msg_type_t::packed_transaction, std::nullopt, queued_buffer::queue_t::general, sb, go_away_reason::no_reason );
+      }
+   }
+
    void connection::send_gossip_bp_peers_initial_message() {
       if (protocol_version < proto_version_t::gossip_bp_peers || !my_impl->bp_gossip_enabled())
          return;
@@ -4054,6 +4638,14 @@ namespace eosio {
 
    // called from connection strand
    void connection::handle_message( const block_id_type& id, signed_block_ptr ptr ) {
+      // striped sync holds blocks received ahead of order and dispatches them once their predecessors arrive
+      if( my_impl->sync_master->sync_reassemble_block( shared_from_this(), id, ptr ) )
+         return;
+      dispatch_block( id, std::move(ptr) );
+   }
+
+   // thread safe
+   void connection::dispatch_block( const block_id_type& id, signed_block_ptr ptr ) {
       // post to dispatcher strand so that we don't have multiple threads validating the block header
       peer_dlog(p2p_blk_log, this, "posting block ${n} to dispatcher strand", ("n", ptr->block_num()));
       my_impl->dispatcher.strand.dispatch([id, c{shared_from_this()}, ptr{std::move(ptr)}, cid=connection_id]() mutable {
@@ -4484,6 +5076,17 @@ namespace eosio {
          ( "p2p-accept-transactions", bpo::value<bool>()->default_value(true), "Allow transactions received over p2p network to be evaluated and relayed if valid.")
          ( "p2p-disable-block-nack", bpo::value<bool>()->default_value(false),
             "Disable block notice and block nack. All blocks received will be broadcast to all peers unless already received.")
+         ( "p2p-compact-block-relay", bpo::value<bool>()->default_value(false),
+            "Broadcast blocks to peers that support it as compact blocks of transaction ids. "
+            "Peers reconstruct the blocks from transactions they already have and request only the missing ones.")
+         ( "p2p-trx-announce", bpo::value<bool>()->default_value(false),
+            "Announce transactions by id in batches instead of sending them to peers that also enable p2p-trx-announce. "
+            "Peers request only the transactions they have not already received.")
+         ( "p2p-trx-announce-window-ms", bpo::value<uint32_t>()->default_value(def_trx_announce_window_ms),
+            "Time in milliseconds transaction ids are batched for before being announced to a peer.")
+         ( "p2p-compression", bpo::value<bool>()->default_value(false),
+            "Send blocks and transactions zlib compressed to peers that also enable p2p-compression. "
+            "Each block or transaction is compressed once for all such peers.")
          ( "p2p-auto-bp-peer", bpo::value< vector<string> >()->composing(),
            "The account and public p2p endpoint of a block producer node to automatically connect to when it is in producer schedule. Not gossipped.\n"
            "  Syntax: bp_account,host:port\n"
@@ -4517,6 +5120,9 @@ namespace eosio {
            "Number of blocks to retrieve in a chunk from any individual peer during synchronization")
          ( "sync-peer-limit", bpo::value<uint32_t>()->default_value(3),
            "Number of peers to sync from")
+         ( "sync-striped", bpo::value<bool>()->default_value(false),
+           "Request disjoint sync-fetch-span ranges from up to sync-peer-limit peers concurrently during synchronization, "
+           "instead of one range from one peer at a time")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable experimental socket read watermark optimization")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_peer}\" - ${_cid} ${_ip}:${_port}] " ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
@@ -4557,6 +5163,10 @@ namespace eosio {
          max_nodes_per_host = options.at( "p2p-max-nodes-per-host" ).as<int>();
          p2p_accept_transactions = options.at( "p2p-accept-transactions" ).as<bool>();
          p2p_disable_block_nack = options.at( "p2p-disable-block-nack" ).as<bool>();
+         p2p_compression = options.at( "p2p-compression" ).as<bool>() ? compression_codec::zlib : compression_codec::none;
+         p2p_compact_block_relay = options.at( "p2p-compact-block-relay" ).as<bool>();
+         p2p_trx_announce = options.at( "p2p-trx-announce" ).as<bool>();
+         p2p_trx_announce_window = std::chrono::milliseconds( options.at( "p2p-trx-announce-window-ms" ).as<uint32_t>() );
 
          use_socket_read_watermark = options.at( "use-socket-read-watermark" ).as<bool>();
          keepalive_interval = std::chrono::milliseconds( options.at( "p2p-keepalive-interval-ms" ).as<int>() );
@@ -4571,6 +5181,7 @@ namespace eosio {
          sync_master = std::make_unique<sync_manager>(
              options.at( "sync-fetch-span" ).as<uint32_t>(),
              options.at( "sync-peer-limit" ).as<uint32_t>(),
+             options.at( "sync-striped" ).as<bool>(),
              min_blocks_distance);
 
          connections.init( std::chrono::milliseconds( options.at("p2p-keepalive-interval-ms").as<int>() * 2 ),
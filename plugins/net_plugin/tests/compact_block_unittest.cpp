@@ -0,0 +1,160 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/net_plugin/buffer_factory.hpp>
+#include <eosio/net_plugin/compact_block.hpp>
+
+#include <map>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::chain::literals;
+
+namespace {
+   packed_transaction_ptr make_trx( uint32_t ref_block_num, const std::string& cfd ) {
+      signed_transaction trx;
+      trx.ref_block_num = ref_block_num;
+      trx.context_free_data.emplace_back( cfd.begin(), cfd.end() );
+      return std::make_shared<packed_transaction>( std::move(trx) );
+   }
+
+   struct compact_block_fixture {
+      std::vector<packed_transaction_ptr> trxs;
+      signed_block_ptr                    block;
+      compact_block_message               msg;
+      std::map<transaction_id_type, packed_transaction_ptr> local_txns;
+
+      compact_block_fixture() {
+         signed_block_header header;
+         header.timestamp = block_timestamp_type( 100 );
+         header.producer = "producer"_n;
+         mutable_block_ptr b = signed_block::create_mutable_block( header );
+         for( uint32_t i = 0; i < 4; ++i ) {
+            trxs.push_back( make_trx( i, "cfd" ) );
+            b->transactions.emplace_back( *trxs.back() );
+            if( i == 1 ) // a deferred transaction receipt without a packed_transaction
+               b->transactions.emplace_back( transaction_id_type( digest_type::hash( "deferred" ) ) );
+         }
+         deque<digest_type> digests;
+         for( const auto& receipt : b->transactions )
+            digests.emplace_back( receipt.digest() );
+         b->transaction_mroot = calculate_merkle_legacy( std::move(digests) );
+         block = signed_block::create_signed_block( std::move(b) );
+
+         // compact block as sent by a peer
+         compact_block_buffer_factory factory;
+         const auto& sb = factory.get_send_buffer( block );
+         fc::datastream<const char*> ds( sb->data() + message_header_size, sb->size() - message_header_size );
+         net_message m;
+         fc::raw::unpack( ds, m );
+         BOOST_REQUIRE( std::holds_alternative<compact_block_message>(m) );
+         msg = std::get<compact_block_message>( std::move(m) );
+      }
+
+      auto get_txn() {
+         return [this]( const transaction_id_type& id ) -> packed_transaction_ptr {
+            auto i = local_txns.find( id );
+            return i == local_txns.end() ? packed_transaction_ptr{} : i->second;
+         };
+      }
+
+      std::vector<packed_transaction> requested( const pending_compact_block& pending ) const {
+         std::vector<packed_transaction> result;
+         for( uint32_t i : pending.missing )
+            result.emplace_back( std::get<packed_transaction>( block->transactions.at( i ).trx ) );
+         return result;
+      }
+
+      void check_reconstructed( const pending_compact_block& pending ) const {
+         BOOST_TEST( pending.missing.empty() );
+         BOOST_TEST( pending.block->calculate_id() == block->calculate_id() );
+         BOOST_TEST( fc::raw::pack( *pending.block ) == fc::raw::pack( *block ) );
+      }
+   };
+}
+
+BOOST_AUTO_TEST_SUITE(compact_block_reconstruction)
+
+BOOST_FIXTURE_TEST_CASE(compact_block_message_content, compact_block_fixture) {
+   BOOST_TEST( msg.transactions.size() == 5u );
+   BOOST_TEST( msg.packed_trx_indexes == std::vector<uint32_t>({0, 1, 3, 4}), boost::test_tools::per_element() );
+   for( uint32_t i : msg.packed_trx_indexes )
+      BOOST_TEST( std::holds_alternative<transaction_id_type>( msg.transactions[i].trx ) );
+}
+
+BOOST_FIXTURE_TEST_CASE(all_transactions_local, compact_block_fixture) {
+   for( const auto& trx : trxs )
+      local_txns[trx->id()] = trx;
+
+   pending_compact_block pending;
+   BOOST_TEST( (pending.init( block->calculate_id(), msg, get_txn() ) == pending_compact_block::status::complete) );
+   BOOST_TEST( !pending.all_requested );
+   check_reconstructed( pending );
+}
+
+BOOST_FIXTURE_TEST_CASE(missing_transactions_fetched, compact_block_fixture) {
+   local_txns[trxs[0]->id()] = trxs[0];
+   local_txns[trxs[2]->id()] = trxs[2];
+
+   pending_compact_block pending;
+   BOOST_TEST( (pending.init( block->calculate_id(), msg, get_txn() ) == pending_compact_block::status::missing) );
+   BOOST_TEST( pending.missing == std::vector<uint32_t>({1, 4}), boost::test_tools::per_element() );
+   BOOST_TEST( !pending.all_requested );
+
+   BOOST_TEST( (pending.add_transactions( requested( pending ) ) == pending_compact_block::status::complete) );
+   check_reconstructed( pending );
+}
+
+BOOST_FIXTURE_TEST_CASE(missing_transactions_wrong_count, compact_block_fixture) {
+   pending_compact_block pending;
+   BOOST_TEST( (pending.init( block->calculate_id(), msg, get_txn() ) == pending_compact_block::status::missing) );
+   BOOST_TEST( pending.missing.size() == 4u );
+   auto reply = requested( pending );
+   reply.pop_back();
+   BOOST_TEST( (pending.add_transactions( reply ) == pending_compact_block::status::invalid) );
+}
+
+BOOST_FIXTURE_TEST_CASE(mroot_mismatch_requests_all, compact_block_fixture) {
+   for( const auto& trx : trxs )
+      local_txns[trx->id()] = trx;
+   // same id, different context free data
+   auto other = make_trx( 2, "other cfd" );
+   BOOST_REQUIRE( other->id() == trxs[2]->id() );
+   local_txns[other->id()] = other;
+
+   pending_compact_block pending;
+   BOOST_TEST( (pending.init( block->calculate_id(), msg, get_txn() ) == pending_compact_block::status::missing) );
+   BOOST_TEST( pending.all_requested );
+   BOOST_TEST( pending.missing == msg.packed_trx_indexes, boost::test_tools::per_element() );
+
+   BOOST_TEST( (pending.add_transactions( requested( pending ) ) == pending_compact_block::status::complete) );
+   check_reconstructed( pending );
+}
+
+BOOST_FIXTURE_TEST_CASE(mroot_mismatch_after_fetch, compact_block_fixture) {
+   local_txns[trxs[0]->id()] = trxs[0];
+   local_txns[trxs[2]->id()] = trxs[2];
+
+   pending_compact_block pending;
+   BOOST_TEST( (pending.init( block->calculate_id(), msg, get_txn() ) == pending_compact_block::status::missing) );
+   auto reply = requested( pending );
+   reply[0] = packed_transaction( *make_trx( 1, "other cfd" ) );
+   BOOST_TEST( (pending.add_transactions( reply ) == pending_compact_block::status::missing) );
+   BOOST_TEST( pending.all_requested );
+   BOOST_TEST( pending.missing == msg.packed_trx_indexes, boost::test_tools::per_element() );
+
+   // all transactions still not matching the merkle root
+   reply = requested( pending );
+   reply[3] = packed_transaction( *make_trx( 3, "other cfd" ) );
+   BOOST_TEST( (pending.add_transactions( reply ) == pending_compact_block::status::invalid) );
+}
+
+BOOST_FIXTURE_TEST_CASE(invalid_packed_trx_index, compact_block_fixture) {
+   pending_compact_block pending;
+   auto deferred = msg;
+   deferred.packed_trx_indexes.push_back( 2 ); // deferred receipt
+   BOOST_TEST( (pending.init( block->calculate_id(), deferred, get_txn() ) == pending_compact_block::status::invalid) );
+   auto out_of_range = msg;
+   out_of_range.packed_trx_indexes.push_back( out_of_range.transactions.size() );
+   BOOST_TEST( (pending.init( block->calculate_id(), out_of_range, get_txn() ) == pending_compact_block::status::invalid) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,295 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/net_plugin/dispatch_index.hpp>
+
+#include <fc/bitutil.hpp>
+
+#include <algorithm>
+#include <thread>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+namespace {
+   block_id_type make_block_id( uint32_t block_num, uint32_t seed = 0 ) {
+      block_id_type id = fc::sha256::hash( std::to_string( block_num ) + "-" + std::to_string( seed ) );
+      id._hash[0] &= 0xffffffff00000000;
+      id._hash[0] += fc::endian_reverse_u32( block_num );
+      return id;
+   }
+
+   transaction_id_type make_trx_id( uint32_t n ) {
+      return fc::sha256::hash( "trx-" + std::to_string( n ) );
+   }
+
+   packed_transaction_ptr make_trx( uint32_t ref_block_num ) {
+      signed_transaction trx;
+      trx.ref_block_num = ref_block_num;
+      return std::make_shared<packed_transaction>( std::move(trx) );
+   }
+
+   const time_point_sec expires{ 1000 };
+}
+
+BOOST_AUTO_TEST_SUITE(dispatch_index)
+
+BOOST_AUTO_TEST_CASE(peer_blocks) {
+   peer_block_state_shards blk_state;
+   const block_id_type id = make_block_id( 10 );
+   const block_id_type fork_id = make_block_id( 10, 1 );
+
+   BOOST_TEST( !blk_state.have_block( id ) );
+   BOOST_TEST( blk_state.add_peer_block( id, 1 ) );
+   BOOST_TEST( !blk_state.add_peer_block( id, 1 ) );
+   BOOST_TEST( blk_state.add_peer_block( id, 2 ) );
+   BOOST_TEST( blk_state.have_block( id ) );
+   BOOST_TEST( !blk_state.have_block( fork_id ) );
+   BOOST_TEST( blk_state.peer_has_block( id, 2 ) );
+   BOOST_TEST( !blk_state.peer_has_block( id, 3 ) );
+
+   BOOST_TEST( blk_state.add_peer_block( fork_id, 1 ) );
+   blk_state.rm_block( id );
+   BOOST_TEST( !blk_state.have_block( id ) );
+   BOOST_TEST( !blk_state.peer_has_block( id, 1 ) );
+   BOOST_TEST( blk_state.have_block( fork_id ) );
+   BOOST_TEST( blk_state.size() == 1u );
+}
+
+BOOST_AUTO_TEST_CASE(expire_blocks) {
+   peer_block_state_shards blk_state;
+   // enough blocks to spread over every shard
+   for( uint32_t n = 1; n <= 200; ++n ) {
+      BOOST_TEST( blk_state.add_peer_block( make_block_id( n ), 1 ) );
+      BOOST_TEST( blk_state.add_peer_block( make_block_id( n, 1 ), 2 ) );
+   }
+   BOOST_TEST( blk_state.size() == 400u );
+
+   blk_state.expire_blocks( 150 );
+   BOOST_TEST( blk_state.size() == 100u );
+   BOOST_TEST( !blk_state.have_block( make_block_id( 150 ) ) );
+   BOOST_TEST( !blk_state.have_block( make_block_id( 1, 1 ) ) );
+   BOOST_TEST( blk_state.have_block( make_block_id( 151 ) ) );
+   BOOST_TEST( blk_state.peer_has_block( make_block_id( 200, 1 ), 2 ) );
+}
+
+BOOST_AUTO_TEST_CASE(peer_txns) {
+   node_transaction_shards local_txns;
+   const transaction_id_type id = make_trx_id( 1 );
+
+   // notice first, then the trx itself
+   BOOST_TEST( local_txns.add_peer_txn_notice( id, expires, 1 ) == node_transaction_shards::trx_full_entry_size );
+   BOOST_TEST( local_txns.add_peer_txn_notice( id, expires, 1 ) == 0u );
+   auto r = local_txns.add_peer_txn( id, expires, 1 );
+   BOOST_TEST( r.entries_size == 0u );
+   BOOST_TEST( !r.have_trx );
+   r = local_txns.add_peer_txn( id, expires, 2 );
+   BOOST_TEST( r.entries_size == node_transaction_shards::trx_conn_entry_size );
+   BOOST_TEST( r.have_trx );
+
+   r = local_txns.add_peer_txn( make_trx_id( 2 ), expires, 2 );
+   BOOST_TEST( r.entries_size == node_transaction_shards::trx_full_entry_size );
+   BOOST_TEST( !r.have_trx );
+   BOOST_TEST( local_txns.size() == 2u );
+
+   // received trxs are only available once accepted locally
+   BOOST_TEST( !local_txns.get_txn( id ) );
+}
+
+BOOST_AUTO_TEST_CASE(local_txn_lookup) {
+   node_transaction_shards local_txns;
+   auto trx = make_trx( 1 );
+   auto other = make_trx( 2 );
+
+   local_txns.add_peer_txn( trx->id(), expires, 1 );
+   local_txns.add_peer_txn_notice( trx->id(), expires, 2 );
+   const connection_id_set conns = local_txns.add_local_txn( trx, expires );
+   BOOST_TEST( conns.size() == 2u );
+   BOOST_TEST( conns.contains( 1 ) );
+   BOOST_TEST( conns.contains( 2 ) );
+   BOOST_TEST( local_txns.get_txn( trx->id() ) == trx );
+
+   BOOST_TEST( local_txns.add_local_txn( other, expires ).empty() );
+   BOOST_TEST( local_txns.get_txn( other->id() ) == other );
+   BOOST_TEST( local_txns.add_peer_txn( other->id(), expires, 3 ).have_trx );
+}
+
+BOOST_AUTO_TEST_CASE(expire_txns) {
+   node_transaction_shards local_txns;
+   for( uint32_t n = 0; n < 200; ++n )
+      local_txns.add_peer_txn( make_trx_id( n ), time_point_sec( n ), 1 );
+   BOOST_TEST( local_txns.size() == 200u );
+
+   BOOST_TEST( local_txns.expire_txns( time_point_sec( 99 ) ) == 100u );
+   BOOST_TEST( local_txns.size() == 100u );
+   BOOST_TEST( local_txns.add_peer_txn( make_trx_id( 99 ), expires, 1 ).entries_size == node_transaction_shards::trx_full_entry_size );
+   BOOST_TEST( local_txns.add_peer_txn( make_trx_id( 100 ), expires, 1 ).have_trx );
+}
+
+BOOST_AUTO_TEST_CASE(announced_txn_requests) {
+   node_transaction_shards local_txns;
+   const std::vector<transaction_id_type> ids{ make_trx_id( 1 ), make_trx_id( 2 ) };
+   const fc::time_point t0{ fc::seconds( 10 ) };
+   const fc::time_point t1{ fc::seconds( 11 ) };
+   const fc::time_point t2{ fc::seconds( 12 ) };
+
+   auto r = local_txns.add_peer_txn_announce( ids, expires, 1, t0 );
+   BOOST_TEST( r.unseen == ids, boost::test_tools::per_element() );
+   BOOST_TEST( r.entries_size == 2 * node_transaction_shards::trx_full_entry_size );
+   // already requested from connection 1
+   r = local_txns.add_peer_txn_announce( ids, expires, 2, t0 );
+   BOOST_TEST( r.unseen.empty() );
+   BOOST_TEST( r.entries_size == 2 * node_transaction_shards::trx_conn_entry_size );
+
+   // not timed out yet
+   auto re = local_txns.reassign_txn_requests( 1, t0 - fc::microseconds( 1 ), t1 );
+   BOOST_TEST( re.requests.empty() );
+   BOOST_TEST( re.pending );
+   BOOST_TEST( local_txns.reassign_txn_requests( 2, t0, t1 ).requests.empty() );
+
+   // timed out, requested from the other announcer
+   re = local_txns.reassign_txn_requests( 1, t0, t1 );
+   BOOST_TEST( !re.pending );
+   BOOST_REQUIRE( re.requests.size() == 1u );
+   BOOST_TEST( re.requests.begin()->first == 2u );
+   BOOST_TEST( re.requests.begin()->second.size() == 2u );
+
+   // connection 1 timed out and is not asked again, no announcer left
+   re = local_txns.reassign_txn_requests( 2, t1, t2 );
+   BOOST_TEST( re.requests.empty() );
+   BOOST_TEST( !re.pending );
+
+   // a later announce requests from the new announcer
+   r = local_txns.add_peer_txn_announce( ids, expires, 3, t2 );
+   BOOST_TEST( r.unseen == ids, boost::test_tools::per_element() );
+}
+
+BOOST_AUTO_TEST_CASE(announced_txn_requests_per_connection) {
+   node_transaction_shards local_txns;
+   std::vector<transaction_id_type> early, late, other;
+   for( uint32_t n = 0; n < 32; ++n ) {
+      early.push_back( make_trx_id( n ) );
+      late.push_back( make_trx_id( 100 + n ) );
+      other.push_back( make_trx_id( 200 + n ) );
+   }
+   const fc::time_point t0{ fc::seconds( 10 ) };
+   const fc::time_point t1{ fc::seconds( 11 ) };
+   const fc::time_point t2{ fc::seconds( 12 ) };
+
+   BOOST_TEST( local_txns.add_peer_txn_announce( early, expires, 1, t0 ).unseen.size() == 32u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( other, expires, 2, t0 ).unseen.size() == 32u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( late, expires, 1, t1 ).unseen.size() == 32u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( early, expires, 2, t1 ).unseen.empty() );
+   BOOST_TEST( local_txns.add_peer_txn_announce( late, expires, 2, t1 ).unseen.empty() );
+
+   // only the timed out requests of connection 1 move, in every shard
+   auto re = local_txns.reassign_txn_requests( 1, t0, t2 );
+   BOOST_TEST( re.pending );
+   BOOST_REQUIRE( re.requests.size() == 1u );
+   BOOST_TEST( re.requests.begin()->first == 2u );
+   auto moved = re.requests.begin()->second;
+   std::ranges::sort( moved );
+   auto expected = early;
+   std::ranges::sort( expected );
+   BOOST_TEST( moved == expected, boost::test_tools::per_element() );
+
+   // connection 2's own request from t0 has no other announcer, the ones moved to it at t2 are pending
+   re = local_txns.reassign_txn_requests( 2, t0, t2 );
+   BOOST_TEST( re.requests.empty() );
+   BOOST_TEST( re.pending );
+   re = local_txns.reassign_txn_requests( 1, t1, t2 );
+   BOOST_TEST( !re.pending );
+   BOOST_TEST( re.requests.begin()->second.size() == 32u );
+}
+
+BOOST_AUTO_TEST_CASE(announced_txn_received) {
+   node_transaction_shards local_txns;
+   const std::vector<transaction_id_type> ids{ make_trx_id( 1 ) };
+   const fc::time_point t0{ fc::seconds( 10 ) };
+
+   BOOST_TEST( local_txns.add_peer_txn_announce( ids, expires, 1, t0 ).unseen.size() == 1u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( ids, expires, 2, t0 ).unseen.empty() );
+   BOOST_TEST( !local_txns.add_peer_txn( ids[0], expires, 1 ).have_trx );
+
+   auto re = local_txns.reassign_txn_requests( 1, fc::time_point::maximum(), t0 );
+   BOOST_TEST( re.requests.empty() );
+   BOOST_TEST( !re.pending );
+   // received trxs are not requested again
+   BOOST_TEST( local_txns.add_peer_txn_announce( ids, expires, 3, t0 ).unseen.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(announced_txn_connection_closed) {
+   node_transaction_shards local_txns;
+   const transaction_id_type a = make_trx_id( 1 );
+   const transaction_id_type b = make_trx_id( 2 );
+   const fc::time_point t0{ fc::seconds( 10 ) };
+
+   BOOST_TEST( local_txns.add_peer_txn_announce( {a}, expires, 1, t0 ).unseen.size() == 1u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( {b}, expires, 2, t0 ).unseen.size() == 1u );
+   BOOST_TEST( local_txns.add_peer_txn_announce( {a, b}, expires, 1, t0 ).unseen.empty() );
+   BOOST_TEST( local_txns.add_peer_txn_announce( {a, b}, expires, 2, t0 ).unseen.empty() );
+
+   // connection 1 closes, its request of a moves to connection 2
+   auto re = local_txns.reassign_txn_requests( 1, fc::time_point::maximum(), t0 );
+   BOOST_REQUIRE( re.requests.size() == 1u );
+   BOOST_TEST( re.requests.begin()->first == 2u );
+   BOOST_TEST( re.requests.begin()->second == std::vector<transaction_id_type>{ a }, boost::test_tools::per_element() );
+
+   // closed connection 1 is not picked for b
+   re = local_txns.reassign_txn_requests( 2, fc::time_point::maximum(), t0 );
+   BOOST_TEST( re.requests.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(announced_txn_served_once) {
+   node_transaction_shards local_txns;
+   auto trx = make_trx( 1 );
+   local_txns.add_local_txn( trx, expires );
+
+   // not announced to connection 5
+   BOOST_TEST( !local_txns.get_announced_txn( trx->id(), 5 ) );
+   local_txns.add_txns_announced( { trx->id() }, 5 );
+   local_txns.add_txns_announced( { trx->id() }, 6 );
+   BOOST_TEST( !local_txns.get_announced_txn( trx->id(), 7 ) );
+   BOOST_TEST( local_txns.get_announced_txn( trx->id(), 5 ) == trx );
+   BOOST_TEST( !local_txns.get_announced_txn( trx->id(), 5 ) );
+   BOOST_TEST( local_txns.get_announced_txn( trx->id(), 6 ) == trx );
+
+   // unknown and expired trxs are not served
+   local_txns.add_txns_announced( { make_trx_id( 1 ) }, 5 );
+   BOOST_TEST( !local_txns.get_announced_txn( make_trx_id( 1 ), 5 ) );
+   local_txns.add_txns_announced( { trx->id() }, 5 );
+   local_txns.expire_txns( expires );
+   BOOST_TEST( !local_txns.get_announced_txn( trx->id(), 5 ) );
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_updates) {
+   peer_block_state_shards blk_state;
+   node_transaction_shards local_txns;
+   constexpr uint32_t num_threads = 8;
+   constexpr uint32_t per_thread = 1000;
+
+   std::vector<std::thread> threads;
+   for( uint32_t t = 0; t < num_threads; ++t ) {
+      threads.emplace_back( [&, t]() {
+         for( uint32_t i = 0; i < per_thread; ++i ) {
+            const uint32_t n = t * per_thread + i;
+            blk_state.add_peer_block( make_block_id( n + 1 ), t );
+            local_txns.add_peer_txn_notice( make_trx_id( n ), expires, t );
+            // every thread also tracks the same ids for its connection
+            blk_state.add_peer_block( make_block_id( i + 1 ), t );
+            local_txns.add_peer_txn( make_trx_id( i ), expires, t );
+         }
+      } );
+   }
+   for( auto& t : threads )
+      t.join();
+
+   BOOST_TEST( local_txns.size() == num_threads * per_thread );
+   for( uint32_t i = 0; i < per_thread; ++i ) {
+      for( uint32_t t = 0; t < num_threads; ++t )
+         BOOST_TEST_REQUIRE( blk_state.peer_has_block( make_block_id( i + 1 ), t ) );
+      BOOST_TEST_REQUIRE( local_txns.add_peer_txn( make_trx_id( i ), expires, 0 ).have_trx );
+   }
+   // blocks 1..per_thread are tracked for every connection, the others for one
+   BOOST_TEST( blk_state.size() == (num_threads - 1) * per_thread + num_threads * per_thread );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/net_plugin/buffer_factory.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+namespace {
+   packed_transaction_ptr make_trx( size_t cfd_size ) {
+      signed_transaction trx;
+      trx.context_free_data.emplace_back( bytes( cfd_size, 'a' ) );
+      return std::make_shared<packed_transaction>( std::move(trx) );
+   }
+
+   // @return net_message of a send buffer, decompressing it if it is a compressed_message
+   net_message unpack_send_buffer( const send_buffer_type& sb ) {
+      fc::datastream<const char*> ds( sb->data() + message_header_size, sb->size() - message_header_size );
+      net_message msg;
+      fc::raw::unpack( ds, msg );
+      if( std::holds_alternative<compressed_message>(msg) ) {
+         const auto& cm = std::get<compressed_message>(msg);
+         BOOST_REQUIRE_EQUAL( cm.codec, static_cast<uint8_t>(compression_codec::zlib) );
+         auto decompressed = decompress_message( compression_codec::zlib, cm.data, max_decompressed_message_size );
+         fc::datastream<const char*> dds( decompressed.data(), decompressed.size() );
+         net_message dmsg;
+         fc::raw::unpack( dds, dmsg );
+         BOOST_REQUIRE( !std::holds_alternative<compressed_message>(dmsg) );
+         return dmsg;
+      }
+      return msg;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(message_compression)
+
+BOOST_AUTO_TEST_CASE(compress_decompress_roundtrip) {
+   const std::string first( 1000, 'x' );
+   const std::string second = "second part";
+   auto compressed = compress_message( compression_codec::zlib, { std::span<const char>( first ), std::span<const char>( second ) } );
+   BOOST_TEST( compressed.size() < first.size() );
+
+   auto decompressed = decompress_message( compression_codec::zlib, compressed, max_decompressed_message_size );
+   BOOST_TEST( std::string( decompressed.begin(), decompressed.end() ) == first + second );
+
+   BOOST_CHECK_THROW( compress_message( compression_codec::none, { std::span<const char>( first ) } ), plugin_exception );
+   BOOST_CHECK_THROW( decompress_message( compression_codec::none, compressed, max_decompressed_message_size ), plugin_exception );
+}
+
+BOOST_AUTO_TEST_CASE(decompress_limit) {
+   const std::vector<char> at_limit( max_decompressed_message_size, 'z' );
+   auto compressed = compress_message( compression_codec::zlib, { std::span<const char>( at_limit ) } );
+   BOOST_TEST( decompress_message( compression_codec::zlib, compressed, max_decompressed_message_size ).size() == at_limit.size() );
+
+   // compresses to a few KiB, must not be expanded past the maximum received message size
+   const std::vector<char> past_limit( max_decompressed_message_size + 1, 'z' );
+   compressed = compress_message( compression_codec::zlib, { std::span<const char>( past_limit ) } );
+   BOOST_TEST( compressed.size() < min_compressed_message_size * 32 );
+   BOOST_CHECK_THROW( decompress_message( compression_codec::zlib, compressed, max_decompressed_message_size ), plugin_exception );
+}
+
+BOOST_AUTO_TEST_CASE(trx_send_buffer) {
+   auto trx = make_trx( 4096 );
+   trx_buffer_factory uncompressed_factory;
+   const auto& uncompressed = uncompressed_factory.get_send_buffer( trx );
+   BOOST_TEST( &uncompressed == &uncompressed_factory.get_send_buffer( trx, compression_codec::none ) );
+
+   trx_buffer_factory compressed_factory;
+   const auto& compressed = compressed_factory.get_send_buffer( trx, compression_codec::zlib );
+   BOOST_TEST( compressed->size() < uncompressed->size() );
+   BOOST_TEST( &compressed == &compressed_factory.get_send_buffer( trx, compression_codec::zlib ) ); // cached
+
+   auto msg = unpack_send_buffer( compressed );
+   BOOST_REQUIRE( std::holds_alternative<packed_transaction>(msg) );
+   BOOST_TEST( std::get<packed_transaction>(msg).id() == trx->id() );
+
+   // payload of the compressed_message is the packed net_message of the uncompressed send buffer
+   fc::datastream<const char*> ds( compressed->data() + message_header_size, compressed->size() - message_header_size );
+   net_message cmsg;
+   fc::raw::unpack( ds, cmsg );
+   BOOST_REQUIRE( std::holds_alternative<compressed_message>(cmsg) );
+   auto decompressed = decompress_message( compression_codec::zlib, std::get<compressed_message>(cmsg).data, max_decompressed_message_size );
+   BOOST_TEST( decompressed == std::vector<char>( uncompressed->begin() + message_header_size, uncompressed->end() ) );
+}
+
+BOOST_AUTO_TEST_CASE(small_trx_not_compressed) {
+   auto trx = make_trx( 8 );
+   trx_buffer_factory factory;
+   const auto& sb = factory.get_send_buffer( trx, compression_codec::zlib );
+   BOOST_TEST( sb->size() < message_header_size + min_compressed_message_size );
+
+   auto msg = unpack_send_buffer( sb );
+   BOOST_REQUIRE( std::holds_alternative<packed_transaction>(msg) );
+   BOOST_TEST( std::get<packed_transaction>(msg).id() == trx->id() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 #include <eosio/producer_plugin/block_timing_util.hpp>
 #include <eosio/producer_plugin/production_pause_vote_tracker.hpp>
 #include <eosio/chain/plugin_interface.hpp>
+#include <eosio/chain/account_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/snapshot.hpp>
@@ -25,6 +26,7 @@
 #include <cstdint>
 #include <iostream>
 #include <algorithm>
+#include <bit>
 #include <mutex>
 
 using boost::signals2::scoped_connection;
@@ -1096,6 +1098,25 @@ public:
               });
    }
 
+   // cost of trx in the fair order of the incoming queue, see unapplied_transaction_queue::add_incoming.
+   // Accounts with more staked CPU are served more often, on a log scale so that large stakes do not starve small ones.
+   // Accounts with a higher subjective bill, CPU of trxs not yet in a block and of failed trxs, are served less often.
+   uint64_t incoming_fair_cost(const transaction_metadata_ptr& trx) const {
+      constexpr uint64_t cost_unit = 1024;
+      const chain::controller& chain      = chain_plug->chain();
+      const account_name       first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+
+      uint64_t stake_weight = 1;
+      if (chain.db().find<account_object, by_name>(first_auth)) {
+         int64_t ram_bytes = 0, net_weight = 0, cpu_weight = 0;
+         chain.get_resource_limits_manager().get_account_limits(first_auth, ram_bytes, net_weight, cpu_weight);
+         stake_weight = cpu_weight < 0 ? 65 // unlimited
+                                       : 1 + std::bit_width(static_cast<uint64_t>(cpu_weight));
+      }
+      const uint64_t sub_bill_ms = chain.get_subjective_billing().get_subjective_bill(first_auth, fc::time_point::now()) / 1000;
+      return (1 + sub_bill_ms) * cost_unit / stake_weight;
+   }
+
    bool process_incoming_transaction_async(const transaction_metadata_ptr&             trx,
                                            bool                                        api_trx,
                                            const fc::time_point&                       start,
@@ -1124,8 +1145,11 @@ public:
             return true;
          }
 
+         // the per account limit applies whether the trx is queued or executed now
+         _unapplied_transactions.check_incoming_account_limit(trx);
+
          if (!chain.is_building_block()) {
-            _unapplied_transactions.add_incoming(trx, api_trx, return_failure_trace, next);
+            _unapplied_transactions.add_incoming(trx, api_trx, return_failure_trace, next, incoming_fair_cost(trx));
             trx_tracker.cancel();
             return true;
          }
@@ -1134,7 +1158,7 @@ public:
          push_result pr             = push_transaction(block_deadline, trx, api_trx, return_failure_trace, trx_tracker, next);
 
          if (pr.trx_exhausted) {
-            _unapplied_transactions.add_incoming(trx, api_trx, return_failure_trace, next);
+            _unapplied_transactions.add_incoming(trx, api_trx, return_failure_trace, next, incoming_fair_cost(trx));
          }
 
          exhausted = pr.block_exhausted;
@@ -1330,6 +1354,8 @@ void producer_plugin::set_program_options(
           "Sets the time to return full subjective cpu for accounts")
          ("incoming-transaction-queue-size-mb", bpo::value<uint16_t>()->default_value( 1024 ),
           "Maximum size (in MiB) of the incoming transaction queue. Exceeding this value will subjectively drop transaction with resource exhaustion.")
+         ("incoming-transaction-queue-max-per-account", bpo::value<uint32_t>()->default_value( 0 ),
+          "Maximum number of transactions of a first authorizer in the incoming transaction queue, 0 for no limit. Exceeding this value will subjectively drop transaction with resource exhaustion.")
          ("disable-subjective-account-billing", boost::program_options::value<vector<string>>()->composing()->multitoken(),
           "Account which is excluded from subjective CPU billing")
          ("disable-subjective-p2p-billing", bpo::value<bool>()->default_value(true),
@@ -1338,6 +1364,8 @@ void producer_plugin::set_program_options(
           "Disable subjective CPU billing for API transactions")
          ("snapshots-dir", bpo::value<std::filesystem::path>()->default_value("snapshots"),
           "the location of the snapshots directory (absolute path or relative to application data dir)")
+         ("snapshot-compression", bpo::bool_switch()->default_value(false),
+          "Write snapshots in the compressed format, where each section is stored in independently compressed chunks indexed at the end of the file")
          ("read-only-threads", bpo::value<uint32_t>(),
          ("Number of worker threads in read-only execution thread pool. Defaults to 0 if configured as producer, otherwise defaults to "s + std::to_string(producer_plugin_impl::_ro_default_threads_nonproducer) + ". Max "s + std::to_string(producer_plugin_impl::_ro_max_threads_allowed) + "."s).c_str())
          ("read-only-write-window-time-us", bpo::value<uint32_t>()->default_value(my->_ro_write_window_time_us.count()),
@@ -1449,6 +1477,7 @@ void producer_plugin_impl::plugin_initialize(const boost::program_options::varia
               "incoming-transaction-queue-size-mb ${mb} must be greater than 0", ("mb", max_incoming_transaction_queue_size));
 
    _unapplied_transactions.set_max_transaction_queue_size(max_incoming_transaction_queue_size);
+   _unapplied_transactions.set_max_incoming_per_account(options.at("incoming-transaction-queue-max-per-account").as<uint32_t>());
 
    _disable_subjective_p2p_billing = options.at("disable-subjective-p2p-billing").as<bool>();
    _disable_subjective_api_billing = options.at("disable-subjective-api-billing").as<bool>();
@@ -1582,6 +1611,7 @@ void producer_plugin_impl::plugin_initialize(const boost::program_options::varia
 
    _snapshot_scheduler.set_db_path(_snapshots_dir);
    _snapshot_scheduler.set_snapshots_path(_snapshots_dir);
+   _snapshot_scheduler.set_compression(options.at("snapshot-compression").as<bool>());
 }
 
 void producer_plugin::plugin_initialize(const boost::program_options::variables_map& options) {
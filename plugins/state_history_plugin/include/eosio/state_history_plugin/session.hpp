@@ -1,5 +1,7 @@
 #pragma once
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log.hpp>
+#include <eosio/state_history/log_entry_cache.hpp>
 #include <eosio/state_history/serialization.hpp>
 #include <eosio/state_history/types.hpp>
 
@@ -12,6 +14,7 @@
 #include <boost/asio/error.hpp>
 #include <boost/beast/websocket.hpp>
 #include <memory>
+#include <span>
 
 extern const char* const state_history_plugin_abi;
 
@@ -23,7 +26,9 @@ public:
    session_base(const session_base&) = delete;
    session_base& operator=(const session_base&) = delete;
 
-   virtual void block_applied(const chain::block_num_type applied_block_num) = 0;
+   /// entries of blocks up to last_applied_block_num are in the logs, lowest_applied_block_num is the lowest block
+   /// written since the last call
+   virtual void block_applied(const chain::block_num_type lowest_applied_block_num, const chain::block_num_type last_applied_block_num) = 0;
 
    virtual void drain_strand() = 0;
 
@@ -39,19 +44,22 @@ class session final : public session_base {
 public:
    session(SocketType&& s, chain::controller& controller,
            std::optional<log_catalog>& trace_log, std::optional<log_catalog>& chain_state_log, std::optional<log_catalog>& finality_data_log,
+           log_entry_cache& entry_cache, chain::block_num_type log_head_block_num,
            GetBlockID&& get_block_id, GetBlock&& get_block, OnDone&& on_done, fc::logger& logger) :
     strand(s.get_executor()), stream(std::move(s)), wake_timer(strand), controller(controller),
-    trace_log(trace_log), chain_state_log(chain_state_log), finality_data_log(finality_data_log),
+    trace_log(trace_log), chain_state_log(chain_state_log), finality_data_log(finality_data_log), entry_cache(entry_cache), log_head_block_num(log_head_block_num),
     get_block_id(get_block_id), get_block(get_block), on_done(on_done), logger(logger), remote_endpoint_string(get_remote_endpoint_string()) {
       fc_ilog(logger, "incoming state history connection from ${a}", ("a", remote_endpoint_string));
 
       boost::asio::co_spawn(strand, read_loop(), [&](std::exception_ptr e) {check_coros_done(e);});
    }
 
-   void block_applied(const chain::block_num_type applied_block_num) {
-      //indicates a fork being applied for already-sent blocks; rewind the cursor
-      if(applied_block_num < next_block_cursor)
-         next_block_cursor = applied_block_num;
+   void block_applied(const chain::block_num_type lowest_applied_block_num, const chain::block_num_type last_applied_block_num) {
+      //entries of the applied blocks are now in the logs; the last one is the newest block that may be sent
+      log_head_block_num = last_applied_block_num;
+      //indicates a fork being applied for already-sent blocks; rewind the cursor to the first replaced block
+      if(lowest_applied_block_num < next_block_cursor)
+         next_block_cursor = lowest_applied_block_num;
       awake_if_idle();
    }
 
@@ -157,8 +165,14 @@ private:
                   [&self]<typename GetBlocksRequestV0orV1, typename = std::enable_if_t<std::is_base_of_v<get_blocks_request_v0, GetBlocksRequestV0orV1>>>(const GetBlocksRequestV0orV1& gbr) {
                      self.current_blocks_request_v1_finality.reset();
                      self.current_blocks_request = gbr;
-                     if constexpr(std::is_same_v<GetBlocksRequestV0orV1, get_blocks_request_v1>)
+                     if constexpr(std::is_base_of_v<get_blocks_request_v1, GetBlocksRequestV0orV1>)
                         self.current_blocks_request_v1_finality = gbr.fetch_finality_data;
+                     self.current_blocks_request_v2_stored = std::is_same_v<GetBlocksRequestV0orV1, get_blocks_request_v2>;
+                     self.current_blocks_request_v3_filters.reset();
+                     if constexpr(std::is_same_v<GetBlocksRequestV0orV1, get_blocks_request_v3>) {
+                        if(gbr.action_filters.size() || gbr.table_filters.size())
+                           self.current_blocks_request_v3_filters = std::make_shared<const entry_filters>(entry_filters{gbr.action_filters, gbr.table_filters});
+                     }
 
                      for(const block_position& haveit : self.current_blocks_request.have_positions) {
                         if(self.current_blocks_request.start_block_num <= haveit.block_num)
@@ -196,24 +210,94 @@ private:
       return ret;
    }
 
-   boost::asio::awaitable<void> write_log_entry(std::optional<ship_log_entry>& log_stream) {
+   std::span<char> get_entry_write_buff() {
+      if(entry_write_buff.empty())
+         entry_write_buff.resize(1024*1024);
+      return entry_write_buff;
+   }
+
+   boost::asio::awaitable<void> write_log_entry(std::optional<ship_log_entry>& log_stream, log_entry_cache::log_type type) {
       if(!log_stream) { //will be unset if either request did not ask for this log entry, or the log isn't enabled
          co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(false)));
          co_return;
       }
 
-      char buff[1024*1024];
+      const std::span<char> buff = get_entry_write_buff();
+      fc::datastream<char*> ds(buff.data(), buff.size());
+      fc::raw::pack(ds, true);
+      const uint64_t uncompressed_size = log_stream->get_uncompressed_size();
+      history_pack_varuint64(ds, uncompressed_size);
+      co_await stream.async_write_some(false, boost::asio::buffer(buff.data(), ds.tellp()));
+
+      //other sessions are likely sending the same entry; share a single decompression of it with them
+      if(uncompressed_size && uncompressed_size <= entry_cache.max_entry_size()) {
+         const log_entry_cache::contents_ptr contents = entry_cache.get(type, *log_stream);
+         co_await stream.async_write_some(false, boost::asio::buffer(*contents));
+         co_return;
+      }
+
+      bio::filtering_istreambuf decompression_stream = log_stream->get_stream();
+      std::streamsize red = 0;
+      while((red = bio::read(decompression_stream, buff.data(), buff.size())) != -1) {
+         if(red == 0)
+            continue;
+         co_await stream.async_write_some(false, boost::asio::buffer(buff.data(), red));
+      }
+   }
+
+   //sends the part of the decompressed entry passing filter; the whole entry must be decompressed before its size is known
+   template<typename Filter>
+   boost::asio::awaitable<void> write_filtered_log_entry(std::optional<ship_log_entry>& log_stream, log_entry_cache::log_type type, Filter filter) {
+      if(!log_stream) {
+         co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(false)));
+         co_return;
+      }
+
+      log_entry_cache::contents_ptr contents;
+      const uint64_t uncompressed_size = log_stream->get_uncompressed_size();
+      if(uncompressed_size && uncompressed_size <= entry_cache.max_entry_size()) {
+         contents = entry_cache.get(type, *log_stream);
+      }
+      else {
+         std::vector<char> decompressed;
+         decompressed.reserve(uncompressed_size);
+         bio::filtering_istreambuf decompression_stream = log_stream->get_stream();
+         bio::copy(decompression_stream, bio::back_inserter(decompressed));
+         contents = std::make_shared<const std::vector<char>>(std::move(decompressed));
+      }
+      const std::vector<char> filtered = contents->empty() ? std::vector<char>() : filter(contents->data(), contents->size());
+
+      char buff[16];
       fc::datastream<char*> ds(buff, sizeof(buff));
       fc::raw::pack(ds, true);
-      history_pack_varuint64(ds, log_stream->get_uncompressed_size());
+      history_pack_varuint64(ds, filtered.size());
       co_await stream.async_write_some(false, boost::asio::buffer(buff, ds.tellp()));
+      co_await stream.async_write_some(false, boost::asio::buffer(filtered));
+   }
 
-      bio::filtering_istreambuf decompression_stream = log_stream->get_stream();
+   //sends the entry as stored in the log, without decompressing it, as a stored_log_entry
+   boost::asio::awaitable<void> write_stored_log_entry(std::optional<ship_log_entry>& log_entry) {
+      if(!log_entry) {
+         co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(false)));
+         co_return;
+      }
+
+      const std::span<char> buff = get_entry_write_buff();
+      fc::datastream<char*> ds(buff.data(), buff.size());
+      fc::raw::pack(ds, true);
+      fc::raw::pack(ds, log_entry->raw_payload ? stored_log_entry::raw_codec : stored_log_entry::zlib_codec);
+      //entries of logs written before the uncompressed size was stored in their header would need to be decompressed to
+      // find it; send 0 for unknown instead
+      fc::raw::pack(ds, log_entry->uncompressed_size.value_or(0));
+      history_pack_varuint64(ds, log_entry->compressed_data_size);
+      co_await stream.async_write_some(false, boost::asio::buffer(buff.data(), ds.tellp()));
+
+      bio::filtering_istreambuf stored_stream = log_entry->get_stored_stream();
       std::streamsize red = 0;
-      while((red = bio::read(decompression_stream, buff, sizeof(buff))) != -1) {
+      while((red = bio::read(stored_stream, buff.data(), buff.size())) != -1) {
          if(red == 0)
             continue;
-         co_await stream.async_write_some(false, boost::asio::buffer(buff, red));
+         co_await stream.async_write_some(false, boost::asio::buffer(buff.data(), red));
       }
    }
 
@@ -223,6 +307,9 @@ private:
          struct block_package {
             get_blocks_result_base blocks_result_base;
             bool is_v1_request = false;
+            bool is_v2_request = false;
+            bool fetch_block = false;
+            std::shared_ptr<const entry_filters> filters;
             std::optional<ship_log_entry> trace_entry;
             std::optional<ship_log_entry> state_entry;
             std::optional<ship_log_entry> finality_entry;
@@ -233,7 +320,7 @@ private:
                break;
 
             std::deque<bool>             status_requests;
-            std::optional<block_package> block_to_send;
+            std::vector<block_package>   blocks_to_send;
 
             auto& self = *this; //gcc10 ICE workaround wrt capturing 'this' in a coro
             co_await boost::asio::co_spawn(app().get_io_context(), [&]() -> boost::asio::awaitable<void> {
@@ -242,32 +329,34 @@ private:
                 */
                status_requests = std::move(self.queued_status_requests);
 
-               //decide what block -- if any -- to send out
-               const chain::block_num_type latest_to_consider = self.current_blocks_request.irreversible_only ?
-                                                                self.controller.fork_db_root().block_num() : self.controller.head().block_num();
-               if(self.send_credits && self.next_block_cursor <= latest_to_consider && self.next_block_cursor < self.current_blocks_request.end_block_num) {
-                  block_to_send.emplace( block_package{
+               //decide what blocks -- if any -- to send out. reserve a window of blocks per visit to the main thread instead of
+               // visiting it for every block; only cheap index lookups are done here, blocks are read on the session's strand
+               const chain::block_num_type latest_to_consider = std::min(self.log_head_block_num, self.current_blocks_request.irreversible_only ?
+                                                                self.controller.fork_db_root().block_num() : self.controller.head().block_num());
+               const block_position head = {self.controller.head().block_num(), self.controller.head().id()};
+               const block_position last_irreversible = {self.controller.fork_db_root().block_num(), self.controller.fork_db_root().id()};
+               const uint32_t window = std::min(self.send_credits, max_blocks_per_main_thread_visit);
+               while(blocks_to_send.size() < window && self.next_block_cursor <= latest_to_consider && self.next_block_cursor < self.current_blocks_request.end_block_num) {
+                  block_package& block_to_send = blocks_to_send.emplace_back( block_package{
                      .blocks_result_base = {
-                        .head = {self.controller.head().block_num(), self.controller.head().id()},
-                        .last_irreversible = {self.controller.fork_db_root().block_num(), self.controller.fork_db_root().id()}
+                        .head = head,
+                        .last_irreversible = last_irreversible
                      },
-                     .is_v1_request = self.current_blocks_request_v1_finality.has_value()
+                     .is_v1_request = self.current_blocks_request_v1_finality.has_value(),
+                     .is_v2_request = self.current_blocks_request_v2_stored,
+                     .filters = self.current_blocks_request_v3_filters
                   });
                   if(const std::optional<chain::block_id_type> this_block_id = self.get_block_id(self.next_block_cursor)) {
-                     block_to_send->blocks_result_base.this_block  = {self.current_blocks_request.start_block_num, *this_block_id};
+                     block_to_send.blocks_result_base.this_block  = {self.current_blocks_request.start_block_num, *this_block_id};
                      if(const std::optional<chain::block_id_type> last_block_id = self.get_block_id(self.next_block_cursor - 1))
-                        block_to_send->blocks_result_base.prev_block = {self.next_block_cursor - 1, *last_block_id};
-                     if (self.current_blocks_request.fetch_block) {
-                        if (chain::signed_block_ptr sbp = get_block(*this_block_id)) {
-                           block_to_send->blocks_result_base.block = fc::raw::pack(*sbp);
-                        }
-                     }
+                        block_to_send.blocks_result_base.prev_block = {self.next_block_cursor - 1, *last_block_id};
+                     block_to_send.fetch_block = self.current_blocks_request.fetch_block;
                      if(self.current_blocks_request.fetch_traces && self.trace_log)
-                        block_to_send->trace_entry = self.trace_log->get_entry(self.next_block_cursor);
+                        block_to_send.trace_entry = self.trace_log->get_entry(self.next_block_cursor);
                      if(self.current_blocks_request.fetch_deltas && self.chain_state_log)
-                        block_to_send->state_entry = self.chain_state_log->get_entry(self.next_block_cursor);
-                     if(block_to_send->is_v1_request && *self.current_blocks_request_v1_finality && self.finality_data_log)
-                        block_to_send->finality_entry = self.finality_data_log->get_entry(self.next_block_cursor);
+                        block_to_send.state_entry = self.chain_state_log->get_entry(self.next_block_cursor);
+                     if(block_to_send.is_v1_request && *self.current_blocks_request_v1_finality && self.finality_data_log)
+                        block_to_send.finality_entry = self.finality_data_log->get_entry(self.next_block_cursor);
                   }
                   // increment next_block_cursor even if unable to retrieve block to avoid tight busy loop
                   ++self.next_block_cursor;
@@ -280,7 +369,7 @@ private:
             }, boost::asio::use_awaitable);
 
             //if there is nothing to send, go to sleep
-            if(status_requests.empty() && !block_to_send) {
+            if(status_requests.empty() && blocks_to_send.empty()) {
                co_await wake_timer.async_wait();
                continue;
             }
@@ -293,18 +382,49 @@ private:
                   co_await stream.async_write(boost::asio::buffer(fc::raw::pack(state_result(current_status_result))));
             }
 
-            //and then send the block
-            if(block_to_send) {
-               const fc::unsigned_int get_blocks_result_variant_index = block_to_send->is_v1_request ?
+            //and then send the blocks
+            for(block_package& block_to_send : blocks_to_send) {
+               //fork database and block log are safe to read from here; keep reading and packing blocks off the main thread
+               if(block_to_send.fetch_block) {
+                  if(chain::signed_block_ptr sbp = get_block(block_to_send.blocks_result_base.this_block->block_id))
+                     block_to_send.blocks_result_base.block = fc::raw::pack(*sbp);
+               }
+
+               const fc::unsigned_int get_blocks_result_variant_index = block_to_send.is_v2_request ?
+                                                                        state_result(get_blocks_result_v2()).index() :
+                                                                        block_to_send.is_v1_request ?
                                                                         state_result(get_blocks_result_v1()).index() :
                                                                         state_result(get_blocks_result_v0()).index();
                co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(get_blocks_result_variant_index)));
-               co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(block_to_send->blocks_result_base)));
+               co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(block_to_send.blocks_result_base)));
 
-               co_await write_log_entry(block_to_send->trace_entry);
-               co_await write_log_entry(block_to_send->state_entry);
-               if(block_to_send->is_v1_request)
-                  co_await write_log_entry(block_to_send->finality_entry);
+               if(block_to_send.is_v2_request) {
+                  co_await write_stored_log_entry(block_to_send.trace_entry);
+                  co_await write_stored_log_entry(block_to_send.state_entry);
+                  co_await write_stored_log_entry(block_to_send.finality_entry);
+               }
+               else if(block_to_send.filters) {
+                  const entry_filters& filters = *block_to_send.filters;
+                  if(filters.action_filters.size())
+                     co_await write_filtered_log_entry(block_to_send.trace_entry, log_entry_cache::log_type::trace, [&filters](const char* data, size_t size) {
+                        return filter_traces(data, size, filters.action_filters);
+                     });
+                  else
+                     co_await write_log_entry(block_to_send.trace_entry, log_entry_cache::log_type::trace);
+                  if(filters.table_filters.size())
+                     co_await write_filtered_log_entry(block_to_send.state_entry, log_entry_cache::log_type::chain_state, [&filters](const char* data, size_t size) {
+                        return filter_deltas(data, size, filters.table_filters);
+                     });
+                  else
+                     co_await write_log_entry(block_to_send.state_entry, log_entry_cache::log_type::chain_state);
+                  co_await write_log_entry(block_to_send.finality_entry, log_entry_cache::log_type::finality_data);
+               }
+               else {
+                  co_await write_log_entry(block_to_send.trace_entry, log_entry_cache::log_type::trace);
+                  co_await write_log_entry(block_to_send.state_entry, log_entry_cache::log_type::chain_state);
+                  if(block_to_send.is_v1_request)
+                     co_await write_log_entry(block_to_send.finality_entry, log_entry_cache::log_type::finality_data);
+               }
 
                co_await stream.async_write_some(true, boost::asio::const_buffer());
             }
@@ -313,18 +433,29 @@ private:
    }
 
 private:
+   struct entry_filters {
+      std::vector<action_filter>     action_filters;
+      std::vector<table_filter>      table_filters;
+   };
+
+   //upper bound on the blocks reserved per visit to the main thread, bounds memory held by a session that has plenty of credits
+   static constexpr uint32_t         max_blocks_per_main_thread_visit = 128;
+
    ///these items must only ever be touched by the session's strand
    SocketType::executor_type         strand;
    coro_throwing_stream              stream;
    coro_nonthrowing_steadytimer      wake_timer;
    unsigned                          coros_running = 0;
    std::atomic_flag                  has_logged_exception;  //left as atomic_flag for useful test_and_set() interface
+   std::vector<char>                 entry_write_buff;      //log entries are written one at a time, kept out of the coroutine frames
 
    ///these items must only ever be touched on the main thread
    std::deque<bool>                  queued_status_requests;  //false for v0, true for v1
 
    get_blocks_request_v0             current_blocks_request;
    std::optional<bool>               current_blocks_request_v1_finality; //unset: current request is v0; set means v1; true/false is if finality requested
+   bool                              current_blocks_request_v2_stored = false; //v2 request: send log entries as stored
+   std::shared_ptr<const entry_filters> current_blocks_request_v3_filters; //v3 request with filters: send filtered log entries
    //current_blocks_request is modified with the current state; bind some more descriptive names to items frequently used
    uint32_t&                         send_credits = current_blocks_request.max_messages_in_flight;
    chain::block_num_type&            next_block_cursor = current_blocks_request.start_block_num;
@@ -333,9 +464,11 @@ private:
    std::optional<log_catalog>&       trace_log;
    std::optional<log_catalog>&       chain_state_log;
    std::optional<log_catalog>&       finality_data_log;
+   log_entry_cache&                  entry_cache;
+   chain::block_num_type             log_head_block_num; //newest block whose log entries have been written
 
    GetBlockID                        get_block_id; // call from main app thread
-   GetBlock                          get_block;
+   GetBlock                          get_block;    // thread safe, called from the session strand
 
    ///these items might be used on either the strand or main thread
    OnDone                            on_done;
@@ -5,6 +5,7 @@
 #include <eosio/state_history/create_deltas.hpp>
 #include <eosio/state_history/log_config.hpp>
 #include <eosio/state_history/log_catalog.hpp>
+#include <eosio/state_history/log_entry_cache.hpp>
 #include <eosio/state_history/serialization.hpp>
 #include <eosio/state_history/trace_converter.hpp>
 #include <eosio/state_history_plugin/session.hpp>
@@ -15,11 +16,14 @@
 
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 
 #include <boost/signals2/connection.hpp>
+#include <condition_variable>
 #include <mutex>
 
 #include <fc/network/listener.hpp>
+#include <fc/scoped_exit.hpp>
 
 namespace eosio {
 using namespace chain;
@@ -61,6 +65,27 @@ private:
    state_history::trace_converter   trace_converter;
 
    named_thread_pool<struct ship>   thread_pool;
+   std::optional<log_entry_cache>   entry_cache;
+
+   //log entries are serialized on the main thread (packing reads chain state) but framed and written out on the write
+   // thread. at most max_pending_writes blocks may be queued before block acceptance waits on the write thread; when
+   // zero, entries are written on the main thread
+   named_thread_pool<struct shipwr>   write_thread_pool;
+   uint32_t                           max_pending_writes = 0;
+   std::mutex                         pending_writes_mtx;
+   std::condition_variable            pending_writes_cv;
+   uint32_t                           pending_writes = 0;     //protected by pending_writes_mtx
+   bool                               write_failed = false;   //protected by pending_writes_mtx
+   //blocks written on the write thread not yet passed to entries_written(), protected by pending_writes_mtx. a main
+   // thread task is only posted when this is empty, so writes completing while the main thread is busy coalesce. the
+   // lowest block is kept so a fork switch written in one batch still rewinds sessions to its first block
+   struct written_blocks {
+      block_num_type lowest_block_num;
+      block_num_type last_block_num;
+   };
+   std::optional<written_blocks>      unreported_written_blocks;
+   std::vector<std::function<void()>> queued_writes;          //entries of the block being accepted, main thread only
+   block_num_type                     log_head_block_num = 0; //last block whose entries are in the logs, main thread only
 
    struct connection_map_key_less {
       using is_transparent = void;
@@ -77,6 +102,17 @@ public:
    void plugin_shutdown();
 
    std::optional<chain::block_id_type> get_block_id(block_num_type block_num) {
+      if(std::optional<block_id_type> id = get_log_block_id(block_num))
+         return id;
+      try {
+         // not thread safe, only call from main application thread
+         return chain_plug->chain().chain_block_id_for_num(block_num);
+      } catch(...) {
+      }
+      return {};
+   }
+
+   std::optional<chain::block_id_type> get_log_block_id(block_num_type block_num) {
       if(trace_log) {
          if(std::optional<block_id_type> id = trace_log->get_block_id(block_num))
             return id;
@@ -89,11 +125,6 @@ public:
          if(std::optional<block_id_type> id = finality_data_log->get_block_id(block_num))
             return id;
       }
-      try {
-         // not thread safe, only call from main application thread
-         return chain_plug->chain().chain_block_id_for_num(block_num);
-      } catch(...) {
-      }
       return {};
    }
 
@@ -108,7 +139,7 @@ public:
             app().executor().post(priority::high, exec_queue::read_write, [this, socket{std::move(socket)}]() mutable {
                catch_and_log([this, &socket]() {
                   connections.emplace(new session(std::move(socket), chain_plug->chain(),
-                                                  trace_log, chain_state_log, finality_data_log,
+                                                  trace_log, chain_state_log, finality_data_log, *entry_cache, log_head_block_num,
                                                   [this](const chain::block_num_type block_num) {
                                                      return get_block_id(block_num);
                                                   },
@@ -152,7 +183,13 @@ public:
          store_traces(block, id);
          store_chain_state(id, block->previous, block->block_num());
          store_finality_data(id, block->previous);
+         if(max_pending_writes) {
+            //sessions are notified once the write thread has written the entries
+            post_queued_writes(block->block_num());
+            return;
+         }
       } catch(const fc::exception& e) {
+         queued_writes.clear();
          fc_elog(_log, "fc::exception: ${details}", ("details", e.to_detail_string()));
          // Both app().quit() and exception throwing are required. Without app().quit(),
          // the exception would be caught and drop before reaching main(). The exception is
@@ -164,8 +201,96 @@ public:
              "the process");
       }
 
+      entries_written(block->block_num(), block->block_num());
+   }
+
+   void entries_written(block_num_type lowest_block_num, block_num_type last_block_num) {
+      log_head_block_num = last_block_num;
       for(const std::unique_ptr<session_base>& c : connections)
-         c->block_applied(block->block_num());
+         c->block_applied(lowest_block_num, last_block_num);
+   }
+
+   template <typename F>
+   void write_entry(log_catalog& log, const block_id_type& id, const block_id_type& previous_id, F&& pack_to) {
+      if(!max_pending_writes) {
+         log.pack_and_write_entry(id, previous_id, pack_to);
+         return;
+      }
+
+      auto payload = std::make_shared<std::vector<char>>();
+      bio::filtering_ostreambuf buf(bio::back_inserter(*payload));
+      pack_to(buf);
+      bio::close(buf);
+      queued_writes.emplace_back([&log, id, previous_id, payload]() {
+         log.pack_and_write_entry(id, previous_id, [&payload](bio::filtering_ostreambuf& buf) {
+            bio::write(buf, payload->data(), payload->size());
+         });
+      });
+   }
+
+   void post_queued_writes(block_num_type block_num) {
+      {
+         std::unique_lock g(pending_writes_mtx);
+         pending_writes_cv.wait(g, [this]() { return pending_writes < max_pending_writes || write_failed; });
+         if(write_failed) {
+            queued_writes.clear();
+            return;
+         }
+         ++pending_writes;
+      }
+
+      boost::asio::post(write_thread_pool.get_executor(), [this, writes{std::move(queued_writes)}, block_num]() {
+         auto done = fc::make_scoped_exit([this]() {
+            std::lock_guard g(pending_writes_mtx);
+            --pending_writes;
+            pending_writes_cv.notify_all();
+         });
+         {
+            std::lock_guard g(pending_writes_mtx);
+            if(write_failed) //never write past an entry that failed to be written
+               return;
+         }
+         bool written = false;
+         catch_and_log([&]() {
+            for(const std::function<void()>& w : writes)
+               w();
+            written = true;
+         });
+         if(!written) {
+            fc_elog(_log, "State history encountered an Error which it cannot recover from.  Please resolve the error and relaunch the process");
+            {
+               std::lock_guard g(pending_writes_mtx);
+               write_failed = true;
+            }
+            app().quit();
+            return;
+         }
+         bool post_report;
+         {
+            std::lock_guard g(pending_writes_mtx);
+            post_report = !unreported_written_blocks;
+            if(post_report)
+               unreported_written_blocks = written_blocks{block_num, block_num};
+            else
+               unreported_written_blocks = written_blocks{std::min(unreported_written_blocks->lowest_block_num, block_num), block_num};
+         }
+         if(post_report)
+            app().executor().post(priority::high, exec_queue::read_write, [this]() {
+               std::optional<written_blocks> written;
+               {
+                  std::lock_guard g(pending_writes_mtx);
+                  written = std::exchange(unreported_written_blocks, std::nullopt);
+               }
+               if(written)
+                  entries_written(written->lowest_block_num, written->last_block_num);
+            });
+      });
+      queued_writes.clear();
+   }
+
+   void wait_for_pending_writes() {
+      std::unique_lock g(pending_writes_mtx);
+      pending_writes_cv.wait(g, [this]() { return pending_writes == 0; });
    }
 
    void on_block_start(uint32_t block_num) {
@@ -181,7 +306,7 @@ public:
       if(!trace_log)
          return;
 
-      trace_log->pack_and_write_entry(id, block->previous, [this, &block](bio::filtering_ostreambuf& buf) {
+      write_entry(*trace_log, id, block->previous, [this, &block](bio::filtering_ostreambuf& buf) {
          trace_converter.pack(buf, trace_debug_mode, block);
       });
    }
@@ -190,12 +315,21 @@ public:
       if(!chain_state_log)
          return;
       bool fresh = chain_state_log->empty();
+      if(fresh && max_pending_writes) { //entries already queued may be about to make the log non-empty
+         wait_for_pending_writes();
+         fresh = chain_state_log->empty();
+      }
       if(fresh)
          fc_ilog(_log, "Placing initial state in block ${n}", ("n", block_num));
 
-      chain_state_log->pack_and_write_entry(id, previous_id, [this, fresh](bio::filtering_ostreambuf& buf) {
+      auto pack_to = [this, fresh](bio::filtering_ostreambuf& buf) {
          pack_deltas(buf, chain_plug->chain().db(), fresh);
-      });
+      };
+      //the initial state can be very large; stream it straight to the log instead of buffering it for the write thread
+      if(fresh)
+         chain_state_log->pack_and_write_entry(id, previous_id, pack_to);
+      else
+         write_entry(*chain_state_log, id, previous_id, pack_to);
    } // store_chain_state
 
    void store_finality_data(const block_id_type& id, const block_id_type& previous_id) {
@@ -204,11 +338,14 @@ public:
 
       std::optional<finality_data_t> finality_data = chain_plug->chain().head_finality_data();
       if(!finality_data.has_value()) {
-         finality_data_log->clear();
+         if(max_pending_writes)
+            queued_writes.emplace_back([this]() { finality_data_log->clear(); });
+         else
+            finality_data_log->clear();
          return;
       }
 
-      finality_data_log->pack_and_write_entry(id, previous_id, [finality_data](bio::filtering_ostreambuf& buf) {
+      write_entry(*finality_data_log, id, previous_id, [finality_data](bio::filtering_ostreambuf& buf) {
          fc::datastream<boost::iostreams::filtering_ostreambuf&> ds{buf};
          fc::raw::pack(ds, *finality_data);
       });
@@ -250,6 +387,15 @@ void state_history_plugin::set_program_options(options_description& cli, options
            "the path (relative to data-dir) to create a unix socket upon which to listen for incoming connections.");
    options("trace-history-debug-mode", bpo::bool_switch()->default_value(false), "enable debug mode for trace history");
    options("state-history-log-retain-blocks", bpo::value<uint32_t>(), "if set, periodically prune the state history files to store only configured number of most recent blocks");
+   options("state-history-log-codec", bpo::value<string>()->default_value("zlib"),
+           "encoding of newly written state history log entries:\n"
+           "  \"zlib\" - zlib stream, readable by all versions\n"
+           "  \"raw\"  - stored as-is; faster to write and to stream to clients, not readable by older versions");
+   options("state-history-entry-cache-size-mb", bpo::value<uint32_t>()->default_value(64),
+           "the size (MiB) of the cache of decompressed log entries shared by all state history connections. 0 disables the cache");
+   options("state-history-write-queue-size", bpo::value<uint32_t>()->default_value(8),
+           "the maximum number of blocks whose state history entries may be waiting on the write thread before block acceptance "
+           "waits for it. 0 writes the entries on the main thread");
 }
 
 void state_history_plugin_impl::plugin_initialize(const variables_map& options) {
@@ -328,12 +474,31 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
             config.max_retained_files = options.at("max-retained-history-files").as<uint32_t>();
       }
 
+      const std::string& codec_str = options.at("state-history-log-codec").as<string>();
+      EOS_ASSERT(codec_str == "zlib" || codec_str == "raw", plugin_exception, "state-history-log-codec must be \"zlib\" or \"raw\"");
+      const ship_log_codec codec = codec_str == "raw" ? ship_log_codec::raw : ship_log_codec::zlib;
+
+      entry_cache.emplace(uint64_t(options.at("state-history-entry-cache-size-mb").as<uint32_t>()) * 1024 * 1024);
+      max_pending_writes = options.at("state-history-write-queue-size").as<uint32_t>();
+      //the chain can only be queried on the main thread; when writing on the write thread only the logs are consulted for the
+      // id of a block preceding an entry
+      state_history_log::non_local_get_block_id_func non_local_get_block_id = [this](chain::block_num_type bn) {return get_block_id(bn);};
+      if(max_pending_writes)
+         non_local_get_block_id = [this](chain::block_num_type bn) {return get_log_block_id(bn);};
+
       if(options.at("trace-history").as<bool>())
-         trace_log.emplace(state_history_dir, ship_log_conf, "trace_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         trace_log.emplace(state_history_dir, ship_log_conf, "trace_history", non_local_get_block_id, codec);
       if(options.at("chain-state-history").as<bool>())
-         chain_state_log.emplace(state_history_dir, ship_log_conf, "chain_state_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         chain_state_log.emplace(state_history_dir, ship_log_conf, "chain_state_history", non_local_get_block_id, codec);
       if(options.at("finality-data-history").as<bool>())
-         finality_data_log.emplace(state_history_dir, ship_log_conf, "finality_data_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         finality_data_log.emplace(state_history_dir, ship_log_conf, "finality_data_history", non_local_get_block_id, codec);
+
+      //blocks may be accepted (e.g. during replay) before plugin_startup()
+      if(max_pending_writes)
+         write_thread_pool.start(1, [](const fc::exception& e) {
+            fc_elog( _log, "Exception in SHiP write thread, exiting: ${e}", ("e", e.to_detail_string()) );
+            app().quit();
+         });
    }
    FC_LOG_AND_RETHROW()
 } // state_history_plugin::plugin_initialize
@@ -347,6 +512,13 @@ void state_history_plugin_impl::plugin_startup() {
    const auto& chain = chain_plug->chain();
 
    uint32_t block_num = chain.head().block_num();
+   wait_for_pending_writes();
+   {
+      //reports of writes made before now may still be queued on the main thread, they must not override block_num
+      std::lock_guard g(pending_writes_mtx);
+      unreported_written_blocks.reset();
+   }
+   log_head_block_num = block_num;
    if( block_num > 0 && chain_state_log && chain_state_log->empty() ) {
       fc_ilog( _log, "Storing initial state on startup, this can take a considerable amount of time" );
       store_chain_state( chain.head().id(), chain.head().header().previous, block_num );
@@ -382,6 +554,8 @@ void state_history_plugin::plugin_startup() {
 
 void state_history_plugin_impl::plugin_shutdown() {
    fc_dlog(_log, "stopping");
+   wait_for_pending_writes();
+   write_thread_pool.stop();
    thread_pool.stop();
    fc_dlog(_log, "exit shutdown");
 }
@@ -109,6 +109,14 @@ void blocklog_actions::setup(CLI::App& app) {
    merge_blocks->add_option("--blocks-dir", opt->blocks_dir, "The location of the blocks directory (absolute path or relative to the current directory).");
    merge_blocks->add_option("--output-dir", opt->output_dir, "The output directory for the merged block log.")->required();
 
+   // subcommand - compress
+   auto* compress = sub->add_subcommand("compress", "Write a copy of blocks.log and blocks.index in 'blocks-dir' with each block compressed to 'output-dir'.")->callback([err_guard]() { err_guard(&blocklog_actions::compress_blocks); });
+   compress->add_option("--output-dir", opt->output_dir, "The output directory for the compressed block log.")->required();
+
+   // subcommand - decompress
+   auto* decompress = sub->add_subcommand("decompress", "Write a copy of the compressed blocks.log and blocks.index in 'blocks-dir' to 'output-dir' without compression.")->callback([err_guard]() { err_guard(&blocklog_actions::decompress_blocks); });
+   decompress->add_option("--output-dir", opt->output_dir, "The output directory for the decompressed block log.")->required();
+
    // subcommand - smoke test
    sub->add_subcommand("smoke-test", "Quick test that blocks.log and blocks.index are well formed and agree with each other.")->callback([err_guard]() { err_guard(&blocklog_actions::smoke_test); });
 
@@ -380,4 +388,18 @@ int blocklog_actions::split_blocks() {
 int blocklog_actions::merge_blocks() {
    block_log::merge_blocklogs(opt->blocks_dir, opt->output_dir);
    return 0;
+}
+
+int blocklog_actions::compress_blocks() {
+   report_time rt("compressing block log");
+   block_log::convert_blocklog(opt->blocks_dir, opt->output_dir, true);
+   rt.report();
+   return 0;
+}
+
+int blocklog_actions::decompress_blocks() {
+   report_time rt("decompressing block log");
+   block_log::convert_blocklog(opt->blocks_dir, opt->output_dir, false);
+   rt.report();
+   return 0;
 }
\ No newline at end of file
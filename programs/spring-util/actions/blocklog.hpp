@@ -43,4 +43,6 @@ protected:
 
    int split_blocks();
    int merge_blocks();
+   int compress_blocks();
+   int decompress_blocks();
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <fc/io/json.hpp>
 #include <fc/variant.hpp>
 
+#include <chainbase/chainbase.hpp>
 #include <chainbase/environment.hpp>
 
 #include <boost/exception/diagnostic_information.hpp>
@@ -43,6 +44,28 @@ void chain_actions::setup(CLI::App& app) {
       // properly return err code in main
       if(rc) throw(CLI::RuntimeError(rc));
    });
+
+  sub->add_subcommand("release-free-memory", "release the disk blocks backing free memory of a cleanly shut down state database; "
+                                             "objects are not relocated and the file keeps its apparent size")->callback([&]() {
+      int rc = run_subcommand_release_free_memory();
+      // properly return err code in main
+      if(rc) throw(CLI::RuntimeError(rc));
+   });
+}
+
+std::filesystem::path chain_actions::state_dir() const {
+   // default state dir, if none specified
+   if(opt->sstate_state_dir.empty()) {
+      auto root = fc::app_path();
+      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
+      return default_data_dir / config::default_state_dir_name;
+   }
+   // adjust if path relative
+   std::filesystem::path state_dir = opt->sstate_state_dir;
+   if(state_dir.is_relative()) {
+      state_dir = std::filesystem::current_path() / state_dir;
+   }
+   return state_dir;
 }
 
 int chain_actions::run_subcommand_build() {
@@ -62,21 +85,7 @@ int chain_actions::run_subcommand_build() {
 }
 
 int chain_actions::run_subcommand_sstate() {
-   std::filesystem::path state_dir = "";
-
-   // default state dir, if none specified
-   if(opt->sstate_state_dir.empty()) {
-      auto root = fc::app_path();
-      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
-      state_dir  = default_data_dir / config::default_state_dir_name;
-   }
-   else {
-      // adjust if path relative
-      state_dir = opt->sstate_state_dir;
-      if(state_dir.is_relative()) {
-         state_dir = std::filesystem::current_path() / state_dir;
-      }
-   }
+   const std::filesystem::path state_dir = this->state_dir();
 
    const auto shared_mem_path = state_dir / "shared_memory.bin";
 
@@ -96,4 +105,26 @@ int chain_actions::run_subcommand_sstate() {
 
    std::cout << "Database state is clean" << std::endl;
    return 0;
-}
\ No newline at end of file
+}
+
+int chain_actions::run_subcommand_release_free_memory() {
+   const std::filesystem::path state_dir = this->state_dir();
+
+   if(!std::filesystem::exists(state_dir / "shared_memory.bin")) {
+      std::cerr << "No database found in \"" << state_dir.generic_string() << "\"" << std::endl;
+      return -1;
+   }
+
+   try {
+      // opening in `mapped` mode punches holes in the database file for every free page
+      chainbase::database db(state_dir, chainbase::database::read_write, 0, false, chainbase::pinnable_mapped_file::map_mode::mapped);
+      const size_t released = db.release_free_memory();
+      std::cout << "Released " << released / (1024*1024) << " MiB of the \"" << state_dir.generic_string() << "\" database file, "
+                << db.get_free_memory() / (1024*1024) << " MiB free" << std::endl;
+   }
+   catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return -1;
+   }
+   return 0;
+}
@@ -1,4 +1,5 @@
 #include "subcommand.hpp"
+#include <filesystem>
 
 struct chain_options {
    bool build_just_print = false;
@@ -14,4 +15,8 @@ public:
    // callbacks
    int run_subcommand_build();
    int run_subcommand_sstate();
+   int run_subcommand_release_free_memory();
+
+private:
+   std::filesystem::path state_dir() const;
 };
\ No newline at end of file
@@ -73,12 +73,9 @@ int snapshot_actions::run_tojson() {
       chain_id = chain_id_type(opt->chain_id);
    }
    else { // try to retrieve it
-      auto infile = std::ifstream(snapshot_path.generic_string(),
-                               (std::ios::in | std::ios::binary));
-      istream_snapshot_reader reader(infile);
+      threaded_snapshot_reader reader(snapshot_path);
       reader.validate();
       chain_id = controller::extract_chain_id(reader);
-      infile.close();
    }
 
    // setup controller
@@ -98,9 +95,7 @@ int snapshot_actions::run_tojson() {
    protocol_feature_set pfs = initialize_protocol_features( std::filesystem::path("protocol_features"), false );
 
    try {
-      auto infile = std::ifstream(snapshot_path.generic_string(),
-                                  (std::ios::in | std::ios::binary));
-      auto reader = std::make_shared<istream_snapshot_reader>(infile);
+      auto reader = std::make_shared<threaded_snapshot_reader>(snapshot_path);
 
       auto check_shutdown = []() { return false; };
       auto shutdown = []() { throw; };
@@ -108,7 +103,6 @@ int snapshot_actions::run_tojson() {
       control.reset(new controller(cfg, std::move(pfs), chain_id));
       control->add_indices();
       control->startup(shutdown, check_shutdown, reader);
-      infile.close();
 
       ilog("Writing snapshot: ${s}", ("s", json_path));
       auto snap_out = std::ofstream(json_path.generic_string(), (std::ios::out));
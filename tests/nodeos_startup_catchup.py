@@ -73,6 +73,7 @@ try:
     specificExtraNodeosArgs[pnodes+13] = f' --sync-fetch-span 89 --read-mode irreversible '
     specificExtraNodeosArgs[pnodes+14] = f' --sync-fetch-span 150 --read-mode irreversible '
     specificExtraNodeosArgs[pnodes+15] = f' --sync-fetch-span 2500 --read-mode irreversible '
+    specificExtraNodeosArgs[pnodes+16] = f' --sync-fetch-span 21 --sync-striped true --sync-peer-limit 3 '
     if cluster.launch(prodCount=prodCount, specificExtraNodeosArgs=specificExtraNodeosArgs, activateIF=activateIF, onlyBios=False,
                       pnodes=pnodes, totalNodes=totalNodes, totalProducers=pnodes*prodCount, unstartedNodes=catchupCount,
                       loadSystemContract=True, maximumP2pPerHost=totalNodes+trxGeneratorCnt) is False:
@@ -250,6 +251,27 @@ try:
                     if endBlockNum > fhead and fhead > libNum and endBlockNum - fhead > (sync_fetch_span*2-1):
                         errorExit(f"Requested range too far head of fork head {fhead} sync-fetch-span {sync_fetch_span}: {line}")
 
+        if catchupNode.nodeId in specificExtraNodeosArgs and "sync-striped" in specificExtraNodeosArgs[catchupNode.nodeId]:
+            Print(f"Verify striped sync of {catchupNode.data_dir}")
+            sync_peer_limit = int(re.search(r"sync-peer-limit (\d+)", specificExtraNodeosArgs[catchupNode.nodeId]).group(1))
+            lines = catchupNode.linesInLog("requesting stripe")
+            if len(lines) == 0:
+                errorExit(f"No stripes requested by striped sync node {catchupNode.data_dir}")
+            for line in lines:
+                m = re.search(r"requesting stripe (\d+) to (\d+), head (\d+)", line)
+                if m is not None:
+                    startBlockNum=int(m.group(1))
+                    endBlockNum=int(m.group(2))
+                    headNum=int(m.group(3))
+                    if endBlockNum-startBlockNum >= sync_fetch_span:
+                        errorExit(f"Requested stripe exceeds sync-fetch-span {sync_fetch_span}: {line}")
+                    if endBlockNum > headNum + sync_fetch_span*(sync_peer_limit+1):
+                        errorExit(f"Requested stripe too far ahead of head {headNum}, sync-fetch-span {sync_fetch_span}: {line}")
+            # peers serving a stripe whose blocks are held for reassembly must not be timed out
+            lines = catchupNode.linesInLog("reassign_fetch of stripe")
+            if len(lines) > 0:
+                errorExit(f"Striped sync timed out on peers: {lines}")
+
         # See https://github.com/AntelopeIO/spring/issues/81 for fix to reduce the number of expected unlinkable blocks
         # Test verifies LIB is advancing, check to see that not too many unlinkable block exceptions are generated
         # while syncing up to head.
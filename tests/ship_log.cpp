@@ -11,7 +11,9 @@
 #include <fc/io/fstream.hpp>
 
 #include <eosio/state_history/log_catalog.hpp>
+#include <eosio/state_history/log_entry_cache.hpp>
 #include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/device/back_inserter.hpp>
 
 
@@ -663,6 +665,124 @@ BOOST_AUTO_TEST_CASE(regen_index) try {
    BOOST_REQUIRE_EQUAL(new_index_contents, old_index_contents);
 } FC_LOG_AND_RETHROW();
 
+BOOST_DATA_TEST_CASE(mixed_codecs, bdata::xrange(2), prune) try {
+   const fc::temp_directory tmpdir;
+
+   state_history::state_history_log_config conf;
+   if(prune)
+      conf = state_history::prune_config{.prune_blocks = 4, .prune_threshold = 8};
+
+   std::map<block_num_type, sha256> wrote_data_for_blocknum;
+   std::mt19937 mt_random(0xbeefbeefu);
+
+   //alternate between raw and zlib entries by reopening the log with a different codec every few blocks
+   for(unsigned i = 2; i < 26; ++i) {
+      const state_history::ship_log_codec codec = (i/4)%2 ? state_history::ship_log_codec::raw : state_history::ship_log_codec::zlib;
+      eosio::state_history::log_catalog lc(tmpdir.path(), conf, "mixed", state_history::state_history_log::no_non_local_get_block_id_func, codec);
+      lc.pack_and_write_entry(fake_blockid_for_num(i), fake_blockid_for_num(i-1), [&](bio::filtering_ostreambuf& obuf) {
+         bio::filtering_istreambuf hashed_randomness(sha256_filter() | bio::restrict(random_source(), 0, mt_random()%64*1024));
+         bio::copy(hashed_randomness, obuf);
+         wrote_data_for_blocknum[i] = hashed_randomness.component<sha256_filter>(0)->enc->result();
+      });
+   }
+
+   eosio::state_history::log_catalog lc(tmpdir.path(), conf, "mixed");
+   BOOST_REQUIRE_EQUAL(lc.block_range().second, 26u);
+   for(unsigned i = lc.block_range().first; i < 26; ++i) {
+      std::optional<state_history::ship_log_entry> entry = lc.get_entry(i);
+      BOOST_REQUIRE(!!entry);
+      BOOST_REQUIRE_EQUAL(entry->raw_payload, (i/4)%2 == 1);
+
+      bio::filtering_ostreambuf hashed_null(sha256_filter() | bio::null_sink());
+      bio::filtering_istreambuf log_stream = entry->get_stream();
+      BOOST_REQUIRE_EQUAL(bio::copy(log_stream, hashed_null), (std::streamsize)entry->get_uncompressed_size());
+      BOOST_REQUIRE_EQUAL(hashed_null.component<sha256_filter>(0)->enc->result(), wrote_data_for_blocknum[i]);
+   }
+} FC_LOG_AND_RETHROW();
+
+//get_blocks_request_v2 clients receive entries as stored: the zlib stream, or the payload itself for raw entries
+BOOST_AUTO_TEST_CASE(stored_entries) try {
+   const fc::temp_directory tmpdir;
+
+   std::map<block_num_type, sha256> wrote_data_for_blocknum;
+   std::mt19937 mt_random(0xfeedfeedu);
+
+   for(unsigned i = 2; i < 10; ++i) {
+      const state_history::ship_log_codec codec = i%2 ? state_history::ship_log_codec::raw : state_history::ship_log_codec::zlib;
+      eosio::state_history::log_catalog lc(tmpdir.path(), state_history::state_history_log_config(), "stored", state_history::state_history_log::no_non_local_get_block_id_func, codec);
+      lc.pack_and_write_entry(fake_blockid_for_num(i), fake_blockid_for_num(i-1), [&](bio::filtering_ostreambuf& obuf) {
+         bio::filtering_istreambuf hashed_randomness(sha256_filter() | bio::restrict(random_source(), 0, mt_random()%64*1024));
+         bio::copy(hashed_randomness, obuf);
+         wrote_data_for_blocknum[i] = hashed_randomness.component<sha256_filter>(0)->enc->result();
+      });
+   }
+
+   eosio::state_history::log_catalog lc(tmpdir.path(), state_history::state_history_log_config(), "stored");
+   for(unsigned i = 2; i < 10; ++i) {
+      std::optional<state_history::ship_log_entry> entry = lc.get_entry(i);
+      BOOST_REQUIRE(!!entry);
+      BOOST_REQUIRE_EQUAL(entry->raw_payload, i%2 == 1);
+
+      std::vector<char> stored;
+      bio::filtering_istreambuf stored_stream = entry->get_stored_stream();
+      bio::copy(stored_stream, bio::back_inserter(stored));
+      BOOST_REQUIRE_EQUAL(stored.size(), entry->compressed_data_size);
+
+      bio::filtering_ostreambuf hashed_null(sha256_filter() | bio::null_sink());
+      bio::filtering_istreambuf payload_stream;
+      if(!entry->raw_payload)
+         payload_stream.push(bio::zlib_decompressor());
+      payload_stream.push(bio::array_source(stored.data(), stored.size()));
+      BOOST_REQUIRE_EQUAL(bio::copy(payload_stream, hashed_null), (std::streamsize)entry->get_uncompressed_size());
+      BOOST_REQUIRE_EQUAL(hashed_null.component<sha256_filter>(0)->enc->result(), wrote_data_for_blocknum[i]);
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(entry_cache) try {
+   const fc::temp_directory tmpdir;
+
+   eosio::state_history::log_catalog lc(tmpdir.path(), std::monostate(), "cached");
+   std::map<block_num_type, std::vector<char>> wrote_data_for_blocknum;
+   auto write = [&](unsigned i, uint64_t salt) {
+      std::vector<char>& data = wrote_data_for_blocknum[i];
+      data.assign(1024, (char)(i + salt));
+      lc.pack_and_write_entry(fake_blockid_for_num(i, salt), fake_blockid_for_num(i-1), [&](bio::filtering_ostreambuf& obuf) {
+         bio::write(obuf, data.data(), data.size());
+      });
+   };
+   for(unsigned i = 2; i < 12; ++i)
+      write(i, 0);
+
+   //room for 4 entries
+   state_history::log_entry_cache cache(4*1024);
+   BOOST_REQUIRE_EQUAL(cache.max_entry_size(), 1024u);
+   using log_type = state_history::log_entry_cache::log_type;
+   auto get = [&](log_type type, unsigned i) {
+      std::optional<state_history::ship_log_entry> entry = lc.get_entry(i);
+      BOOST_REQUIRE(!!entry);
+      return cache.get(type, *entry);
+   };
+
+   state_history::log_entry_cache::contents_ptr first = get(log_type::trace, 2);
+   BOOST_REQUIRE(*first == wrote_data_for_blocknum[2]);
+   //same entry is served from the cache, but not for a different log type
+   BOOST_REQUIRE(get(log_type::trace, 2) == first);
+   BOOST_REQUIRE(get(log_type::chain_state, 2) != first);
+   BOOST_REQUIRE_EQUAL(cache.size_in_bytes(), 2*1024u);
+
+   //evicting the entry does not invalidate contents still referenced
+   for(unsigned i = 3; i < 12; ++i)
+      BOOST_REQUIRE(*get(log_type::trace, i) == wrote_data_for_blocknum[i]);
+   BOOST_REQUIRE_EQUAL(cache.size_in_bytes(), 4*1024u);
+   BOOST_REQUIRE(*first == wrote_data_for_blocknum[2]);
+   BOOST_REQUIRE(get(log_type::trace, 2) != first);
+
+   //a fork replacing a cached block must not be served the forked out entry
+   BOOST_REQUIRE(*get(log_type::trace, 11) == wrote_data_for_blocknum[11]);
+   write(11, 0xbeef);
+   BOOST_REQUIRE(*get(log_type::trace, 11) == wrote_data_for_blocknum[11]);
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(empty_empty_empty) try {
    //just opens and closes an empty log a few times
    const fc::temp_directory tmpdir;
@@ -34,6 +34,7 @@ int main(int argc, char* argv[]) {
    bool fetch_traces = false;
    bool fetch_deltas = false;
    bool fetch_finality_data = false;
+   uint32_t max_messages_in_flight = std::numeric_limits<u_int32_t>::max();
 
    cli.add_options()
       ("help,h", bpo::bool_switch(&help)->default_value(false), "Print this help message and exit.")
@@ -45,6 +46,7 @@ int main(int argc, char* argv[]) {
       ("fetch-traces", bpo::bool_switch(&fetch_traces)->default_value(fetch_traces), "Fetch traces")
       ("fetch-deltas", bpo::bool_switch(&fetch_deltas)->default_value(fetch_deltas), "Fetch deltas")
       ("fetch-finality-data", bpo::bool_switch(&fetch_finality_data)->default_value(fetch_finality_data), "Fetch finality data")
+      ("max-messages-in-flight", bpo::value<uint32_t>(&max_messages_in_flight)->default_value(max_messages_in_flight), "Credits of the request, each received block is acknowledged unless unlimited")
       ;
    bpo::variables_map varmap;
    bpo::store(bpo::parse_command_line(argc, argv, cli), varmap);
@@ -114,7 +116,7 @@ int main(int argc, char* argv[]) {
       const eosio::chain::bytes get_status_bytes = abi.variant_to_binary("request",
          fc::variants{"get_blocks_request_v1", mvo()("start_block_num", start_block_num)
                                                     ("end_block_num", std::to_string(end_block_num + 1)) // SHiP is (start-end] exclusive
-                                                    ("max_messages_in_flight",std::to_string(std::numeric_limits<u_int32_t>::max()))
+                                                    ("max_messages_in_flight",std::to_string(max_messages_in_flight))
                                                     ("have_positions", fc::variants{})
                                                     ("irreversible_only", irreversible_only)
                                                     ("fetch_block", fetch_block)
@@ -197,6 +199,12 @@ int main(int argc, char* argv[]) {
          }
 
          if( this_block_num == end_block_num ) break;
+
+         if( max_messages_in_flight != std::numeric_limits<u_int32_t>::max() ) {
+            const eosio::chain::bytes ack_bytes = abi.variant_to_binary("request",
+               fc::variants{"get_blocks_ack_request_v0", mvo()("num_messages", 1)}, null_yield_function);
+            stream.write(boost::asio::buffer(ack_bytes));
+         }
       }
 
       std::cout << "]" << std::endl;
@@ -154,9 +154,12 @@ try:
         outFile = open(f"{shipClientFilePrefix}{i}.out", "w")
         errFile = open(f"{shipClientFilePrefix}{i}.err", "w")
         Print(f"Start client {i}")
-        popen=Utils.delayedCheckOutput(cmd, stdout=outFile, stderr=errFile)
+        # every other client runs out of credits well within a window of blocks reserved per main thread visit and
+        # acknowledges each block it receives, the others have unlimited credits
+        clientCmd = cmd + " --max-messages-in-flight 3" if i % 2 else cmd
+        popen=Utils.delayedCheckOutput(clientCmd, stdout=outFile, stderr=errFile)
         starts.append(time.perf_counter())
-        clients.append((popen, cmd))
+        clients.append((popen, clientCmd))
         files.append((outFile, errFile))
         Print(f"Client {i} started, Ship node head is: {shipNode.getBlockNum()}")
 
@@ -2,6 +2,7 @@
 #include <eosio/testing/tester.hpp> // for fc_exception_message_contains
 
 #include <fc/io/cfile.hpp>
+#include <fc/io/fstream.hpp>
 
 #include <boost/test/unit_test.hpp>
 
@@ -40,6 +41,11 @@ struct block_log_get_block_fixture {
 
       // the serialized block should match the signed block's serialized form
       BOOST_REQUIRE(serialized_block == fc::raw::pack(*block));
+
+      // the block view references the same serialized block
+      block_view view = blog.read_block_view_by_num(block_num);
+      BOOST_REQUIRE(std::ranges::equal(view.packed, serialized_block));
+      BOOST_REQUIRE_EQUAL(view.unpack()->calculate_id(), block->calculate_id());
    }
 
    fc::temp_directory        dir;
@@ -76,12 +82,82 @@ BOOST_FIXTURE_TEST_CASE(splitted_block_log, block_log_get_block_fixture) try {
    test_read_serialized_block(blog, stride + 1);
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(compressed_block_log, block_log_get_block_fixture) try {
+   log.reset();
+   const auto compressed_dir   = block_dir / "compressed";
+   const auto decompressed_dir = block_dir / "decompressed";
+   block_log::convert_blocklog(block_dir, compressed_dir, true);
+
+   {
+      block_log blog(block_dir);
+      block_log clog(compressed_dir, compressed_blocklog_config{});
+      for (uint32_t n = 1; n <= last_block_num; ++n) {
+         BOOST_REQUIRE(clog.read_serialized_block_by_num(n) == blog.read_serialized_block_by_num(n));
+         BOOST_REQUIRE_EQUAL(*clog.read_block_id_by_num(n), *blog.read_block_id_by_num(n));
+      }
+      test_read_serialized_block(clog, last_block_num - 2);
+
+      // appended blocks are compressed too
+      auto p = signed_block::create_mutable_block({});
+      p->previous._hash[0] = fc::endian_reverse_u32(last_block_num);
+      auto sp = signed_block::create_signed_block(std::move(p));
+      blog.append(sp, sp->calculate_id());
+      clog.append(sp, sp->calculate_id());
+      test_read_serialized_block(clog, last_block_num + 1);
+   }
+
+   // an uncompressed log cannot be opened in compressed mode
+   BOOST_CHECK_EXCEPTION(block_log(block_dir, compressed_blocklog_config{}), block_log_exception,
+                         fc_exception_message_contains("is not compressed"));
+
+   block_log::convert_blocklog(compressed_dir, decompressed_dir, false);
+   auto read_file = [](const std::filesystem::path& p) {
+      std::string content;
+      fc::read_file_contents(p, content);
+      return content;
+   };
+   BOOST_REQUIRE(read_file(decompressed_dir / "blocks.log") == read_file(block_dir / "blocks.log"));
+   BOOST_REQUIRE(read_file(decompressed_dir / "blocks.index") == read_file(block_dir / "blocks.index"));
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE(nonexisting_block_num, block_log_get_block_fixture) try {
    // read a non-existing block
    auto serialized_block = log->read_serialized_block_by_num(last_block_num + 1);
 
    // should return an empty vector of char
    BOOST_REQUIRE(serialized_block.empty());
+   BOOST_REQUIRE(log->read_block_view_by_num(last_block_num + 1).empty());
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(block_view_outlives_log, block_log_get_block_fixture) try {
+   block_view view = log->read_block_view_by_num(last_block_num);
+   const std::vector<char> expected(view.packed.begin(), view.packed.end());
+
+   // blocks appended after the file was mapped are readable through a remapped view
+   auto p = signed_block::create_mutable_block({});
+   p->previous._hash[0] = fc::endian_reverse_u32(last_block_num);
+   auto sp = signed_block::create_signed_block(std::move(p));
+   log->append(sp, sp->calculate_id());
+   BOOST_REQUIRE(std::ranges::equal(log->read_block_view_by_num(last_block_num + 1).packed, sp->packed_signed_block()));
+
+   // the earlier view keeps its mapping after the block log is closed
+   log.reset();
+   BOOST_REQUIRE(std::ranges::equal(view.packed, expected));
+   BOOST_REQUIRE_EQUAL(view.unpack()->block_num(), last_block_num);
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(block_view_outlives_reset, block_log_get_block_fixture) try {
+   block_view view = log->read_block_view_by_num(last_block_num);
+   const std::vector<char> expected(view.packed.begin(), view.packed.end());
+
+   // the new log file ends pages before the view
+   const auto log_size = std::filesystem::file_size(block_dir / "blocks.log");
+   log->reset(genesis_state().compute_chain_id(), last_block_num + 100);
+   BOOST_REQUIRE(!log->head());
+   BOOST_REQUIRE_LT(std::filesystem::file_size(block_dir / "blocks.log"), log_size / 2);
+
+   BOOST_REQUIRE(std::ranges::equal(view.packed, expected));
+   BOOST_REQUIRE_EQUAL(view.unpack()->block_num(), last_block_num);
 } FC_LOG_AND_RETHROW()
 
 BOOST_FIXTURE_TEST_CASE(corrupted_next_block_position, block_log_get_block_fixture) try {
@@ -947,6 +947,17 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( transaction_metadata_test, T, validating_testers
       BOOST_CHECK_EQUAL(1u, keys3.size());
       BOOST_CHECK_EQUAL(public_key, *keys3.begin());
 
+      // recovered in two chunks, futures are in the order of the passed transactions
+      auto futs = transaction_metadata::start_recover_keys( { ptrx, ptrx2, ptrx }, thread_pool.get_executor(), 2, test.get_chain_id(), fc::microseconds::maximum(), transaction_metadata::trx_type::input );
+      BOOST_REQUIRE_EQUAL(3u, futs.size());
+      for( auto& f : futs ) {
+         auto m = f.get();
+         BOOST_CHECK_EQUAL(trx.id(), m->id());
+         BOOST_CHECK_EQUAL(1u, m->recovered_keys().size());
+         BOOST_CHECK_EQUAL(public_key, *m->recovered_keys().begin());
+      }
+      BOOST_CHECK(transaction_metadata::start_recover_keys( std::vector<packed_transaction_ptr>{}, thread_pool.get_executor(), 2, test.get_chain_id(), fc::microseconds::maximum(), transaction_metadata::trx_type::input ).empty());
+
       thread_pool.stop();
 
 } FC_LOG_AND_RETHROW() }
@@ -1,4 +1,5 @@
 #include <sstream>
+#include <thread>
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/global_property_object.hpp>
@@ -244,4 +245,40 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( test_light_validation_restart_from_block_log, T,
    check_action_traces(trace->action_traces.at(1), other_trace->action_traces.at(1));
 }
 
+// Simulates a crash by restarting from a copy of the data directories taken while the chain is running. With
+// database-map-mode = mapped_private the state file on disk only changes at checkpoints, so the copy holds the state
+// as of the last checkpoint, at a revision ahead of the fork database root recorded in chain_head.dat.
+BOOST_AUTO_TEST_CASE( test_restart_from_state_checkpoint ) {
+   fc::temp_directory tempdir;
+   tester chain(tempdir, [](controller::config& cfg) {
+      cfg.db_map_mode = chainbase::pinnable_mapped_file::map_mode::mapped_private;
+      cfg.state_checkpoint_interval_sec = 1;
+   }, true);
+
+   chain.create_account("checkpoint1"_n);
+   auto account_block = chain.produce_block();
+   std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+   chain.produce_blocks(4); // advances LIB past account_block, taking a checkpoint
+   BOOST_REQUIRE_GT(chain.head().block_num(), chain.last_irreversible_block_num());
+
+   fc::temp_directory crashed_dir;
+   controller::config crashed_config = chain.get_config();
+   crashed_config.blocks_dir     = crashed_dir.path() / config::default_blocks_dir_name;
+   crashed_config.state_dir      = crashed_dir.path() / config::default_state_dir_name;
+   crashed_config.finalizers_dir = crashed_dir.path() / config::default_finalizers_dir_name;
+   std::filesystem::copy(chain.get_config().blocks_dir, crashed_config.blocks_dir, std::filesystem::copy_options::recursive);
+   std::filesystem::copy(chain.get_config().state_dir, crashed_config.state_dir, std::filesystem::copy_options::recursive);
+
+   if (!std::filesystem::exists(crashed_config.state_dir / config::chain_head_filename)) {
+      BOOST_TEST_MESSAGE("Soft-Dirty page tracking not supported, no state checkpoint was taken");
+      return;
+   }
+   BOOST_REQUIRE(!std::filesystem::exists(crashed_config.blocks_dir / config::reversible_blocks_dir_name / config::fork_db_filename));
+
+   tester crashed_chain(crashed_config);
+   BOOST_REQUIRE_GE(crashed_chain.head().block_num(), account_block->block_num());
+   BOOST_REQUIRE_NO_THROW(crashed_chain.get_account("checkpoint1"_n));
+   crashed_chain.produce_block();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
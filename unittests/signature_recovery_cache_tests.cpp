@@ -0,0 +1,45 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/chain/signature_recovery_cache.hpp>
+#include <eosio/testing/tester.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+
+BOOST_AUTO_TEST_SUITE(signature_recovery_cache_tests)
+
+BOOST_AUTO_TEST_CASE( recover_test ) {
+   signature_recovery_cache cache;
+   const auto priv_key = base_tester::get_private_key( "alice"_n, "active" );
+   const auto digest = digest_type::hash( std::string("message") );
+   const auto other_digest = digest_type::hash( std::string("other message") );
+   const auto sig = priv_key.sign( digest );
+
+   BOOST_TEST( cache.recover( sig, digest ) == priv_key.get_public_key() );
+   BOOST_TEST( cache.size() == 1u );
+   BOOST_TEST( cache.recover( sig, digest ) == priv_key.get_public_key() ); // cached
+   BOOST_TEST( cache.size() == 1u );
+
+   // keyed by digest and signature, a different digest recovers a different key
+   BOOST_TEST( cache.recover( sig, other_digest ) == public_key_type( sig, other_digest ) );
+   BOOST_TEST( cache.size() == 2u );
+
+   cache.set_max_size( 0 );
+   BOOST_TEST( cache.size() == 0u );
+   BOOST_TEST( cache.recover( sig, digest ) == priv_key.get_public_key() );
+   BOOST_TEST( cache.size() == 0u );
+}
+
+BOOST_AUTO_TEST_CASE( eviction_test ) {
+   signature_recovery_cache cache;
+   cache.set_max_size( 16 ); // one entry per shard
+   const auto priv_key = base_tester::get_private_key( "alice"_n, "active" );
+   for( uint32_t i = 0; i < 100; ++i ) {
+      const auto digest = digest_type::hash( std::to_string(i) );
+      BOOST_TEST( cache.recover( priv_key.sign( digest ), digest ) == priv_key.get_public_key() );
+      BOOST_TEST( cache.size() <= 16u );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -224,4 +224,29 @@ struct threaded_snapshot_suite {
    inline static unsigned           next_tempfile;
 };
 
-using snapshot_suites = boost::mpl::list<variant_snapshot_suite, buffered_snapshot_suite, json_snapshot_suite, threaded_snapshot_suite>;
+struct compressed_snapshot_suite : threaded_snapshot_suite {
+   using writer_t = ostream_compressed_snapshot_writer;
+
+   struct writer : public writer_t {
+      writer( const std::shared_ptr<write_storage_t>& storage ) : writer_t(*storage), storage(storage) {}
+
+      std::shared_ptr<write_storage_t> storage;
+      std::filesystem::path            path;
+   };
+
+   static auto get_writer() {
+      const std::filesystem::path new_snap_path = threaded_snapshot_tempdir.path() / (std::to_string(next_tempfile++) + ".bin");
+
+      std::shared_ptr<writer> new_writer = std::make_shared<writer>(std::make_shared<write_storage_t>(new_snap_path, std::ios::binary));
+      new_writer->path = new_snap_path;
+      return new_writer;
+   }
+
+   static auto finalize(const std::shared_ptr<writer>& w) {
+      w->finalize();
+      w->storage->flush();
+      return w->path;
+   }
+};
+
+using snapshot_suites = boost::mpl::list<variant_snapshot_suite, buffered_snapshot_suite, json_snapshot_suite, threaded_snapshot_suite, compressed_snapshot_suite>;
@@ -5,6 +5,7 @@
 #include <test_contracts.hpp>
 #include <eosio/state_history/abi.hpp>
 #include <eosio/state_history/create_deltas.hpp>
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log_catalog.hpp>
 #include <eosio/state_history/trace_converter.hpp>
 #include <eosio/testing/tester.hpp>
@@ -967,4 +968,66 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(test_curropted_index_error, T, state_history_teste
    BOOST_CHECK(get_decompressed_entry(new_chain.chain_state_log,10).size());
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_filtered_entries, T, state_history_testers) {
+   fc::temp_directory state_history_dir;
+
+   eosio::state_history::partition_config config{};
+
+   T chain(state_history_dir.path(), config);
+   chain.produce_block();
+   chain.create_account("tester"_n);
+   chain.set_code("tester"_n, test_contracts::get_table_test_wasm());
+   chain.set_abi("tester"_n, test_contracts::get_table_test_abi());
+   chain.produce_block();
+
+   chain.create_account("alice"_n);
+   chain.push_action("tester"_n, "addhashobj"_n, "tester"_n, mutable_variant_object()("hashinput", "hello"));
+   chain.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 2));
+   chain.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 3));
+   chain.produce_block();
+   const block_num_type block_num = chain.head().block_num();
+
+   abi_serializer shipabi = abi_serializer(json::from_string(eosio::state_history::ship_abi_without_tables()).as<abi_def>(), null_yield_function);
+
+   const std::vector<char> traces = get_decompressed_entry(chain.traces_log, block_num);
+   BOOST_REQUIRE(traces.size());
+   BOOST_CHECK(eosio::state_history::filter_traces(traces.data(), traces.size(), {}) == traces);
+
+   const std::vector<char> filtered_traces = eosio::state_history::filter_traces(traces.data(), traces.size(), {{"tester"_n, "addnumobj"_n}});
+   const variants trace_variants = shipabi.binary_to_variant("transaction_trace[]", filtered_traces, null_yield_function).get_array();
+   BOOST_REQUIRE_EQUAL(trace_variants.size(), 2u);
+   for(const fc::variant& trace : trace_variants) {
+      const variants& action_traces = trace[1ul]["action_traces"].get_array();
+      BOOST_REQUIRE_EQUAL(action_traces.size(), 1u);
+      BOOST_CHECK_EQUAL(action_traces[0ul][1ul]["act"]["account"].get_string(), "tester");
+      BOOST_CHECK_EQUAL(action_traces[0ul][1ul]["act"]["name"].get_string(), "addnumobj");
+   }
+   BOOST_CHECK_EQUAL(shipabi.binary_to_variant("transaction_trace[]",
+                                               eosio::state_history::filter_traces(traces.data(), traces.size(), {{"tester"_n, {}}}),
+                                               null_yield_function).size(), 3u);
+
+   const std::vector<char> deltas = get_decompressed_entry(chain.chain_state_log, block_num);
+   BOOST_REQUIRE(deltas.size());
+
+   const std::vector<char> filtered_deltas = eosio::state_history::filter_deltas(deltas.data(), deltas.size(), {{"tester"_n, "numobjs"_n}});
+   const variants delta_variants = shipabi.binary_to_variant("table_delta[]", filtered_deltas, null_yield_function).get_array();
+   BOOST_REQUIRE(delta_variants.size());
+   size_t num_rows = 0;
+   for(const fc::variant& delta : delta_variants) {
+      const std::string name = delta[1ul]["name"].get_string();
+      BOOST_REQUIRE(name.starts_with("contract_"));
+      for(const fc::variant& row : delta[1ul]["rows"].get_array()) {
+         const fc::variant contents = shipabi.binary_to_variant(name, row["data"].as<bytes>(), null_yield_function);
+         BOOST_CHECK_EQUAL(contents[1ul]["code"].get_string(), "tester");
+         BOOST_CHECK(contents[1ul]["table"].get_string().starts_with("numobjs"));
+         ++num_rows;
+      }
+   }
+   BOOST_CHECK(num_rows >= 2u);
+
+   BOOST_CHECK_EQUAL(shipabi.binary_to_variant("table_delta[]",
+                                               eosio::state_history::filter_deltas(deltas.data(), deltas.size(), {{"alice"_n, {}}}),
+                                               null_yield_function).size(), 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
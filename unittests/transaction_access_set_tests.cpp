@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/chain/transaction_access_set.hpp>
+#include <eosio/testing/tester.hpp>
+
+#include <test_contracts.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+using mvo = fc::mutable_variant_object;
+
+BOOST_AUTO_TEST_SUITE(transaction_access_set_tests)
+
+BOOST_AUTO_TEST_CASE( conflicts_test ) {
+   transaction_access_set reader, writer, other_writer, payer;
+   reader.record_read( "code"_n, "scope"_n, "table"_n );
+   writer.record_write( "code"_n, "scope"_n, "table"_n );
+   other_writer.record_write( "code"_n, "other"_n, "table"_n );
+   payer.record_account( "alice"_n );
+
+   BOOST_TEST( !reader.conflicts_with( reader ) );       // reads never conflict
+   BOOST_TEST( reader.conflicts_with( writer ) );
+   BOOST_TEST( writer.conflicts_with( reader ) );
+   BOOST_TEST( writer.conflicts_with( writer ) );
+   BOOST_TEST( !writer.conflicts_with( other_writer ) ); // different scope
+   BOOST_TEST( !reader.conflicts_with( payer ) );
+   BOOST_TEST( payer.conflicts_with( payer ) );
+
+   transaction_access_set serial;
+   serial.mark_serial();
+   BOOST_TEST( serial.conflicts_with( transaction_access_set{} ) );
+   BOOST_TEST( transaction_access_set{}.conflicts_with( serial ) );
+
+   transaction_access_set merged;
+   merged.merge( reader );
+   merged.merge( other_writer );
+   BOOST_TEST( merged.conflicts_with( writer ) );
+   BOOST_TEST( !merged.conflicts_with( payer ) );
+   merged.clear();
+   BOOST_TEST( merged.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( partition_test ) {
+   transaction_access_set a, b, c, serial;
+   a.record_write( "code"_n, "a"_n, "table"_n );
+   b.record_write( "code"_n, "b"_n, "table"_n );
+   c.record_read( "code"_n, "a"_n, "table"_n );
+   serial.mark_serial();
+
+   using batches_t = std::vector<std::vector<size_t>>;
+   {
+      std::vector<const transaction_access_set*> trxs{ &a, &b, &c, &b, &a };
+      // c reads what a writes, the second b and a conflict with the first ones
+      BOOST_CHECK( partition_conflict_free( trxs ) == (batches_t{ {0, 1}, {2, 3}, {4} }) );
+   }
+   {
+      std::vector<const transaction_access_set*> trxs{ &a, &serial, &b, nullptr, &b, &a };
+      // no transaction moves across a serial or unknown one
+      BOOST_CHECK( partition_conflict_free( trxs ) == (batches_t{ {0}, {1}, {2}, {3}, {4, 5} }) );
+   }
+   BOOST_TEST( partition_conflict_free( {} ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( record_test ) try {
+   fc::temp_directory tempdir;
+   tester chain( tempdir, []( controller::config& cfg ) { cfg.record_trx_access_sets = true; }, true );
+   chain.execute_setup_policy( setup_policy::full );
+
+   chain.create_accounts( { "eosio.token"_n, "alice"_n, "bob"_n, "carol"_n, "dave"_n } );
+   chain.set_code( "eosio.token"_n, test_contracts::eosio_token_wasm() );
+   chain.set_abi( "eosio.token"_n, test_contracts::eosio_token_abi() );
+   chain.produce_block();
+
+   auto trace = chain.push_action( "eosio.token"_n, "create"_n, "eosio.token"_n,
+                                   mvo()("issuer", "eosio.token")("maximum_supply", "1000000.0000 CUR") );
+   BOOST_REQUIRE( trace->access_set );
+   BOOST_TEST( !trace->access_set->is_serial() );
+   chain.push_action( "eosio.token"_n, "issue"_n, "eosio.token"_n,
+                      mvo()("to", "eosio.token")("quantity", "200.0000 CUR")("memo", "") );
+   for( auto to : { "alice"_n, "carol"_n } ) {
+      chain.push_action( "eosio.token"_n, "transfer"_n, "eosio.token"_n,
+                         mvo()("from", "eosio.token")("to", to)("quantity", "100.0000 CUR")("memo", "") );
+   }
+   chain.produce_block();
+
+   auto transfer = [&]( name from, name to ) {
+      return chain.push_action( "eosio.token"_n, "transfer"_n, from,
+                                mvo()("from", from)("to", to)("quantity", "1.0000 CUR")("memo", "") )->access_set;
+   };
+   auto alice_bob  = transfer( "alice"_n, "bob"_n );
+   auto carol_dave = transfer( "carol"_n, "dave"_n );
+   auto bob_carol  = transfer( "bob"_n, "carol"_n );
+   BOOST_REQUIRE( alice_bob && carol_dave && bob_carol );
+   BOOST_TEST( !alice_bob->conflicts_with( *carol_dave ) );
+   BOOST_TEST( alice_bob->conflicts_with( *bob_carol ) );  // bob's balance
+   BOOST_TEST( carol_dave->conflicts_with( *bob_carol ) ); // carol's balance
+
+   // native actions change state outside of contract tables
+   auto auth_trace = chain.push_action( config::system_account_name, updateauth::get_name(), "alice"_n,
+                                        mvo()("account", "alice")("permission", "first")("parent", "active")
+                                             ("auth", authority(chain.get_public_key("alice"_n, "first"))) );
+   BOOST_REQUIRE( auth_trace->access_set );
+   BOOST_TEST( auth_trace->access_set->is_serial() );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
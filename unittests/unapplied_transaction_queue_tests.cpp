@@ -9,13 +9,13 @@ using namespace eosio::chain;
 
 BOOST_AUTO_TEST_SUITE(unapplied_transaction_queue_tests)
 
-auto unique_trx_meta_data( fc::time_point expire = fc::time_point::now() + fc::seconds( 120 ) ) {
+auto unique_trx_meta_data( fc::time_point expire = fc::time_point::now() + fc::seconds( 120 ),
+                           account_name creator = config::system_account_name ) {
 
    static uint64_t nextid = 0;
    ++nextid;
 
    signed_transaction trx;
-   account_name creator = config::system_account_name;
    trx.expiration = fc::time_point_sec{expire};
    trx.actions.emplace_back( vector<permission_level>{{creator,config::active_name}},
                              onerror{ nextid, "test", 4 });
@@ -430,4 +430,107 @@ BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_incoming_count ) try {
 
 } FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_incoming_count
 
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_fair_incoming ) try {
+
+   const auto expire = fc::time_point::now() + fc::seconds( 120 );
+   auto a1 = unique_trx_meta_data( expire, "alice"_n );
+   auto a2 = unique_trx_meta_data( expire, "alice"_n );
+   auto a3 = unique_trx_meta_data( expire, "alice"_n );
+   auto b1 = unique_trx_meta_data( expire, "bob"_n );
+   auto b2 = unique_trx_meta_data( expire, "bob"_n );
+   auto b3 = unique_trx_meta_data( expire, "bob"_n );
+   auto c1 = unique_trx_meta_data( expire, "carol"_n );
+
+   unapplied_transaction_queue q;
+
+   // alice queues a backlog before bob and carol, they are not processed after all of it
+   q.add_incoming( a1, false, false, [](auto){} );
+   q.add_incoming( a2, false, false, [](auto){} );
+   q.add_incoming( a3, false, false, [](auto){} );
+   q.add_incoming( b1, false, false, [](auto){} );
+   q.add_incoming( b2, false, false, [](auto){} );
+   q.add_incoming( c1, false, false, [](auto){} );
+   BOOST_REQUIRE( next( q ) == a1 );
+   BOOST_REQUIRE( next( q ) == a2 );
+   BOOST_REQUIRE( next( q ) == b1 );
+   BOOST_REQUIRE( next( q ) == c1 );
+   BOOST_REQUIRE( next( q ) == a3 );
+   BOOST_REQUIRE( next( q ) == b2 );
+   BOOST_CHECK( q.empty() );
+
+   // alice's trxs cost 4 times bob's
+   q.add_incoming( a1, false, false, [](auto){}, 4 );
+   q.add_incoming( a2, false, false, [](auto){}, 4 );
+   q.add_incoming( a3, false, false, [](auto){}, 4 );
+   q.add_incoming( b1, false, false, [](auto){}, 1 );
+   q.add_incoming( b2, false, false, [](auto){}, 1 );
+   q.add_incoming( b3, false, false, [](auto){}, 1 );
+   BOOST_REQUIRE( next( q ) == a1 );
+   BOOST_REQUIRE( next( q ) == b1 );
+   BOOST_REQUIRE( next( q ) == b2 );
+   BOOST_REQUIRE( next( q ) == b3 );
+   BOOST_REQUIRE( next( q ) == a2 );
+   BOOST_REQUIRE( next( q ) == a3 );
+   BOOST_CHECK( q.empty() );
+
+   // api trxs are still processed before p2p trxs
+   q.add_incoming( a1, false, false, [](auto){} );
+   q.add_incoming( b1, true, false, [](auto){} );
+   BOOST_REQUIRE( next( q ) == b1 );
+   BOOST_REQUIRE( next( q ) == a1 );
+
+   q.set_max_incoming_per_account( 2 );
+   q.add_incoming( a1, false, false, [](auto){} );
+   q.add_incoming( a2, false, false, [](auto){} );
+   BOOST_CHECK_THROW( q.add_incoming( a3, false, false, [](auto){} ), tx_resource_exhaustion );
+   q.add_incoming( b1, false, false, [](auto){} );
+   BOOST_CHECK( q.size() == 3u );
+   BOOST_REQUIRE( next( q ) == a1 );
+   q.add_incoming( a3, false, false, [](auto){} );
+   BOOST_CHECK( q.size() == 3u );
+   BOOST_CHECK( q.incoming_size() == 3u );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_fair_incoming
+
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_fair_incoming_by_type ) try {
+
+   const auto expire = fc::time_point::now() + fc::seconds( 120 );
+   auto a1 = unique_trx_meta_data( expire, "alice"_n );
+   auto a2 = unique_trx_meta_data( expire, "alice"_n );
+   auto a3 = unique_trx_meta_data( expire, "alice"_n );
+   auto a4 = unique_trx_meta_data( expire, "alice"_n );
+   auto b1 = unique_trx_meta_data( expire, "bob"_n );
+   auto c1 = unique_trx_meta_data( expire, "carol"_n );
+
+   unapplied_transaction_queue q;
+
+   // alice's p2p backlog does not delay her api trxs
+   q.add_incoming( a1, false, false, [](auto){} );
+   q.add_incoming( a2, false, false, [](auto){} );
+   q.add_incoming( a3, false, false, [](auto){} );
+   q.add_incoming( b1, true, false, [](auto){} );
+   q.add_incoming( a4, true, false, [](auto){} );
+   q.add_incoming( c1, true, false, [](auto){} );
+   BOOST_REQUIRE( next( q ) == b1 );
+   BOOST_REQUIRE( next( q ) == a4 );
+   BOOST_REQUIRE( next( q ) == c1 );
+   BOOST_REQUIRE( next( q ) == a1 );
+   BOOST_REQUIRE( next( q ) == a2 );
+   BOOST_REQUIRE( next( q ) == a3 );
+   BOOST_CHECK( q.empty() );
+
+   // limit is per account over both trx types, and is checked before a trx is executed
+   q.check_incoming_account_limit( a3 );
+   q.add_incoming( a1, false, false, [](auto){} );
+   q.add_incoming( a2, true, false, [](auto){} );
+   q.check_incoming_account_limit( a3 ); // no limit
+   q.set_max_incoming_per_account( 2 );
+   BOOST_CHECK_THROW( q.check_incoming_account_limit( a3 ), tx_resource_exhaustion );
+   q.check_incoming_account_limit( b1 );
+   BOOST_REQUIRE( next( q ) == a2 );
+   q.check_incoming_account_limit( a3 );
+   BOOST_CHECK( q.size() == 1u );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_fair_incoming_by_type
+
 BOOST_AUTO_TEST_SUITE_END()